@@ -47,34 +47,205 @@
 #include <errno.h>
 #include <float.h>
 #include <limits.h>
-#include <ctype.h>
+#include <locale.h>
 #include <stdint.h>
 #include <stddef.h>
 #include "mcJSON.h"
 
 #include <assert.h>
 
+/* x86 SIMD code paths, selected at runtime depending on the CPU */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MCJSON_X86_DISPATCH
+#endif
+#if defined(MCJSON_X86_DISPATCH) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 static void *(*mcJSON_malloc)(size_t sz) = malloc;
 static void (*mcJSON_free)(void *ptr) = free;
 
+/* allocator of the default context, it uses the hooks */
+static void *hooks_malloc(void * const userdata __attribute__((unused)), const size_t size) {
+	return mcJSON_malloc(size);
+}
+static void hooks_free(void * const userdata __attribute__((unused)), void * const pointer) {
+	mcJSON_free(pointer);
+}
+
+void mcJSON_ContextInit(mcJSON_Context * const context) {
+	if (context == NULL) {
+		return;
+	}
+
+	context->malloc_fn = hooks_malloc;
+	context->realloc_fn = NULL;
+	context->free_fn = hooks_free;
+	context->userdata = NULL;
+	context->pool = NULL;
+	context->options = NULL;
+	context->max_length = 0;
+}
+
+/* The default context with a pool, used by all functions that don't take a context. */
+static mcJSON_Context pool_context(mempool_t * const pool) {
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.pool = pool;
+
+	return context;
+}
+
+/* context, or default_context initialized like mcJSON_ContextInit if it is NULL. */
+static const mcJSON_Context *context_or_default(const mcJSON_Context * const context, mcJSON_Context * const default_context) {
+	if (context != NULL) {
+		return context;
+	}
+
+	mcJSON_ContextInit(default_context);
+	return default_context;
+}
+
+static void *context_malloc(const mcJSON_Context * const context, const size_t size) {
+	return context->malloc_fn(context->userdata, size);
+}
+
+static void context_free(const mcJSON_Context * const context, void * const pointer) {
+	if (pointer != NULL) {
+		context->free_fn(context->userdata, pointer);
+	}
+}
+
+/* Resize memory from context_malloc, old_size bytes of it are kept. */
+static void *context_realloc(const mcJSON_Context * const context, void * const pointer, const size_t old_size, const size_t new_size) {
+	if (context->realloc_fn != NULL) {
+		return context->realloc_fn(context->userdata, pointer, new_size);
+	}
+
+	void *new_pointer = context_malloc(context, new_size);
+	if (new_pointer == NULL) {
+		return NULL;
+	}
+	if (pointer != NULL) {
+		memcpy(new_pointer, pointer, (old_size < new_size) ? old_size : new_size);
+		context_free(context, pointer);
+	}
+
+	return new_pointer;
+}
+
+/* Create a buffer_t on the heap of a context, like buffer_create_with_custom_allocator. */
+static buffer_t *context_buffer_create(const size_t buffer_length, const size_t content_length, const mcJSON_Context * const context) {
+	unsigned char *content = NULL;
+	if (buffer_length != 0) {
+		content = (unsigned char*)context_malloc(context, buffer_length);
+		if (content == NULL) {
+			return NULL;
+		}
+	}
+
+	buffer_t *buffer = (buffer_t*)context_malloc(context, sizeof(buffer_t));
+	if (buffer == NULL) {
+		context_free(context, content);
+		return NULL;
+	}
+
+	return buffer_init_with_pointer(buffer, content, buffer_length, content_length);
+}
+
+/* Create a buffer_t with a copy of a C string on the heap of a context. */
+static buffer_t *context_string_create(const char * const string, const mcJSON_Context * const context) {
+	const size_t length = strlen(string) + 1;
+	buffer_t *buffer = context_buffer_create(length, length, context);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	memcpy(buffer->content, string, length);
+
+	return buffer;
+}
+
+/* Destroy a buffer_t from context_buffer_create, like buffer_destroy_with_custom_deallocator. */
+static void context_buffer_destroy(buffer_t * const buffer, const mcJSON_Context * const context) {
+	if (buffer->content != NULL) {
+		memset(buffer->content, 0, buffer->buffer_length);
+		context_free(context, buffer->content);
+	}
+	context_free(context, buffer);
+}
+
 #define ALIGNMENT_OF(type) offsetof( struct { char c; type t; }, t )
 
-void *allocate(const size_t size, mempool_t * const pool) {
-	if (pool == NULL) { /* no mempool is used, do normal malloc */
-		return mcJSON_malloc(size);
+/* Arenas are mempool_t's that grow by chaining blocks. The buffer_t describes the
+ * current block, every block starts with a pointer to the previous one.
+ * A content_length that is bigger than the buffer_length is impossible for
+ * normal buffers, so it marks a mempool_t as an arena. */
+typedef struct arena_block {
+	unsigned char *previous;
+	size_t size;
+} arena_block;
+
+/* the description of an arena, the blocks are allocated with context */
+typedef struct arena_pool {
+	mempool_t pool; /* has to be the first member, arenas are used as mempool_t */
+	mcJSON_Context context;
+} arena_pool;
+
+#define ARENA_MIN_BLOCK_SIZE 256
+
+static bool is_arena(const mempool_t * const pool) {
+	return pool->content_length > pool->buffer_length;
+}
+
+/* Start a new block that can fit at least size bytes, the block sizes grow geometrically. */
+static bool arena_add_block(mempool_t * const arena, const size_t size) {
+	size_t block_size = 2 * arena->buffer_length;
+	if (block_size < ARENA_MIN_BLOCK_SIZE) {
+		block_size = ARENA_MIN_BLOCK_SIZE;
 	}
+	const size_t needed = sizeof(arena_block) + ALIGNMENT_OF(intmax_t) + size;
+	if (needed < size) { /* overflow */
+		return false;
+	}
+	if (block_size < needed) {
+		block_size = needed;
+	}
+
+	unsigned char *block = context_malloc(&((arena_pool*)arena)->context, block_size);
+	if (block == NULL) {
+		return false;
+	}
+	((arena_block*)block)->previous = arena->content;
+	((arena_block*)block)->size = block_size;
+	arena->content = block;
+	arena->buffer_length = block_size;
+	arena->position = sizeof(arena_block);
 
-	//determine the amount of padding for proper alignment
+	return true;
+}
+
+/* padding needed to align the next allocation from the pool */
+static size_t pool_padding(const mempool_t * const pool) {
 	size_t alignment = ALIGNMENT_OF(intmax_t); //alignment needed for this processor
-	size_t padding = 0; //padding needed to fit alignment
-	if (alignment != 0) {
-		unsigned char* start_position = pool->content + pool->position; //set start_position to current position in the mempool
-		padding = (alignment - (((size_t)start_position) % alignment)) % alignment; //padding needed to fit alignment
+	if (alignment == 0) {
+		return 0;
 	}
+	unsigned char* start_position = pool->content + pool->position; //set start_position to current position in the mempool
+	return (alignment - (((size_t)start_position) % alignment)) % alignment;
+}
 
+void *allocate(const size_t size, const mcJSON_Context * const context) {
+	mempool_t * const pool = context->pool;
+	if (pool == NULL) { /* no mempool is used, do normal malloc */
+		return context_malloc(context, size);
+	}
 
-	if ((pool->position + size + padding) >= pool->buffer_length) { /* not enough space */
-		return NULL;
+	size_t padding = pool_padding(pool); //padding needed to fit alignment
+	if ((pool->position + size + padding) > pool->buffer_length) { /* not enough space */
+		if (!is_arena(pool) || !arena_add_block(pool, size)) {
+			return NULL;
+		}
+		padding = pool_padding(pool);
 	}
 
 	void *pointer = (void*)(pool->content + pool->position + padding);
@@ -83,9 +254,143 @@ void *allocate(const size_t size, mempool_t * const pool) {
 	return pointer;
 }
 
-void deallocate(void *pointer, mempool_t * const pool) {
-	if (pool == NULL) { /* no mempool is used, do normal free */
-		mcJSON_free(pointer);
+mempool_t *mcJSON_ArenaCreateWithContext(const size_t block_size, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+
+	arena_pool *arena = (arena_pool*)context_malloc(context, sizeof(arena_pool));
+	if (arena == NULL) {
+		return NULL;
+	}
+	arena->context = *context;
+	arena->context.pool = NULL;
+	buffer_init_with_pointer(&arena->pool, NULL, 0, 0);
+	if (!arena_add_block(&arena->pool, block_size)) {
+		context_free(context, arena);
+		return NULL;
+	}
+	arena->pool.content_length = SIZE_MAX; /* marks it as an arena, see is_arena */
+
+	return &arena->pool;
+}
+
+mempool_t *mcJSON_ArenaCreate(const size_t block_size) {
+	return mcJSON_ArenaCreateWithContext(block_size, NULL);
+}
+
+/* Free a block of an arena and return the previous one. */
+static unsigned char *arena_free_block(const mempool_t * const arena, unsigned char * const block, const bool wipe) {
+	unsigned char *previous = ((arena_block*)block)->previous;
+	if (wipe) {
+		memset(block, 0, ((arena_block*)block)->size);
+	}
+	context_free(&((const arena_pool*)arena)->context, block);
+
+	return previous;
+}
+
+void mcJSON_ArenaDestroy(mempool_t * const arena) {
+	if ((arena == NULL) || !is_arena(arena)) {
+		return;
+	}
+
+	unsigned char *block = arena->content;
+	while (block != NULL) {
+		block = arena_free_block(arena, block, true);
+	}
+	const mcJSON_Context context = ((arena_pool*)arena)->context;
+	context_free(&context, arena);
+}
+
+bool mcJSON_PoolIsArena(const mempool_t * const pool) {
+	return (pool != NULL) && is_arena(pool);
+}
+
+mempool_t *mcJSON_ArenaCreateLike(const mempool_t * const arena, const size_t block_size) {
+	if ((arena == NULL) || !is_arena(arena)) {
+		return NULL;
+	}
+
+	return mcJSON_ArenaCreateWithContext(block_size, &((const arena_pool*)arena)->context);
+}
+
+void mcJSON_ArenaMerge(mempool_t * const arena, mempool_t * const source) {
+	if ((arena == NULL) || (source == NULL) || !is_arena(arena) || !is_arena(source)) {
+		return;
+	}
+
+	/* the blocks of source are chained in front of the current block of arena,
+	 * so the current block of source becomes the current block of arena */
+	unsigned char *oldest = source->content;
+	while (((arena_block*)oldest)->previous != NULL) {
+		oldest = ((arena_block*)oldest)->previous;
+	}
+	((arena_block*)oldest)->previous = arena->content;
+	arena->content = source->content;
+	arena->buffer_length = source->buffer_length;
+	arena->position = source->position;
+
+	const mcJSON_Context context = ((arena_pool*)source)->context;
+	context_free(&context, source);
+}
+
+mcJSON_PoolMarker mcJSON_PoolMark(const mempool_t * const pool) {
+	mcJSON_PoolMarker marker = {NULL, 0};
+	if (pool != NULL) {
+		marker.block = pool->content;
+		marker.position = pool->position;
+	}
+
+	return marker;
+}
+
+void mcJSON_PoolRollback(mempool_t * const pool, const mcJSON_PoolMarker marker, const bool wipe) {
+	if (pool == NULL) {
+		return;
+	}
+
+	/* free the blocks of an arena that were started after the marker */
+	size_t end = pool->position;
+	while (is_arena(pool) && (pool->content != marker.block) && (((arena_block*)pool->content)->previous != NULL)) {
+		pool->content = arena_free_block(pool, pool->content, wipe);
+		pool->buffer_length = ((arena_block*)pool->content)->size;
+		end = pool->buffer_length;
+	}
+	if ((pool->content != marker.block) || (marker.position > end)) { /* not a marker of this pool */
+		return;
+	}
+
+	if (wipe) {
+		memset(pool->content + marker.position, 0, end - marker.position);
+	}
+	pool->position = marker.position;
+}
+
+void mcJSON_PoolReset(mempool_t * const pool, const bool wipe) {
+	if ((pool == NULL) || (pool->content == NULL)) {
+		return;
+	}
+
+	size_t start = 0;
+	if (is_arena(pool)) {
+		/* only keep the current block, it is the biggest one */
+		unsigned char *block = ((arena_block*)pool->content)->previous;
+		while (block != NULL) {
+			block = arena_free_block(pool, block, wipe);
+		}
+		((arena_block*)pool->content)->previous = NULL;
+		start = sizeof(arena_block);
+	}
+
+	if (wipe && (pool->position > start)) {
+		memset(pool->content + start, 0, pool->position - start);
+	}
+	pool->position = start;
+}
+
+void deallocate(void *pointer, const mcJSON_Context * const context) {
+	if (context->pool == NULL) { /* no mempool is used, do normal free */
+		context_free(context, pointer);
 	}
 
 	/* in case of mempool, do nothing, because it doesn't support deallocating */
@@ -102,9 +407,19 @@ void mcJSON_InitHooks(const mcJSON_Hooks * const hooks) {
 	mcJSON_free = (hooks->free_fn != NULL) ? hooks->free_fn : free;
 }
 
+static const mcJSON_ParseOptions default_parse_options = {
+	false, /* borrow_strings */
+	false, /* in_situ */
+	0, /* max_depth */
+	false, /* validate_utf8 */
+	false, /* intern_names */
+	NULL, /* resolve_name */
+	NULL /* resolver_data */
+};
+
 /* Internal constructor. */
-static mcJSON *mcJSON_New_Item(mempool_t * const pool) {
-	mcJSON* node = (mcJSON*)allocate(sizeof(mcJSON), pool);
+static mcJSON *mcJSON_New_Item(const mcJSON_Context * const context) {
+	mcJSON* node = (mcJSON*)allocate(sizeof(mcJSON), context);
 	if (node) {
 		memset(node, 0, sizeof(mcJSON));
 	}
@@ -112,38 +427,248 @@ static mcJSON *mcJSON_New_Item(mempool_t * const pool) {
 	return node;
 }
 
-/* Delete a mcJSON structure. */
-void mcJSON_Delete(mcJSON *item) {
+/* Deallocate a string, borrowed strings only own their buffer_t, not the content. */
+static void string_deallocate(buffer_t * const string, const bool borrowed, const mcJSON_Context * const context) {
+	if (borrowed) {
+		deallocate(string, context);
+		return;
+	}
+
+	if (string->content == NULL) {
+		return;
+	}
+	if (context->pool == NULL) {
+		context_buffer_destroy(string, context);
+		return;
+	}
+
+	/* deallocating from mempool_t isn't possible */
+	buffer_clear(string);
+}
+
+/* Delete a mcJSON structure, context must not have a pool.
+ * This doesn't recurse, the children of an item are moved in front of its
+ * next sibling instead, so every item is part of one list that is deleted
+ * from front to back. Every list of children is walked only once to find
+ * its end. */
+static void delete_item(mcJSON *item, const mcJSON_Context * const context) {
 	mcJSON *next;
 	while (item != NULL) {
-		next = item->next;
 		if (!(item->is_reference) && (item->child != NULL)) {
-			mcJSON_Delete(item->child);
+			mcJSON *last_child = item->child;
+			while (last_child->next != NULL) {
+				last_child = last_child->next;
+			}
+			last_child->next = item->next;
+			item->next = item->child;
+			item->child = NULL;
 		}
-		if (!(item->is_reference) && (item->valuestring != NULL) && (item->valuestring->content != NULL)) {
-			buffer_destroy_with_custom_deallocator(item->valuestring, mcJSON_free);
+		next = item->next;
+		if (!(item->is_reference) && (item->valuestring != NULL)) {
+			string_deallocate(item->valuestring, item->valuestring_is_borrowed, context);
 		}
-		if (!(item->string_is_const) && (item->name != NULL) && (item->name->content != NULL)) {
-			buffer_destroy_with_custom_deallocator(item->name, mcJSON_free);
+		if (!(item->string_is_const) && (item->name != NULL)) {
+			string_deallocate(item->name, item->name_is_borrowed, context);
 		}
-		mcJSON_free(item);
+		context_free(context, item);
 		item = next;
 	}
 }
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static buffer_t *parse_number(mcJSON * const item, buffer_t * const input) {
+void mcJSON_DeleteWithContext(mcJSON * const item, const mcJSON_Context * const context) {
+	if (context == NULL) {
+		mcJSON_Delete(item);
+		return;
+	}
+
+	mcJSON_Context heap_context = *context;
+	heap_context.pool = NULL;
+	delete_item(item, &heap_context);
+}
+
+void mcJSON_Delete(mcJSON * const item) {
+	const mcJSON_Context context = pool_context(NULL);
+	delete_item(item, &context);
+}
+
+/* Powers of ten that can be represented exactly as double. */
+static const double exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define MAX_EXACT_POWER_OF_TEN 22
+#define MAX_EXACT_MANTISSA (UINT64_C(1) << 53)
+/* 19 decimal digits always fit into 64 bits */
+#define MAX_MANTISSA_DIGITS 19
+
+static bool is_digit(const unsigned char character) {
+	return (character >= '0') && (character <= '9');
+}
+
+/* Convert length bytes of number text with strtod. The text is copied
+ * so that strtod can't read past its end and so that the '.' can be
+ * replaced with the decimal point of the current locale. Long copies
+ * are allocated with the allocator of context. */
+static bool strtod_bounded(const unsigned char * const text, const size_t length, double * const number, const mcJSON_Context * const context) {
+	const char * const decimal_point = localeconv()->decimal_point;
+	const size_t decimal_point_length = strlen(decimal_point);
+
+	char stack_copy[64];
+	char *copy = stack_copy;
+	const size_t copy_length = length + decimal_point_length + 1;
+	if (copy_length > sizeof(stack_copy)) {
+		copy = (char*)context_malloc(context, copy_length);
+		if (copy == NULL) {
+			return false;
+		}
+	}
+
+	size_t copy_position = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (text[i] == '.') {
+			memcpy(copy + copy_position, decimal_point, decimal_point_length);
+			copy_position += decimal_point_length;
+		} else {
+			copy[copy_position] = (char)text[i];
+			copy_position++;
+		}
+	}
+	copy[copy_position] = '\0';
+
 	char *end_pointer;
-	double number = strtod((char*)input->content + input->position, &end_pointer);
-	input->position = ((unsigned char*)end_pointer) - input->content;
+	*number = strtod(copy, &end_pointer);
+	const bool success = (end_pointer == (copy + copy_position));
+
+	if (copy != stack_copy) {
+		context_free(context, copy);
+	}
 
+	return success;
+}
+
+/* Scan the number at the current position of input into result. If the number
+ * is an integer that fits into 64 bit, *is_int64 is set and *result_integer
+ * contains it exactly, otherwise *is_int64 is false.
+ * This accepts the same decimal notation as strtod and gives the same result,
+ * independent of the locale. The common cases are calculated exactly without
+ * strtod: integers and numbers where mantissa and power of ten are exact doubles. */
+static bool scan_number(buffer_t * const input, double * const result, int64_t * const result_integer, bool * const is_int64, const mcJSON_Context * const context) {
+	const unsigned char * const content = input->content;
+	const size_t end = input->content_length;
+	const size_t start = input->position;
+	size_t position = start;
+
+	bool negative = false;
+	if ((position < end) && (content[position] == '-')) {
+		negative = true;
+		position++;
+	}
+
+	/* the first MAX_MANTISSA_DIGITS significant digits become the mantissa */
+	uint64_t mantissa = 0;
+	size_t mantissa_digits = 0;
+	size_t digits = 0;
+	int64_t exponent = 0;
+	bool truncated = false; /* nonzero digits didn't fit into the mantissa */
+	bool integer = true; /* no fraction and no exponent */
+	for (; (position < end) && is_digit(content[position]); position++, digits++) {
+		if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+			mantissa = mantissa * 10 + (uint64_t)(content[position] - '0');
+			mantissa_digits += (mantissa != 0) ? 1 : 0;
+		} else {
+			exponent++;
+			truncated |= (content[position] != '0');
+		}
+	}
+	if ((position < end) && (content[position] == '.')) {
+		integer = false;
+		for (position++; (position < end) && is_digit(content[position]); position++, digits++) {
+			if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+				mantissa = mantissa * 10 + (uint64_t)(content[position] - '0');
+				mantissa_digits += (mantissa != 0) ? 1 : 0;
+				exponent--;
+			} else {
+				truncated |= (content[position] != '0');
+			}
+		}
+	}
+	if (digits == 0) { /* not a number */
+		return false;
+	}
+
+	/* the exponent is only part of the number if it has digits */
+	if ((position < end) && ((content[position] == 'e') || (content[position] == 'E'))) {
+		size_t exponent_position = position + 1;
+		bool negative_exponent = false;
+		if ((exponent_position < end) && ((content[exponent_position] == '+') || (content[exponent_position] == '-'))) {
+			negative_exponent = (content[exponent_position] == '-');
+			exponent_position++;
+		}
+		if ((exponent_position < end) && is_digit(content[exponent_position])) {
+			integer = false;
+			int64_t explicit_exponent = 0;
+			for (position = exponent_position; (position < end) && is_digit(content[position]); position++) {
+				if (explicit_exponent < 100000) { /* everything above over- or underflows anyway */
+					explicit_exponent = explicit_exponent * 10 + (content[position] - '0');
+				}
+			}
+			exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+		}
+	}
+
+	double number;
+	if (!truncated && ((mantissa == 0) || (exponent == 0))) {
+		/* the conversion rounds only once, exactly like strtod */
+		number = (double)mantissa;
+		number = negative ? -number : number;
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+	} else if (!truncated && (mantissa <= MAX_EXACT_MANTISSA) && (exponent >= -MAX_EXACT_POWER_OF_TEN) && (exponent <= MAX_EXACT_POWER_OF_TEN)) {
+		/* both operands are exact, so the result is correctly rounded (Clinger's fast path) */
+		if (exponent < 0) {
+			number = (double)mantissa / exact_powers_of_ten[-exponent];
+		} else {
+			number = (double)mantissa * exact_powers_of_ten[exponent];
+		}
+		number = negative ? -number : number;
+#endif
+	} else if (!strtod_bounded(content + start, position - start, &number, context)) {
+		return false;
+	}
+	input->position = position;
+	*result = number;
+
+	/* keep integers exact if they fit into 64 bit */
+	*is_int64 = integer && !truncated && (exponent == 0) && (mantissa <= (negative ? (UINT64_C(1) << 63) : (uint64_t)INT64_MAX));
+	if (*is_int64) {
+		*result_integer = negative ? (-(int64_t)(mantissa - 1) - 1) : (int64_t)mantissa;
+	}
+
+	return true;
+}
+
+/* Populate item with a number, integer is NULL if it isn't an exact 64 bit integer. */
+static void number_set(mcJSON * const item, const double number, const int64_t * const integer) {
 	item->valuedouble = number;
 	if ((number <= INT_MAX) && (number >= INT_MIN)) {
 		item->valueint = (int)number;
 	} else {
 		item->valueint = 0;
 	}
+	item->is_int64 = (integer != NULL);
+	item->valueint64 = (integer != NULL) ? *integer : 0;
 	item->type = mcJSON_Number;
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static buffer_t *parse_number(mcJSON * const item, buffer_t * const input, const mcJSON_Context * const context) {
+	double number;
+	int64_t integer;
+	bool is_int64;
+	if (!scan_number(input, &number, &integer, &is_int64, context)) {
+		return NULL;
+	}
+
+	number_set(item, number, is_int64 ? &integer : NULL);
 
 	return input;
 }
@@ -159,7 +684,7 @@ static size_t pow2gt(size_t x) {
 }
 
 /* ensure that the buffer is big enough */
-static char* ensure(buffer_t * const buffer, size_t needed) {
+static char* ensure(buffer_t * const buffer, size_t needed, const mcJSON_Context * const context) {
 	if ((buffer == NULL) || (buffer->content == NULL)) {
 		return NULL;
 	}
@@ -169,19 +694,25 @@ static char* ensure(buffer_t * const buffer, size_t needed) {
 	   don't update the length, TODO make this better */
 	buffer->content_length = buffer->buffer_length;
 
-	int status = buffer_grow_on_heap(buffer, pow2gt(needed));
-	if (status != 0) {
-		return NULL;
+	if (needed > buffer->buffer_length) {
+		const size_t new_size = pow2gt(needed);
+		unsigned char *content = (unsigned char*)context_realloc(context, buffer->content, buffer->buffer_length, new_size);
+		if (content == NULL) {
+			return NULL;
+		}
+		buffer->content = content;
+		buffer->buffer_length = new_size;
+		buffer->content_length = new_size;
 	}
 
 	return (char*)buffer->content + buffer->position;
 }
 
 /* allocate a buffer for printing */
-buffer_t *printbuffer_allocate(const size_t size, buffer_t * const buffer) {
+buffer_t *printbuffer_allocate(const size_t size, buffer_t * const buffer, const mcJSON_Context * const context) {
 	/* buffered printing */
 	if (buffer != NULL) {
-		if (ensure(buffer, size) == NULL) { /* allocation failed */
+		if (ensure(buffer, size, context) == NULL) { /* allocation failed */
 			if (buffer->content != NULL) {
 				/* if content exists, terminate with '\0', just to make sure */
 				buffer->content[buffer->position] = '\0';
@@ -191,24 +722,24 @@ buffer_t *printbuffer_allocate(const size_t size, buffer_t * const buffer) {
 	}
 
 	/* allocate new memory (unbuffered printing) */
-	return buffer_create_with_custom_allocator(size, size, mcJSON_malloc, mcJSON_free);
+	return context_buffer_create(size, size, context);
 }
 
 /* allocate a molch_buffer for parsing, inside a mempool_t if it exists */
-buffer_t *parsebuffer_allocate(const size_t buffer_length, const size_t content_length, mempool_t * const pool) {
-	if (pool == NULL) { /* unbuffered parsing */
-		return buffer_create_with_custom_allocator(buffer_length, content_length, mcJSON_malloc, mcJSON_free);
+buffer_t *parsebuffer_allocate(const size_t buffer_length, const size_t content_length, const mcJSON_Context * const context) {
+	if (context->pool == NULL) { /* unbuffered parsing */
+		return context_buffer_create(buffer_length, content_length, context);
 	}
 
 	/* buffered parsing */
-	buffer_t *buffer = (buffer_t*) allocate(sizeof(buffer_t), pool);
+	buffer_t *buffer = (buffer_t*) allocate(sizeof(buffer_t), context);
 	if (buffer == NULL) {
 		return NULL;
 	}
 
 	unsigned char *content = NULL;
 	if (buffer_length != 0) {
-		content = (unsigned char*)allocate(buffer_length, pool);
+		content = (unsigned char*)allocate(buffer_length, context);
 		if (content == NULL) {
 			return NULL;
 		}
@@ -217,10 +748,21 @@ buffer_t *parsebuffer_allocate(const size_t buffer_length, const size_t content_
 	return buffer_init_with_pointer(buffer, content, buffer_length, content_length);
 }
 
+/* Create a buffer_t that points to length bytes of already existing content,
+ * the byte after them takes the place of the terminating '\0'. */
+static buffer_t *string_view_allocate(unsigned char * const content, const size_t length, const mcJSON_Context * const context) {
+	buffer_t *view = (buffer_t*)allocate(sizeof(buffer_t), context);
+	if (view == NULL) {
+		return NULL;
+	}
+
+	return buffer_init_with_pointer(view, content, length + 1, length + 1);
+}
+
 /* deallocate a molch_buffer that was used for parsing */
-void parsebuffer_deallocate(buffer_t *buffer, mempool_t * const pool) {
-	if (pool == NULL) { /* no mempool is used, do normal buffer_destroy_with_custom_deallocator*/
-		buffer_destroy_with_custom_deallocator(buffer, mcJSON_free);
+void parsebuffer_deallocate(buffer_t *buffer, const mcJSON_Context * const context) {
+	if (context->pool == NULL) { /* no mempool is used, do normal buffer_destroy_with_custom_deallocator*/
+		context_buffer_destroy(buffer, context);
 		return;
 	}
 
@@ -234,16 +776,36 @@ extern bool mcJSON_IsInteger(const mcJSON * const number) {
 	return (number != NULL) && (number->type == mcJSON_Number) && (fabs(((double)number->valueint) - number->valuedouble) <= DBL_EPSILON) && (number->valuedouble <= INT_MAX) && (number->valuedouble >= INT_MIN);
 }
 
+/* check if a given Number is an integer that fits into 64 bit */
+bool mcJSON_IsInt64(const mcJSON * const number) {
+	return (number != NULL) && (number->type == mcJSON_Number) && number->is_int64;
+}
+
+/* get a Number as 64 bit integer, the fraction is truncated, 0 if it doesn't fit */
+int64_t mcJSON_GetInt64(const mcJSON * const number) {
+	if ((number == NULL) || (number->type != mcJSON_Number)) {
+		return 0;
+	}
+	if (number->is_int64) {
+		return number->valueint64;
+	}
+	if ((number->valuedouble >= -9223372036854775808.0) && (number->valuedouble < 9223372036854775808.0)) {
+		return (int64_t)number->valuedouble;
+	}
+
+	return 0;
+}
+
 /* check if a given json object is a boolean */
 bool mcJSON_IsBoolean(const mcJSON * const json) {
 	return (json != NULL) && ((json->type == mcJSON_True) || (json->type == mcJSON_False));
 }
 
 /* Render the number nicely from the given item into a string. */
-static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer) {
+static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer, const mcJSON_Context * const context) {
 	buffer_t *output = NULL;
 	if (item->valuedouble == 0) { /* zero */
-		output = printbuffer_allocate(2, buffer);
+		output = printbuffer_allocate(2, buffer, context);
 		if (output == NULL) {
 			return NULL;
 		}
@@ -252,15 +814,43 @@ static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer) {
 		if (buffer_copy_from_raw(output, output->position, (unsigned char*)"0", 0, 2) != 0) {
 			output->content[output->position] = '\0';
 			if (buffer == NULL) {
-				buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+				context_buffer_destroy(output, context);
 			}
 			return NULL;
 		}
 		output->position++;
+	} else if (item->is_int64) {
+		/* "-9223372036854775808" and '\0' */
+		static const size_t INT64_STRING_SIZE = 21;
+		output = printbuffer_allocate(INT64_STRING_SIZE, buffer, context);
+		if ((output == NULL) || ((output->buffer_length - output->position) < INT64_STRING_SIZE)) {
+			return NULL;
+		}
+
+		/* create the digits backwards */
+		unsigned char digits[INT64_STRING_SIZE];
+		size_t digit_count = 0;
+		uint64_t magnitude = (item->valueint64 < 0) ? (UINT64_C(0) - (uint64_t)item->valueint64) : (uint64_t)item->valueint64;
+		do {
+			digits[digit_count] = (unsigned char)('0' + (magnitude % 10));
+			digit_count++;
+			magnitude /= 10;
+		} while (magnitude != 0);
+
+		if (item->valueint64 < 0) {
+			output->content[output->position] = '-';
+			output->position++;
+		}
+		while (digit_count > 0) {
+			digit_count--;
+			output->content[output->position] = digits[digit_count];
+			output->position++;
+		}
+		output->content[output->position] = '\0';
 	} else if (mcJSON_IsInteger(item)) {
 		/* number is an integer */
 		static const size_t INT_STRING_SIZE = 21; /* 2^64+1 can be represented in 21 chars. */
-		output = printbuffer_allocate(INT_STRING_SIZE, buffer);
+		output = printbuffer_allocate(INT_STRING_SIZE, buffer, context);
 		if (output == NULL) {
 			return NULL;
 		}
@@ -268,7 +858,7 @@ static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer) {
 		output->position += snprintf((char*)output->content + output->position, output->buffer_length - output->position, "%d", item->valueint);
 	} else {
 		static const size_t DOUBLE_STRING_SIZE = 64; /* This is a nice tradeoff. */
-		output = printbuffer_allocate(DOUBLE_STRING_SIZE, buffer);
+		output = printbuffer_allocate(DOUBLE_STRING_SIZE, buffer, context);
 		if (output == NULL) {
 			return NULL;
 		}
@@ -279,7 +869,7 @@ static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer) {
 					output->content[output->position] = '\0';
 				}
 				if (buffer == NULL) {
-					buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+					context_buffer_destroy(output, context);
 				}
 				return NULL;
 			}
@@ -297,196 +887,485 @@ static buffer_t *print_number(mcJSON * const item, buffer_t * const buffer) {
 	return output;
 }
 
-/* parse a 4 character hexadecimal number, return INT_MAX on failure */
-static uint32_t parse_hex4(buffer_t * const input) {
-	if ((input->position + 4) >= input->content_length) {
-		return UINT_MAX;
+/* Hex digits have their value in the low nibble and 0x10 set, everything else is 0. */
+static const unsigned char hex_digits[256] = {
+	['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+	['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+	['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+	['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F
+};
+
+/* Decode 4 hex digits, UINT32_MAX if one of them isn't a hex digit. */
+static uint32_t decode_hex4(const unsigned char * const digits) {
+	const unsigned char first = hex_digits[digits[0]];
+	const unsigned char second = hex_digits[digits[1]];
+	const unsigned char third = hex_digits[digits[2]];
+	const unsigned char fourth = hex_digits[digits[3]];
+	if ((first & second & third & fourth & 0x10) == 0) {
+		return UINT32_MAX;
+	}
+
+	return ((uint32_t)(first & 0x0F) << 12) | ((uint32_t)(second & 0x0F) << 8) | ((uint32_t)(third & 0x0F) << 4) | (uint32_t)(fourth & 0x0F);
+}
+
+/* index of the lowest set bit, bits must not be 0 */
+static unsigned int trailing_zeroes(uint64_t bits) {
+#ifdef __GNUC__
+	return (unsigned int)__builtin_ctzll(bits);
+#else
+	unsigned int count = 0;
+	while ((bits & 1) == 0) {
+		bits >>= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+/* Find the first '\"', '\\' or '\0' in content, starting at position
+ * and stopping before end. Returns end if there is none. */
+static size_t find_string_delimiter(const unsigned char * const content, size_t position, const size_t end) {
+#if defined(__AVX2__)
+	const __m256i quote = _mm256_set1_epi8('\"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i zero = _mm256_setzero_si256();
+	for (; (end - position) >= 32; position += 32) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i*)(content + position));
+		const __m256i delimiters = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+				_mm256_cmpeq_epi8(chunk, zero));
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(delimiters);
+		if (mask != 0) {
+			return position + trailing_zeroes(mask);
+		}
+	}
+#elif defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i zero = _mm_setzero_si128();
+	for (; (end - position) >= 16; position += 16) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i*)(content + position));
+		const __m128i delimiters = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+				_mm_cmpeq_epi8(chunk, zero));
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(delimiters);
+		if (mask != 0) {
+			return position + trailing_zeroes(mask);
+		}
 	}
-	uint32_t number;
-	size_t characters_read = sscanf("%4x", (char*)input->content + input->position, &number);
-	if (characters_read != 4) {
-		return UINT_MAX;
+#endif
+
+	/* remaining bytes or non SIMD builds */
+	for (; position < end; position++) {
+		if ((content[position] == '\"') || (content[position] == '\\') || (content[position] == '\0')) {
+			break;
+		}
 	}
-	input->position += characters_read;
 
-	return number;
+	return position;
 }
 
-/* Parse the input text into an unescaped cstring, and populate item. */
-static buffer_t *parse_string(mcJSON * const item, buffer_t * const input, mempool_t * const pool) {
-	if (input->content[input->position] != '\"') { /* not a string! */
-		return NULL;
-	}
+/* What the escape sequences with a single character stand for, 0 for the others. */
+static const unsigned char escaped_characters[256] = {
+	['\"'] = '\"',
+	['\\'] = '\\',
+	['/'] = '/',
+	['b'] = '\b',
+	['f'] = '\f',
+	['n'] = '\n',
+	['r'] = '\r',
+	['t'] = '\t'
+};
+
+/* Write a code point as UTF-8 to output, returns the number of bytes. See RFC 3629 */
+static size_t utf8_encode(const uint32_t code_point, unsigned char * const output) {
+	if (code_point < 0x80) { /* ASCII */
+		output[0] = (unsigned char)code_point;
+		return 1;
+	}
+	if (code_point < 0x800) { /* at most 11 bits -> 2 bytes */
+		output[0] = (unsigned char)(0xC0 | (code_point >> 6));
+		output[1] = (unsigned char)(0x80 | (code_point & 0x3F));
+		return 2;
+	}
+	if (code_point < 0x10000) { /* at most 16 bits -> 3 bytes */
+		output[0] = (unsigned char)(0xE0 | (code_point >> 12));
+		output[1] = (unsigned char)(0x80 | ((code_point >> 6) & 0x3F));
+		output[2] = (unsigned char)(0x80 | (code_point & 0x3F));
+		return 3;
+	}
+	/* at most 21 bits -> 4 bytes */
+	output[0] = (unsigned char)(0xF0 | (code_point >> 18));
+	output[1] = (unsigned char)(0x80 | ((code_point >> 12) & 0x3F));
+	output[2] = (unsigned char)(0x80 | ((code_point >> 6) & 0x3F));
+	output[3] = (unsigned char)(0x80 | (code_point & 0x3F));
+	return 4;
+}
 
-	input->position++;
+/* Transcode the utf16 escape sequence (one or a surrogate pair) after "\u" to utf8. See RFC 2781 */
+static bool parse_unicode_escape(buffer_t * const input, buffer_t * const output) {
+	if ((input->position + 4) >= input->content_length) {
+		return false;
+	}
+	uint32_t unicode = decode_hex4(input->content + input->position);
+	input->position += 4;
 
+	/* invalid hex digits or a low surrogate without a high one before it */
+	if ((unicode == UINT32_MAX) || ((unicode >= 0xDC00) && (unicode <= 0xDFFF))) {
+		return false;
+	}
 
-	/* find the position of the closing '"' and get the length of the string */
-	size_t length = 0;
-	size_t end_position;
-	for (end_position = input->position;
-			(end_position < input->content_length)
-			&& (input->content[end_position] != '\"')
-			&& (input->content[end_position] != '\0');
-			end_position++, length++) {
-		if (input->content[end_position] == '\\') { /* Skip escaped quotes */
-			end_position++;
+	/* UTF-16 surrogate pair? */
+	if ((unicode >= 0xD800) && (unicode <= 0xDBFF)) {
+		if (((input->position + 6) >= input->content_length)
+				|| (input->content[input->position] != '\\') || (input->content[input->position + 1] != 'u')) {
+			return false;
 		}
-	}
+		const uint32_t low_surrogate = decode_hex4(input->content + input->position + 2);
+		if ((low_surrogate < 0xDC00) || (low_surrogate > 0xDFFF)) { /* also catches UINT32_MAX */
+			return false;
+		}
+		input->position += 6;
 
-	buffer_t *value_out = parsebuffer_allocate(length + 1, 0, pool);
-	if (value_out == NULL) {
-		return NULL;
+		/* get the last ten bits of both surrogates, concatenate them and add 65536 */
+		unicode = 0x10000 + (((unicode & 0x3FF) << 10) | (low_surrogate & 0x3FF));
 	}
 
-	for (;
-		(input->position < end_position)
-		&& (input->position < input->content_length)
-		&& (input->content[input->position] != '\"')
-		&& (input->content[input->position] != '\0');
-		value_out->position++, input->position++) {
-		if (input->content[input->position] != '\\') { /* regular character */
-			value_out->content[value_out->position] = input->content[input->position];
-		} else { /* special character */
-			input->position++; /* skip initial '\\' */
-			switch (input->content[input->position]) {
-				case 'b':
-					value_out->content[value_out->position] = '\b';
-					break;
-				case 'f':
-					value_out->content[value_out->position] = '\f';
-					break;
-				case 'n':
-					value_out->content[value_out->position] = '\n';
-					break;
-				case 'r':
-					value_out->content[value_out->position] = '\r';
-					break;
-				case 't':
-					value_out->content[value_out->position] = '\t';
-					break;
-				case 'u': {/* transcode utf16 to utf8. See RFC 2781 and RFC 3629 */
-						if ((input->position + 4) >= input->content_length) {
-							parsebuffer_deallocate(value_out, pool);
-							return NULL;
-						}
+	output->position += utf8_encode(unicode, output->content + output->position);
 
-						/* valid hex digit following '\u'? */
-						if ((!isxdigit(input->content[input->position + 1])) || (!isxdigit(input->content[input->position + 2])) || (!isxdigit(input->content[input->position + 3])) || (!isxdigit(input->content[input->position + 4]))) {
-							parsebuffer_deallocate(value_out, pool);
-							return NULL;
-						}
+	return true;
+}
 
-						input->position++;
-						uint32_t unicode = parse_hex4(input);
-						input->position += 4;
-						uint32_t low_surrogate = UINT_MAX;
-						if (unicode == UINT_MAX) {
-							parsebuffer_deallocate(value_out, pool);
-							return NULL;
-						}
+/* Unescape the escape sequence at the current position of input
+ * and write it to output. Both positions are advanced. */
+static bool parse_escape_sequence(buffer_t * const input, buffer_t * const output) {
+	input->position++; /* skip initial '\\' */
+	if (input->position >= input->content_length) {
+		return false;
+	}
 
-						/* invalid characters, only valid for low half surrogate */
-						if ((unicode >= 0xDC00) && (unicode <= 0xDFFF)) {
-							parsebuffer_deallocate(value_out, pool);
-						}
+	const unsigned char escaped = input->content[input->position];
+	input->position++;
+	if (escaped == 'u') {
+		return parse_unicode_escape(input, output);
+	}
 
-						/* UTF-16 surrogate pair? */
-						if ((unicode >= 0xD800) && (unicode <= 0xDBFF)) {
-							if ((input->position + 6) >= input->content_length) {
-								parsebuffer_deallocate(value_out, pool);
-								return NULL;
-							}
-
-							/* valid \uxxxx ? */
-							if ((input->content[input->position] != '\\') || (input->content[input->position + 1] != 'u') || (!isxdigit(input->content[input->position + 2])) || (!isxdigit(input->content[input->position + 3])) || (!isxdigit(input->content[input->position + 4])) || (!isxdigit(input->content[input->position + 5]))) {
-								parsebuffer_deallocate(value_out, pool);
-								return NULL;
-							}
-
-							input->position += 2;
-							low_surrogate = parse_hex4(input);
-							input->position += 4;
-
-							/* invalid low surrogate */
-							if ((low_surrogate < 0xDC00) || (low_surrogate > 0xDFFF)) {
-								parsebuffer_deallocate(value_out, pool);
-								return NULL;
-							}
-
-							/* get the last ten bits of both surrogates, concatenate them and add 65536 */
-							unicode = 0x10000 + (((unicode & 0x3FF) << 10) | (low_surrogate & 0x3FF));
-						}
+	/* unknown escape sequences stand for the character itself */
+	const unsigned char character = escaped_characters[escaped];
+	output->content[output->position] = (character != 0) ? character : escaped;
+	output->position++;
 
-						if (unicode < 0x80) { /* ASCII */
-							length = 1;
-						} else if (unicode < 0x800) { /* at most 11 bits -> 2 bytes */
-							length = 2;
-						} else if (unicode < 0x10000) { /* at most 16 bits -> 3 bytes */
-							length = 3;
-						} else if (unicode < 0x200000) { /* at most 21 bits -> 4 bytes */
-							length = 4;
-						} else { /* invalid */
-							parsebuffer_deallocate(value_out, pool);
-							return NULL;
-						}
+	return true;
+}
 
-						value_out->position += length;
-
-						static const unsigned char firstByteMark[7] = {0x00, 0x00, 0xC0, 0xE0, 0xF0};
-						switch (length) {
-							case 4:
-								value_out->position--;
-								/* lowest 6 bit preceeded by '10' */
-								value_out->content[value_out->position] = ((unicode | 0x80) & 0xBF);
-								unicode >>= 6;
-							case 3:
-								value_out->position--;
-								/* next 6 bit preceeded by '10' */
-								value_out->content[value_out->position] = ((unicode | 0x80) & 0xBF);
-								unicode >>= 6;
-							case 2:
-								value_out->position--;
-								/* next 6 bit preceeded by '10' */
-								value_out->content[value_out->position] = ((unicode | 0x80) & 0xBF);
-								unicode >>= 6;
-							case 1:
-								value_out->position--;
-								value_out->content[value_out->position] = (unicode | firstByteMark[length]);
-						}
-						value_out->position += length;
-					}
-					break;
-				default:
-					value_out->content[value_out->position] = input->content[input->position];
-					break;
+/* Unescape the string content between the current position of input and
+ * end_position (the closing '"') and write it to output. first_delimiter is
+ * the position of the first '\\' or end_position if there is none. */
+static bool unescape_string(buffer_t * const input, const size_t first_delimiter, const size_t end_position, buffer_t * const output) {
+	/* copy everything between escape sequences in one go,
+	 * in situ the output lags behind the input, so the two can overlap */
+	size_t run_end = first_delimiter;
+	while (true) {
+		memmove(output->content + output->position, input->content + input->position, run_end - input->position);
+		output->position += run_end - input->position;
+		input->position = run_end;
+		if (input->position >= end_position) {
+			return true;
+		}
+
+		/* only escape sequences are left before end_position, runs of them are
+		 * decoded one after the other without looking for the next delimiter */
+		do {
+			if (!parse_escape_sequence(input, output) || (input->position > end_position)) {
+				return false;
 			}
+		} while ((input->position < end_position) && (input->content[input->position] == '\\'));
+		run_end = find_string_delimiter(input->content, input->position, end_position);
+	}
+}
+
+/* Check the UTF-8 sequence at *position, it has to be the shortest form of a
+ * code point up to U+10FFFF that isn't a surrogate. *position is moved after
+ * the sequence, or to the first byte that doesn't fit if it is invalid. */
+static bool utf8_check_sequence(const unsigned char * const content, const size_t end, size_t * const position) {
+	const unsigned char first = content[*position];
+	size_t length;
+	unsigned char minimum = 0x80; /* bounds of the second byte */
+	unsigned char maximum = 0xBF;
+	if ((first >= 0xC2) && (first <= 0xDF)) {
+		length = 2;
+	} else if ((first >= 0xE0) && (first <= 0xEF)) {
+		length = 3;
+		if (first == 0xE0) { /* overlong */
+			minimum = 0xA0;
+		} else if (first == 0xED) { /* surrogates */
+			maximum = 0x9F;
+		}
+	} else if ((first >= 0xF0) && (first <= 0xF4)) {
+		length = 4;
+		if (first == 0xF0) { /* overlong */
+			minimum = 0x90;
+		} else if (first == 0xF4) { /* above U+10FFFF */
+			maximum = 0x8F;
+		}
+	} else {
+		return false;
+	}
+	(*position)++;
+
+	for (size_t i = 1; i < length; i++) {
+		if ((*position >= end) || (content[*position] < minimum) || (content[*position] > maximum)) {
+			return false;
+		}
+		(*position)++;
+		minimum = 0x80;
+		maximum = 0xBF;
+	}
+
+	return true;
+}
+
+#ifdef MCJSON_X86_DISPATCH
+/* UTF-8 validation with lookup tables, see "Validating UTF-8 In Less Than One
+ * Instruction Per Byte" by John Keiser and Daniel Lemire. Every pair of bytes is
+ * looked up by the high and low nibble of the first and the high nibble of the
+ * second byte, each table has a bit for every error that is possible with these
+ * nibbles, so the pair is invalid if a bit is set in all three of them. */
+#define UTF8_TOO_SHORT (1 << 0) /* lead byte without a continuation byte */
+#define UTF8_TOO_LONG (1 << 1) /* continuation byte after ASCII */
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTINUATIONS (1 << 7) /* only valid as 3rd or 4th byte */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTINUATIONS)
+
+/* Look up 32 indices from 0 to 15 in a table that is repeated for both lanes. */
+#define UTF8_TABLE(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) \
+	_mm256_setr_epi8((char)(a), (char)(b), (char)(c), (char)(d), (char)(e), (char)(f), (char)(g), (char)(h), \
+		(char)(i), (char)(j), (char)(k), (char)(l), (char)(m), (char)(n), (char)(o), (char)(p), \
+		(char)(a), (char)(b), (char)(c), (char)(d), (char)(e), (char)(f), (char)(g), (char)(h), \
+		(char)(i), (char)(j), (char)(k), (char)(l), (char)(m), (char)(n), (char)(o), (char)(p))
+
+/* Nonzero bytes where input (together with the 3 bytes before it) is invalid. */
+__attribute__((target("avx2")))
+static __m256i utf8_block_errors(const __m256i input, const __m256i previous_input) {
+	const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+	/* the input shifted by 1 to 3 bytes, with the end of the previous input in front of it */
+	const __m256i shifted = _mm256_permute2x128_si256(previous_input, input, 0x21);
+	const __m256i previous1 = _mm256_alignr_epi8(input, shifted, 15);
+	const __m256i previous2 = _mm256_alignr_epi8(input, shifted, 14);
+	const __m256i previous3 = _mm256_alignr_epi8(input, shifted, 13);
+
+	const __m256i byte_1_high = _mm256_shuffle_epi8(UTF8_TABLE(
+			UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, /* ASCII */
+			UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+			UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, UTF8_TWO_CONTINUATIONS, /* continuation */
+			UTF8_TOO_SHORT | UTF8_OVERLONG_2, /* 1100____ */
+			UTF8_TOO_SHORT, /* 1101____ */
+			UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE, /* 1110____ */
+			UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4), /* 1111____ */
+		_mm256_and_si256(_mm256_srli_epi16(previous1, 4), low_nibble));
+	const __m256i byte_1_low = _mm256_shuffle_epi8(UTF8_TABLE(
+			UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, /* ____0000 */
+			UTF8_CARRY | UTF8_OVERLONG_2, /* ____0001 */
+			UTF8_CARRY,
+			UTF8_CARRY,
+			UTF8_CARRY | UTF8_TOO_LARGE, /* ____0100 */
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, /* ____1101 */
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+			UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+		_mm256_and_si256(previous1, low_nibble));
+	const __m256i byte_2_high = _mm256_shuffle_epi8(UTF8_TABLE(
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, /* ASCII */
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4, /* 1000____ */
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE, /* 1001____ */
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE, /* 101_____ */
+			UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+			UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT), /* lead byte */
+		_mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+	const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+	/* the 3rd and 4th byte of a sequence have to be continuation bytes, which is where two continuations are valid */
+	const __m256i third_byte = _mm256_subs_epu8(previous2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+	const __m256i fourth_byte = _mm256_subs_epu8(previous3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+	const __m256i continuations = _mm256_and_si256(_mm256_or_si256(third_byte, fourth_byte), _mm256_set1_epi8((char)0x80));
+
+	return _mm256_xor_si256(continuations, special_cases);
+}
+
+static bool utf8_is_valid_scalar(const unsigned char * const content, const size_t length);
+
+__attribute__((target("avx2")))
+static bool utf8_is_valid_avx2(const unsigned char * const content, const size_t length) {
+	if (length < 32) { /* shorter than one vector */
+		return utf8_is_valid_scalar(content, length);
+	}
+
+	/* nonzero if the last bytes of a block start a sequence that doesn't fit into it */
+	const __m256i incomplete_limits = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	__m256i errors = _mm256_setzero_si256();
+	__m256i incomplete = _mm256_setzero_si256();
+	__m256i previous = _mm256_setzero_si256();
+	size_t position = 0;
+	for (; (length - position) >= 32; position += 32) {
+		const __m256i input = _mm256_loadu_si256((const __m256i*)(content + position));
+		if (_mm256_movemask_epi8(input) == 0) { /* ASCII only */
+			errors = _mm256_or_si256(errors, incomplete);
+			incomplete = _mm256_setzero_si256();
+		} else {
+			errors = _mm256_or_si256(errors, utf8_block_errors(input, previous));
+			incomplete = _mm256_subs_epu8(input, incomplete_limits);
+		}
+		previous = input;
+	}
+
+	/* the rest is padded with zeroes, which also ends any sequence that is still incomplete */
+	unsigned char rest[32] = {0};
+	memcpy(rest, content + position, length - position);
+	errors = _mm256_or_si256(errors, utf8_block_errors(_mm256_loadu_si256((const __m256i*)rest), previous));
+
+	return _mm256_testz_si256(errors, errors) != 0;
+}
+#endif
+
+/* Check if length bytes of content are valid UTF-8, one sequence at a time. */
+static bool utf8_is_valid_scalar(const unsigned char * const content, const size_t length) {
+	size_t position = 0;
+	while (position < length) {
+#if defined(__SSE2__)
+		if (((length - position) >= 16) && (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(content + position))) == 0)) { /* 16 ASCII characters */
+			position += 16;
+			continue;
+		}
+#endif
+		if (content[position] < 0x80) {
+			position++;
+		} else if (!utf8_check_sequence(content, length, &position)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Checks if length bytes of content are valid UTF-8. */
+typedef bool (*utf8_validator)(const unsigned char * const content, const size_t length);
+
+/* pick the fastest UTF-8 validator the CPU supports */
+static utf8_validator select_utf8_validator(void) {
+#ifdef MCJSON_X86_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return utf8_is_valid_avx2;
+	}
+#endif
+	return utf8_is_valid_scalar;
+}
+
+/* The validator for a parse with options, it is selected once per parse.
+ * NULL if options->validate_utf8 is false. */
+static utf8_validator parse_utf8_validator(const mcJSON_ParseOptions * const options) {
+	return options->validate_utf8 ? select_utf8_validator() : NULL;
+}
+
+/* Parse the input text into an unescaped cstring, and populate item.
+ * The string is checked with validate_utf8 unless it is NULL. */
+static buffer_t *parse_string(mcJSON * const item, buffer_t * const input, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options, const utf8_validator validate_utf8) {
+	if (input->content[input->position] != '\"') { /* not a string! */
+		return NULL;
+	}
+
+	input->position++;
+
+	/* find the position of the closing '"', jumping from escape sequence to escape sequence */
+	const size_t first_delimiter = find_string_delimiter(input->content, input->position, input->content_length);
+	size_t end_position = first_delimiter;
+	while ((end_position < input->content_length) && (input->content[end_position] == '\\')) {
+		/* Skip escaped characters, but never the end of the input */
+		if (((end_position + 1) >= input->content_length) || (input->content[end_position + 1] == '\0')) {
+			return NULL;
+		}
+		end_position = find_string_delimiter(input->content, end_position + 2, input->content_length);
+	}
+
+	if ((validate_utf8 != NULL) && !validate_utf8(input->content + input->position, end_position - input->position)) {
+		return NULL;
+	}
+
+	/* in situ the closing '"' gets overwritten by the terminating '\0' */
+	const bool closing_quote = (end_position < input->content_length) && (input->content[end_position] == '\"');
+	const bool in_situ = options->in_situ && (end_position < input->content_length);
+
+	/* strings without escape sequences can be used directly if there is a byte after them */
+	if (options->borrow_strings && !in_situ && (first_delimiter == end_position) && (end_position < input->content_length)) {
+		item->valuestring = string_view_allocate(input->content + input->position, end_position - input->position, context);
+		if (item->valuestring == NULL) {
+			return NULL;
+		}
+		item->valuestring_is_borrowed = true;
+		item->type = mcJSON_String;
+		input->position = end_position;
+		if (input->content[input->position] == '\"') {
+			input->position++;
 		}
+
+		return input;
+	}
+
+	/* unescaping only makes the string shorter, so it can also be done inside the input */
+	buffer_t *value_out = NULL;
+	if (in_situ) {
+		value_out = string_view_allocate(input->content + input->position, end_position - input->position, context);
+	} else {
+		value_out = parsebuffer_allocate(end_position - input->position + 1, 0, context);
+	}
+	if (value_out == NULL) {
+		return NULL;
 	}
+
+	if (!unescape_string(input, first_delimiter, end_position, value_out)) {
+		string_deallocate(value_out, in_situ, context);
+		return NULL;
+	}
+
 	/* null terminate the output string */
 	value_out->content[value_out->position] = '\0';
 	value_out->content_length = value_out->position + 1;
-	if (input->content[input->position] == '\"') {
+	if (closing_quote) {
 		input->position++;
 	}
 	item->valuestring = value_out;
+	item->valuestring_is_borrowed = in_situ;
 	item->type = mcJSON_String;
 
 	return input;
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
-static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buffer) {
+static buffer_t *print_string_ptr(const buffer_t * const string, buffer_t * const buffer, const mcJSON_Context * const context) {
 	buffer_t *output = NULL;
 
 	/* empty string */
 	if ((string == NULL) || (string->content_length == 0)) {
-		output = printbuffer_allocate(3, buffer);
+		output = printbuffer_allocate(3, buffer, context);
 		if (output == NULL) {
 			return NULL;
 		}
 		if (output->content == NULL) {
-			buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+			context_buffer_destroy(output, context);
 			return NULL;
 		}
 
@@ -495,7 +1374,7 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 		if (buffer_copy_from_raw(output, output->position, (unsigned char*)"\"\"", 0, 3) != 0) {
 			output->content[output->position] = '\0';
 			if (buffer == NULL) {
-				buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+				context_buffer_destroy(output, context);
 			}
 			return NULL;
 		}
@@ -507,24 +1386,27 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 	}
 
 	/* get the number of additional characters needed to encode special characters */
+	/* The string is only read through a local index, names can be shared
+	 * between trees that are printed by different threads. */
+	size_t index;
 	size_t additional_characters = 0; /* number of additional chars needed for escaping */
-	for (string->position = 0; string->position < (string->content_length - 1); string->position++) {
-		if (strchr("\"\\\b\f\n\r\t", string->content[string->position])) {
+	for (index = 0; index < (string->content_length - 1); index++) {
+		if (strchr("\"\\\b\f\n\r\t", string->content[index])) {
 			/* additional space for '\\' needed */
 			additional_characters++;
-		} else if (string->content[string->position] < 32) {
+		} else if (string->content[index] < 32) {
 			/* "\\uXXXX" -> 6 additional characters */
 			additional_characters += 6;
 		}
 	}
 
 	/* allocate output */
-	output = printbuffer_allocate(string->content_length + additional_characters + 3, buffer);
+	output = printbuffer_allocate(string->content_length + additional_characters + 3, buffer, context);
 	if (output == NULL) {
 		return NULL;
 	}
 	if (output->content == NULL) {
-		buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+		context_buffer_destroy(output, context);
 		return NULL;
 	}
 
@@ -539,7 +1421,7 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 		if ((buffer_copy(output, output->position, string, 0, string->content_length)) != 0) {
 			output->content[output->position] = '\0';
 			if (buffer == NULL) {
-				buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+				context_buffer_destroy(output, context);
 			}
 			return NULL;
 		}
@@ -557,12 +1439,12 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 	/* start output with double quote */
 	output->content[output->position] = '\"';
 	output->position++;
-	for (string->position = 0; (string->position < (string->content_length - 1)) && (output->position < output->buffer_length); string->position++, output->position++) {
-		if ((string->content[string->position] > 31)
-				&& (string->content[string->position] != '\"')
-				&& (string->content[string->position] != '\\')) {
+	for (index = 0; (index < (string->content_length - 1)) && (output->position < output->buffer_length); index++, output->position++) {
+		if ((string->content[index] > 31)
+				&& (string->content[index] != '\"')
+				&& (string->content[index] != '\\')) {
 			/* normal characters, just print it to the output */
-			output->content[output->position] = string->content[string->position];
+			output->content[output->position] = string->content[index];
 		} else {
 			/* special characters that need to be escaped */
 			output->content[output->position] = '\\';
@@ -572,12 +1454,12 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 			if ((output->position + 1) > output->buffer_length) {
 				output->content[output->position] = '\0';
 				if (buffer == NULL) {
-					buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+					context_buffer_destroy(output, context);
 				}
 				return NULL;
 			}
 
-			switch (string->content[string->position]) {
+			switch (string->content[index]) {
 				case '\\':
 					output->content[output->position] = '\\';
 					break;
@@ -603,11 +1485,11 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 					if ((output->position + 6) > output->buffer_length) {
 						output->content[output->position] = '\0';
 						if (buffer == NULL) {
-							buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+							context_buffer_destroy(output, context);
 						}
 						return NULL;
 					}
-					snprintf((char*)output->content + output->position, 6, "u%04x", string->content[string->position]);
+					snprintf((char*)output->content + output->position, 6, "u%04x", string->content[index]);
 					output->position += 5; /* not +6 because the loop does this for us. */
 					break;
 			}
@@ -618,7 +1500,7 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 	if ((output->position + 2) > output->buffer_length) {
 		output->content[output->position] = '\0';
 		if (buffer == NULL) {
-			buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+			context_buffer_destroy(output, context);
 		}
 		return NULL;
 	}
@@ -631,17 +1513,15 @@ static buffer_t *print_string_ptr(buffer_t * const string, buffer_t * const buff
 }
 
 /* Invoke print_string_ptr (which is useful) on an item. */
-static buffer_t *print_string(mcJSON * const item, buffer_t * const buffer) {
-	return print_string_ptr(item->valuestring, buffer);
+static buffer_t *print_string(mcJSON * const item, buffer_t * const buffer, const mcJSON_Context * const context) {
+	return print_string_ptr(item->valuestring, buffer, context);
 }
 
 /* Predeclare these prototypes. */
-static buffer_t *parse_value(mcJSON * const item, buffer_t * const input, mempool_t * const pool);
-static buffer_t *print_value(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer);
-static buffer_t *parse_array(mcJSON * const item, buffer_t * const input, mempool_t * const pool);
-static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer);
-static buffer_t *parse_object(mcJSON * const item, buffer_t * const input, mempool_t * const pool);
-static buffer_t *print_object(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer);
+static buffer_t *parse_value(mcJSON * const item, buffer_t * const input, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options, const utf8_validator validate_utf8);
+static buffer_t *print_value(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context);
+static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context);
+static buffer_t *print_object(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context);
 
 /* Utility to jump whitespace and cr/lf */
 static buffer_t *skip(buffer_t * const input) {
@@ -660,20 +1540,23 @@ static buffer_t *skip(buffer_t * const input) {
  * The size needs to be large enough otherwise allocation
  * will fail at some point. */
 mcJSON *mcJSON_ParseWithBuffer(buffer_t * const json, mempool_t * const pool){
+	return mcJSON_ParseWithOptions(json, pool, NULL);
+}
+
+/* Parse the root value, the pool is left alone if this fails. */
+static mcJSON *parse_root(buffer_t * const json, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options) {
 	json->position = 0; /* TODO could later be replaced with a position parameter */
 
-	mcJSON *root = mcJSON_New_Item(pool);
+	mcJSON *root = mcJSON_New_Item(context);
 	if (root == NULL) { /* memory fail */
 		return NULL;
 	}
 
 
 	/* now parse */
-	if (parse_value(root, skip(json), pool) == NULL) {
-		if (pool == NULL) {
-			mcJSON_Delete(root);
-		} else {
-			buffer_destroy_with_custom_deallocator(pool, mcJSON_free);
+	if (parse_value(root, skip(json), context, options, parse_utf8_validator(options)) == NULL) {
+		if (context->pool == NULL) {
+			delete_item(root, context);
 		}
 		return NULL;
 	}
@@ -681,254 +1564,796 @@ mcJSON *mcJSON_ParseWithBuffer(buffer_t * const json, mempool_t * const pool){
 	return root;
 }
 
-mcJSON *mcJSON_ParseBuffered(buffer_t * const input_string, const size_t buffer_size) {
-	mempool_t *pool = buffer_create_with_custom_allocator(buffer_size, buffer_size, mcJSON_malloc, mcJSON_free);
-	if (pool == NULL) {
+mcJSON *mcJSON_ParseWithContext(buffer_t * const json, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	if ((context->max_length != 0) && (json->content_length > context->max_length)) {
 		return NULL;
 	}
+	const mcJSON_ParseOptions * const options = (context->options == NULL) ? &default_parse_options : context->options;
 
-	mcJSON *json = mcJSON_ParseWithBuffer(input_string, pool);
-	if (json != NULL) {
-		mcJSON_free(pool); /* free the pool description, not the content */
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(context->pool);
+	mcJSON *root = parse_root(json, context, options);
+	if (root == NULL) {
+		mcJSON_PoolRollback(context->pool, marker, true);
 	}
 
-	return json;
+	return root;
 }
 
-/* Default options for mcJSON_Parse */
-mcJSON *mcJSON_Parse(buffer_t * const json) {
-	return mcJSON_ParseWithBuffer(json, NULL);
-}
+mcJSON *mcJSON_ParseWithOptions(buffer_t * const json, mempool_t * const pool, const mcJSON_ParseOptions * const options) {
+	mcJSON_Context context = pool_context(pool);
+	context.options = options;
 
-/* Render a mcJSON item/entity/structure to text. */
-buffer_t *mcJSON_Print(mcJSON * const item) {
-	return print_value(item, 0, true, NULL);
+	return mcJSON_ParseWithContext(json, &context);
 }
-buffer_t *mcJSON_PrintUnformatted(mcJSON * const item) {
-	return print_value(item, 0, false, NULL);
+
+mcJSON *mcJSON_ParseInSitu(buffer_t * const json, mempool_t * const pool) {
+	const mcJSON_ParseOptions options = {
+		false, /* borrow_strings */
+		true, /* in_situ */
+		0, /* max_depth */
+		false, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+
+	return mcJSON_ParseWithOptions(json, pool, &options);
 }
 
-buffer_t *mcJSON_PrintBuffered(mcJSON * const item, const size_t prebuffer, const bool format) {
-	//allocate prebuffer
-	unsigned char *buffer_content = mcJSON_malloc(prebuffer);
-	if (buffer_content == NULL) {
-		return NULL;
-	}
-	buffer_t *buffer = mcJSON_malloc(sizeof(buffer_t));
-	if (buffer == NULL) {
-		mcJSON_free(buffer_content);
+mcJSON *mcJSON_ParseBufferedWithContext(buffer_t * const input_string, const size_t buffer_size, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+
+	mempool_t *pool = context_buffer_create(buffer_size, buffer_size, context);
+	if (pool == NULL) {
 		return NULL;
 	}
-	buffer_init_with_pointer(buffer, buffer_content, prebuffer, prebuffer);
-	if (print_value(item, 0, format, buffer) == NULL) {
-		buffer_destroy_with_custom_deallocator(buffer, mcJSON_free);
-		return NULL;
+
+	mcJSON_Context buffered_context = *context;
+	buffered_context.pool = pool;
+	mcJSON *json = mcJSON_ParseWithContext(input_string, &buffered_context);
+	if (json == NULL) {
+		context_buffer_destroy(pool, context);
+	} else {
+		context_free(context, pool); /* free the pool description, not the content */
 	}
-	return buffer;
+
+	return json;
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static buffer_t *parse_value(mcJSON * const item, buffer_t * const input, mempool_t * const pool) {
-	if ((input == NULL) || (input->content == NULL)) {
+mcJSON *mcJSON_ParseBuffered(buffer_t * const input_string, const size_t buffer_size) {
+	const mcJSON_Context context = pool_context(NULL);
+	return mcJSON_ParseBufferedWithContext(input_string, buffer_size, &context);
+}
+
+mcJSON *mcJSON_ParseRecord(buffer_t * const json, mempool_t * const pool) {
+	if ((json == NULL) || (json->content == NULL) || (json->content_length == 0) || (json->content[json->content_length - 1] != '\0')) {
 		return NULL;
 	}
 
-	if (buffer_compare_to_raw_partial(input, input->position, (unsigned char*)"null", sizeof("null"), 0, sizeof("null") - 1) == 0) {
-		item->type = mcJSON_NULL;
-		input->position += sizeof("null") - 1;
-		return input;
+	const mcJSON_Context context = pool_context(pool);
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	mcJSON *root = parse_root(json, &context, &default_parse_options);
+	if (root == NULL) {
+		mcJSON_PoolRollback(pool, marker, true);
+		return NULL;
 	}
-	if (buffer_compare_to_raw_partial(input, input->position, (unsigned char*)"false", sizeof("false"), 0, sizeof("false") - 1) == 0) {
-		item->type = mcJSON_False;
-		input->position += sizeof("false") - 1;
-		return input;
+	if (skip(json)->position != (json->content_length - 1)) { /* more than one value */
+		if (pool == NULL) {
+			mcJSON_Delete(root);
+		}
+		mcJSON_PoolRollback(pool, marker, true);
+		return NULL;
 	}
-	if (buffer_compare_to_raw_partial(input, input->position, (unsigned char*)"true", sizeof("true"), 0, sizeof("true") - 1) == 0) {
-		item->type = mcJSON_True;
-		input->position += sizeof("true") - 1;
-		return input;
+
+	return root;
+}
+
+static mcJSON *parse_line(buffer_t * const record, mempool_t * const pool) {
+	mcJSON_PoolReset(pool, false); /* the previous tree isn't needed anymore */
+	return mcJSON_ParseRecord(record, pool);
+}
+
+bool mcJSON_ParseLines(const buffer_t * const lines, const size_t pool_size, const mcJSON_LineCallback callback, void * const userdata) {
+	if ((lines == NULL) || (lines->content == NULL) || (callback == NULL)) {
+		return false;
 	}
-	if (input->content[input->position] == '\"') {
-		return parse_string(item, input, pool);
+
+	/* the arena grows if a record doesn't fit and keeps its biggest block when it is reset */
+	mempool_t *pool = mcJSON_ArenaCreate(pool_size);
+	if (pool == NULL) {
+		return false;
 	}
-	if ((input->content[input->position] == '-') || ((input->content[input->position] >= '0') && (input->content[input->position] <= '9'))) {
-		return parse_number(item, input);
+	buffer_t *record = NULL; /* '\0' terminated copy of the current line */
+
+	size_t end = lines->content_length;
+	if ((end != 0) && (lines->content[end - 1] == '\0')) {
+		end--;
 	}
-	if (input->content[input->position] == '[') {
-		return parse_array(item, input, pool);
+
+	bool success = true;
+	size_t next_line = 0;
+	for (size_t offset = 0; success && (offset < end); offset = next_line) {
+		const unsigned char *newline = memchr(lines->content + offset, '\n', end - offset);
+		const size_t length = (newline == NULL) ? (end - offset) : (size_t)(newline - (lines->content + offset));
+		next_line = offset + length + 1;
+
+		/* skip empty lines */
+		size_t position = offset;
+		while ((position < (offset + length)) && (lines->content[position] <= 32) && (lines->content[position] != '\0')) {
+			position++;
+		}
+		if (position == (offset + length)) {
+			continue;
+		}
+
+		if ((record == NULL) || (record->buffer_length <= length)) {
+			if (record != NULL) {
+				buffer_destroy_with_custom_deallocator(record, mcJSON_free);
+			}
+			record = buffer_create_with_custom_allocator(length + 1, length + 1, mcJSON_malloc, mcJSON_free);
+			if (record == NULL) {
+				success = false;
+				break;
+			}
+		}
+		memcpy(record->content, lines->content + offset, length);
+		record->content[length] = '\0';
+		record->content_length = length + 1;
+
+		mcJSON *json = parse_line(record, pool);
+		success = callback(userdata, json, offset, length);
 	}
-	if (input->content[input->position] == '{') {
-		return parse_object(item, input, pool);
+
+	if (record != NULL) {
+		buffer_destroy_with_custom_deallocator(record, mcJSON_free);
 	}
+	mcJSON_ArenaDestroy(pool);
 
-	return NULL; /* failure. */
+	return success;
 }
 
-/* Render a value to text. */
-static buffer_t *print_value(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer) {
-	if (item == NULL) {
-		return NULL;
-	}
+/* Size of an allocation in a mempool_t including the padding in front of the next one. */
+static size_t aligned_size(const size_t size) {
+	const size_t alignment = ALIGNMENT_OF(intmax_t);
+	return ((size + alignment - 1) / alignment) * alignment;
+}
 
-	/* buffered printing */
-	if (buffer != NULL) {
-		switch (item->type) {
-			case mcJSON_NULL:
-				if (printbuffer_allocate(5, buffer) == NULL) {
-					return NULL;
-				}
-				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"null", 0, 5) != 0) {
-					if (buffer->content != NULL) {
-						buffer->content[buffer->position] = '\0';
-					}
-					return NULL;
+/* Mirrors the allocations of the parser: Every value gets an item, except for
+ * the values of object members, which are parsed into the item that was created
+ * for the name. Every string, including names, gets a buffer_t and the raw length
+ * of the string (including escape sequences) + 1 bytes of content. */
+size_t mcJSON_ParseBufferSize(const buffer_t * const json) {
+	if ((json == NULL) || (json->content == NULL)) {
+		return 0;
+	}
+
+	const unsigned char * const content = json->content;
+	size_t size = 0;
+	size_t last_allocation = 0; /* doesn't need padding after it */
+	size_t depth = 0;
+	bool member_value = false; /* the next value belongs to a name */
+	size_t position = 0;
+	while ((position < json->content_length) && (content[position] != '\0')) {
+		const unsigned char character = content[position];
+		if (character <= 32) {
+			position++;
+			continue;
+		}
+
+		switch (character) {
+			case ':':
+				member_value = true;
+				position++;
+				continue;
+
+			case ',':
+				position++;
+				continue;
+
+			case '}':
+			case ']':
+				if (depth == 0) {
+					return 0;
 				}
-				buffer->position += 4;
+				depth--;
+				position++;
 				break;
-			case mcJSON_False:
-				if (printbuffer_allocate(6, buffer) == NULL) {
-					return NULL;
-				}
-				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"false", 0, 6) != 0) {
-					if (buffer->content != NULL) {
-						buffer->content[buffer->position] = '\0';
-					}
-					return NULL;
+
+			case '{':
+			case '[':
+				if (!member_value) {
+					size += aligned_size(sizeof(mcJSON));
+					last_allocation = sizeof(mcJSON);
 				}
-				buffer->position += 5;
+				depth++;
+				position++;
 				break;
-			case mcJSON_True:
-				if (printbuffer_allocate(5, buffer) == NULL) {
-					return NULL;
-				}
-				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"true", 0, 5) != 0) {
-					if (buffer->content != NULL) {
-						buffer->content[buffer->position] = '\0';
+
+			case '\"': {
+				/* find the closing '"' the same way as parse_string */
+				size_t end = find_string_delimiter(content, position + 1, json->content_length);
+				while ((end < json->content_length) && (content[end] == '\\')) {
+					if (((end + 1) >= json->content_length) || (content[end + 1] == '\0')) {
+						return 0;
 					}
-					return NULL;
+					end = find_string_delimiter(content, end + 2, json->content_length);
 				}
-				buffer->position += 4;
-				break;
-			case mcJSON_Number:
-				if(print_number(item, buffer) == NULL) {
-					return NULL;
-				}
-				break;
-			case mcJSON_String:
-				if (print_string(item, buffer) == NULL) {
-					return NULL;
+
+				if (!member_value) { /* string value or name */
+					size += aligned_size(sizeof(mcJSON));
 				}
+				size += aligned_size(sizeof(buffer_t)) + aligned_size(end - position);
+				last_allocation = end - position;
+				position = ((end < json->content_length) && (content[end] == '\"')) ? (end + 1) : end;
 				break;
-			case mcJSON_Array:
-				if (print_array(item, depth, format, buffer) == NULL) {
-					return NULL;
+			}
+
+			default: /* number or literal */
+				if (!member_value) {
+					size += aligned_size(sizeof(mcJSON));
+					last_allocation = sizeof(mcJSON);
 				}
-				break;
-			case mcJSON_Object:
-				if (print_object(item, depth, format, buffer) == NULL) {
-					return NULL;
+				while ((position < json->content_length) && (content[position] > 32) && (content[position] != ',') && (content[position] != ']') && (content[position] != '}')) {
+					position++;
 				}
 				break;
 		}
-		return buffer;
+
+		member_value = false;
+		if (depth == 0) { /* the root value is finished */
+			break;
+		}
 	}
 
-	/* non buffered printing */
-	switch (item->type) {
-		case mcJSON_NULL:
-			return buffer_create_from_string_on_heap("null");
-		case mcJSON_False:
-			return buffer_create_from_string_on_heap("false");
-		case mcJSON_True:
-			return buffer_create_from_string_on_heap("true");
-		case mcJSON_Number:
-			return print_number(item, NULL);
-		case mcJSON_String:
-			return print_string(item, NULL);
-		case mcJSON_Array:
-			return print_array(item, depth, format, NULL);
-		case mcJSON_Object:
-			return print_object(item, depth, format, NULL);
-		default:
-			return NULL;
+	if (last_allocation == 0) { /* no value */
+		return 0;
 	}
+
+	return size - (aligned_size(last_allocation) - last_allocation);
 }
 
-/* Build an array from input text. */
-static buffer_t *parse_array(mcJSON * const item, buffer_t * const input, mempool_t * const pool) {
-	if ((input == NULL) || (input->content == NULL)) {
-		return NULL;
-	}
-	if (input->content[input->position] != '[') { /* not an array! */
+mcJSON *mcJSON_ParseBufferedExact(buffer_t * const json) {
+	const size_t size = mcJSON_ParseBufferSize(json);
+	if (size == 0) {
 		return NULL;
 	}
 
-	item->type = mcJSON_Array;
-	input->position++;
-	skip(input);
-	if (input->content[input->position] == ']') { /* empty array. */
-		input->position++;
-		return input;
-	}
+	return mcJSON_ParseBuffered(json, size);
+}
 
-	mcJSON *child = mcJSON_New_Item(pool);
-	item->length++;
-	item->child = child;
-	if (item->child == NULL) { /* memory fail */
+/* Default options for mcJSON_Parse */
+mcJSON *mcJSON_Parse(buffer_t * const json) {
+	return mcJSON_ParseWithBuffer(json, NULL);
+}
+
+/* Render a mcJSON item/entity/structure to text. */
+buffer_t *mcJSON_Print(mcJSON * const item) {
+	const mcJSON_Context context = pool_context(NULL);
+	return print_value(item, 0, true, NULL, &context);
+}
+buffer_t *mcJSON_PrintUnformatted(mcJSON * const item) {
+	const mcJSON_Context context = pool_context(NULL);
+	return print_value(item, 0, false, NULL, &context);
+}
+
+static buffer_t *print_buffered(mcJSON * const item, const size_t prebuffer, const bool format, const mcJSON_Context * const context) {
+	//allocate prebuffer, at least one byte to have content that can grow
+	const size_t size = (prebuffer == 0) ? 1 : prebuffer;
+	buffer_t *buffer = context_buffer_create(size, size, context);
+	if (buffer == NULL) {
 		return NULL;
 	}
-	if(skip(parse_value(child, skip(input), pool)) == NULL) {
+	if (print_value(item, 0, format, buffer, context) == NULL) {
+		context_buffer_destroy(buffer, context);
 		return NULL;
 	}
+	return buffer;
+}
 
-	while ((input->position < input->content_length) && (input->content[input->position] == ',')) {
-		mcJSON *new_item = mcJSON_New_Item(pool);
-		item->length++;
-		if (new_item == NULL) { /* memory fail */
-			return NULL;
-		}
-		child->next = new_item;
-		new_item->prev = child;
-		input->position++;
-		if (skip(parse_value(new_item, skip(input), pool)) == NULL) {
-			return NULL;
-		}
-		child = new_item;
-	}
+buffer_t *mcJSON_PrintBuffered(mcJSON * const item, const size_t prebuffer, const bool format) {
+	const mcJSON_Context context = pool_context(NULL);
+	return print_buffered(item, prebuffer, format, &context);
+}
 
-	if (input->content[input->position] == ']') { /* end of array */
-		input->position++;
-		return input;
+/* first guess for the size of the output, it grows as needed */
+#define CONTEXT_PREBUFFER 256
+
+buffer_t *mcJSON_PrintWithContext(mcJSON * const item, const bool format, const mcJSON_Context * const context) {
+	if (context == NULL) {
+		return format ? mcJSON_Print(item) : mcJSON_PrintUnformatted(item);
 	}
 
-	return NULL; /* malformed. */
+	return print_buffered(item, CONTEXT_PREBUFFER, format, context);
 }
 
-/* Render an array to text */
-static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer) {
-	if (item == NULL) {
+/* What a value starting with this byte can be. */
+typedef enum value_start {
+	VALUE_INVALID = 0,
+	VALUE_NULL,
+	VALUE_FALSE,
+	VALUE_TRUE,
+	VALUE_STRING,
+	VALUE_NUMBER,
+	VALUE_ARRAY,
+	VALUE_OBJECT
+} value_start;
+
+static const unsigned char value_starts[256] = {
+	['n'] = VALUE_NULL,
+	['f'] = VALUE_FALSE,
+	['t'] = VALUE_TRUE,
+	['\"'] = VALUE_STRING,
+	['-'] = VALUE_NUMBER,
+	['0'] = VALUE_NUMBER,
+	['1'] = VALUE_NUMBER,
+	['2'] = VALUE_NUMBER,
+	['3'] = VALUE_NUMBER,
+	['4'] = VALUE_NUMBER,
+	['5'] = VALUE_NUMBER,
+	['6'] = VALUE_NUMBER,
+	['7'] = VALUE_NUMBER,
+	['8'] = VALUE_NUMBER,
+	['9'] = VALUE_NUMBER,
+	['['] = VALUE_ARRAY,
+	['{'] = VALUE_OBJECT
+};
+
+/* Parse true, false or null into item. */
+static buffer_t *parse_literal(mcJSON * const item, buffer_t * const input, const char * const literal, const size_t length, const mcJSON_Type type) {
+	if ((input->position > input->content_length) || ((input->content_length - input->position) < length)
+			|| (memcmp(input->content + input->position, literal, length) != 0)) {
 		return NULL;
 	}
+	item->type = type;
+	input->position += length;
 
-	buffer_t *output = NULL;
+	return input;
+}
 
-	/* Explicitly handle item->length == 0 */
-	if (item->length == 0) { /* empty array */
-		output = printbuffer_allocate(3, buffer);
-		if (output == NULL) {
-			return NULL;
-		}
+/* Names that were already parsed into the pool, so that equal names of
+ * object members can share one buffer_t (see intern_names in mcJSON_ParseOptions).
+ * Open addressing with linear probing, size is a power of 2. */
+typedef struct interned_name {
+	buffer_t *name;
+	bool borrowed;
+} interned_name;
+
+typedef struct name_table {
+	interned_name *entries;
+	size_t size;
+	size_t count;
+} name_table;
+
+/* FNV-1a, borrowed names have the closing '"' instead of the '\0', so the last byte isn't hashed */
+static size_t name_hash(const buffer_t * const name) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; (i + 1) < name->content_length; i++) {
+		hash ^= name->content[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
 
-		/* fill with empty array */
-		output->content_length = output->position + 1;
-		if (buffer_copy_from_raw(output, output->position, (unsigned char*)"[]", 0, 3) != 0) {
-			if (output->content != NULL) {
-				output->content[output->position] = '\0';
-			}
-			if (buffer == NULL) {
-				buffer_destroy_with_custom_deallocator(output, mcJSON_free);
-			}
-			return NULL;
+static bool names_equal(const buffer_t * const first, const buffer_t * const second) {
+	return (first->content_length == second->content_length)
+		&& (memcmp(first->content, second->content, first->content_length - 1) == 0);
+}
+
+/* Entry with an equal name, or the empty one where it belongs. */
+static interned_name *name_table_find(const name_table * const table, const buffer_t * const name) {
+	size_t index = name_hash(name) & (table->size - 1);
+	while ((table->entries[index].name != NULL) && !names_equal(table->entries[index].name, name)) {
+		index = (index + 1) & (table->size - 1);
+	}
+
+	return &table->entries[index];
+}
+
+/* Make room for one more name, the table is at most half full. */
+static bool name_table_reserve(name_table * const table, const mcJSON_Context * const context) {
+	if ((2 * (table->count + 1)) <= table->size) {
+		return true;
+	}
+
+	name_table grown = {NULL, (table->size == 0) ? 64 : (2 * table->size), table->count};
+	grown.entries = (interned_name*)context_malloc(context, grown.size * sizeof(interned_name));
+	if (grown.entries == NULL) {
+		return false;
+	}
+	memset(grown.entries, 0, grown.size * sizeof(interned_name));
+	for (size_t i = 0; i < table->size; i++) {
+		if (table->entries[i].name != NULL) {
+			*name_table_find(&grown, table->entries[i].name) = table->entries[i];
+		}
+	}
+	context_free(context, table->entries);
+	*table = grown;
+
+	return true;
+}
+
+/* Replace the name of item with an equal one that is already in the pool.
+ * The name of item has to be the last thing allocated after marker, it is
+ * given back to the pool then. Interned names are constant (string_is_const)
+ * because they can be shared. */
+static bool intern_name(mcJSON * const item, name_table * const names, const mcJSON_PoolMarker marker, const mcJSON_Context * const context) {
+	if (!name_table_reserve(names, context)) {
+		return false;
+	}
+
+	interned_name * const entry = name_table_find(names, item->name);
+	if (entry->name == NULL) { /* first time */
+		entry->name = item->name;
+		entry->borrowed = item->name_is_borrowed;
+		names->count++;
+	} else {
+		mcJSON_PoolRollback(context->pool, marker, false);
+		item->name = entry->name;
+		item->name_is_borrowed = entry->borrowed;
+	}
+	item->string_is_const = true;
+
+	return true;
+}
+
+typedef enum name_resolution {
+	NAME_RESOLVED,
+	NAME_UNKNOWN, /* has to be parsed, resolving it again is pointless */
+	NAME_ESCAPED /* has to be parsed and resolved after unescaping it */
+} name_resolution;
+
+/* Point item to the name that options->resolve_name knows for the name at the
+ * current position of input, without allocating it. Only names without escape
+ * sequences can be resolved from the input. Names that aren't resolved are
+ * parsed by parse_string, which also validates the UTF-8 of unknown names, so
+ * only known names are validated here. */
+static name_resolution resolve_input_name(mcJSON * const item, buffer_t * const input, const mcJSON_ParseOptions * const options, const utf8_validator validate_utf8) {
+	const size_t start = input->position + 1;
+	if ((input->content[input->position] != '\"') || (start >= input->content_length)) {
+		return NAME_UNKNOWN;
+	}
+	const size_t end = find_string_delimiter(input->content, start, input->content_length);
+	if ((end >= input->content_length) || (input->content[end] != '\"')) { /* escape sequences */
+		return NAME_ESCAPED;
+	}
+
+	buffer_t * const name = options->resolve_name(options->resolver_data, input->content + start, end - start);
+	if ((name == NULL) || ((validate_utf8 != NULL) && !validate_utf8(input->content + start, end - start))) {
+		return NAME_UNKNOWN;
+	}
+	item->name = name;
+	item->string_is_const = true;
+	input->position = end + 1;
+
+	return NAME_RESOLVED;
+}
+
+/* Replace the parsed name of item with the one options->resolve_name knows.
+ * The name of item has to be the last thing allocated after marker. */
+static void resolve_parsed_name(mcJSON * const item, const mcJSON_PoolMarker marker, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options) {
+	buffer_t * const name = options->resolve_name(options->resolver_data, item->name->content, item->name->content_length - 1);
+	if (name == NULL) {
+		return;
+	}
+
+	if (context->pool != NULL) {
+		mcJSON_PoolRollback(context->pool, marker, false);
+	} else {
+		string_deallocate(item->name, item->name_is_borrowed, context);
+	}
+	item->name = name;
+	item->name_is_borrowed = false;
+	item->string_is_const = true;
+}
+
+/* Parse the name of an object member and the ':' after it. names can be NULL, otherwise the name is interned. */
+static buffer_t *parse_name(mcJSON * const item, buffer_t * const input, name_table * const names, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options, const utf8_validator validate_utf8) {
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(context->pool);
+	const name_resolution resolution = (options->resolve_name == NULL) ? NAME_UNKNOWN : resolve_input_name(item, skip(input), options, validate_utf8);
+	if (resolution != NAME_RESOLVED) {
+		if (parse_string(item, skip(input), context, options, validate_utf8) == NULL) {
+			return NULL;
+		}
+		item->name = item->valuestring; /* string was parsed to ->valuestring, but it was actually a name */
+		item->name_is_borrowed = item->valuestring_is_borrowed;
+		item->valuestring = NULL;
+		item->valuestring_is_borrowed = false;
+		if (resolution == NAME_ESCAPED) {
+			resolve_parsed_name(item, marker, context, options);
+		}
+		if ((names != NULL) && !item->string_is_const && !intern_name(item, names, marker, context)) {
+			return NULL;
+		}
+	}
+	if (skip(input)->content[input->position] != ':') { /* fail! */
+		return NULL;
+	}
+	input->position++;
+
+	return skip(input);
+}
+
+/* An array or object that is being parsed. */
+typedef struct parse_frame {
+	mcJSON *container;
+	mcJSON *last_child;
+} parse_frame;
+
+/* Append a new item to the array or object of frame. */
+static mcJSON *parse_append(parse_frame * const frame, const mcJSON_Context * const context) {
+	mcJSON *child = mcJSON_New_Item(context);
+	if (child == NULL) { /* memory fail */
+		return NULL;
+	}
+
+	if (frame->last_child == NULL) {
+		frame->container->child = child;
+	} else {
+		frame->last_child->next = child;
+		child->prev = frame->last_child;
+	}
+	frame->last_child = child;
+	frame->container->length++;
+
+	return child;
+}
+
+/* levels of nesting that fit on the C stack, deeper documents move the stack to the heap */
+#define PARSE_STACK_SIZE 32
+
+/* Make room for one more frame, a full stack is moved to one of twice the size on the heap. */
+static bool parse_stack_reserve(parse_frame ** const stack, size_t * const stack_size, const parse_frame * const local_stack, const size_t depth, const mcJSON_Context * const context) {
+	if (depth < *stack_size) {
+		return true;
+	}
+
+	parse_frame *new_stack = (parse_frame*)context_malloc(context, 2 * *stack_size * sizeof(parse_frame));
+	if (new_stack == NULL) {
+		return false;
+	}
+	memcpy(new_stack, *stack, *stack_size * sizeof(parse_frame));
+	if (*stack != local_stack) {
+		context_free(context, *stack);
+	}
+	*stack = new_stack;
+	*stack_size *= 2;
+
+	return true;
+}
+
+/* Parser core - when encountering text, process appropriately.
+ * Nested arrays and objects don't recurse, the open ones are kept
+ * on an explicit stack instead, so the nesting is only limited by
+ * options->max_depth and the available memory.
+ * validate_utf8 comes from parse_utf8_validator(options). */
+static buffer_t *parse_value(mcJSON * const item, buffer_t * const input, const mcJSON_Context * const context, const mcJSON_ParseOptions * const options, const utf8_validator validate_utf8) {
+	if ((input == NULL) || (input->content == NULL)) {
+		return NULL;
+	}
+
+	parse_frame local_stack[PARSE_STACK_SIZE];
+	parse_frame *stack = local_stack;
+	size_t stack_size = PARSE_STACK_SIZE;
+	size_t depth = 0;
+	mcJSON *current = item; /* the next value is parsed into this */
+	buffer_t *result = NULL;
+	/* interning only works in a pool, because interned names can't be freed */
+	name_table interned = {NULL, 0, 0};
+	name_table * const names = (options->intern_names && (context->pool != NULL)) ? &interned : NULL;
+	while (true) {
+		const unsigned char start = input->content[input->position];
+		switch ((value_start)value_starts[start]) {
+			case VALUE_NULL:
+				if (parse_literal(current, input, "null", sizeof("null") - 1, mcJSON_NULL) == NULL) {
+					goto cleanup;
+				}
+				break;
+			case VALUE_FALSE:
+				if (parse_literal(current, input, "false", sizeof("false") - 1, mcJSON_False) == NULL) {
+					goto cleanup;
+				}
+				break;
+			case VALUE_TRUE:
+				if (parse_literal(current, input, "true", sizeof("true") - 1, mcJSON_True) == NULL) {
+					goto cleanup;
+				}
+				break;
+			case VALUE_STRING:
+				if (parse_string(current, input, context, options, validate_utf8) == NULL) {
+					goto cleanup;
+				}
+				break;
+			case VALUE_NUMBER:
+				if (parse_number(current, input, context) == NULL) {
+					goto cleanup;
+				}
+				break;
+			case VALUE_ARRAY:
+			case VALUE_OBJECT: {
+					if ((options->max_depth != 0) && (depth >= options->max_depth)) { /* too deep */
+						goto cleanup;
+					}
+					const bool is_object = (start == '{');
+					current->type = is_object ? mcJSON_Object : mcJSON_Array;
+					input->position++;
+					skip(input);
+					if (input->content[input->position] == (is_object ? '}' : ']')) { /* empty array or object */
+						input->position++;
+						break;
+					}
+
+					if (!parse_stack_reserve(&stack, &stack_size, local_stack, depth, context)) {
+						goto cleanup;
+					}
+					stack[depth].container = current;
+					stack[depth].last_child = NULL;
+					depth++;
+
+					/* continue with the first element */
+					current = parse_append(&stack[depth - 1], context);
+					if ((current == NULL) || (is_object && (parse_name(current, input, names, context, options, validate_utf8) == NULL))) {
+						goto cleanup;
+					}
+					continue;
+				}
+			default:
+				goto cleanup; /* failure. */
+		}
+
+		/* the value is complete, go on with the next element or close arrays and objects */
+		while (true) {
+			if (depth == 0) {
+				result = input;
+				goto cleanup;
+			}
+
+			parse_frame * const frame = &stack[depth - 1];
+			const bool is_object = (frame->container->type == mcJSON_Object);
+			skip(input);
+			if (input->content[input->position] == ',') {
+				input->position++;
+				skip(input);
+				current = parse_append(frame, context);
+				if ((current == NULL) || (is_object && (parse_name(current, input, names, context, options, validate_utf8) == NULL))) {
+					goto cleanup;
+				}
+				break;
+			}
+			if (input->content[input->position] != (is_object ? '}' : ']')) { /* malformed. */
+				goto cleanup;
+			}
+			input->position++;
+			depth--;
+		}
+	}
+
+cleanup:
+	if (stack != local_stack) {
+		context_free(context, stack);
+	}
+	context_free(context, interned.entries);
+	return result;
+}
+
+/* Render a value to text. */
+static buffer_t *print_value(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context) {
+	if (item == NULL) {
+		return NULL;
+	}
+
+	/* buffered printing */
+	if (buffer != NULL) {
+		switch (item->type) {
+			case mcJSON_NULL:
+				if (printbuffer_allocate(5, buffer, context) == NULL) {
+					return NULL;
+				}
+				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"null", 0, 5) != 0) {
+					if (buffer->content != NULL) {
+						buffer->content[buffer->position] = '\0';
+					}
+					return NULL;
+				}
+				buffer->position += 4;
+				break;
+			case mcJSON_False:
+				if (printbuffer_allocate(6, buffer, context) == NULL) {
+					return NULL;
+				}
+				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"false", 0, 6) != 0) {
+					if (buffer->content != NULL) {
+						buffer->content[buffer->position] = '\0';
+					}
+					return NULL;
+				}
+				buffer->position += 5;
+				break;
+			case mcJSON_True:
+				if (printbuffer_allocate(5, buffer, context) == NULL) {
+					return NULL;
+				}
+				if (buffer_copy_from_raw(buffer, buffer->position, (unsigned char*)"true", 0, 5) != 0) {
+					if (buffer->content != NULL) {
+						buffer->content[buffer->position] = '\0';
+					}
+					return NULL;
+				}
+				buffer->position += 4;
+				break;
+			case mcJSON_Number:
+				if(print_number(item, buffer, context) == NULL) {
+					return NULL;
+				}
+				break;
+			case mcJSON_String:
+				if (print_string(item, buffer, context) == NULL) {
+					return NULL;
+				}
+				break;
+			case mcJSON_Array:
+				if (print_array(item, depth, format, buffer, context) == NULL) {
+					return NULL;
+				}
+				break;
+			case mcJSON_Object:
+				if (print_object(item, depth, format, buffer, context) == NULL) {
+					return NULL;
+				}
+				break;
+		}
+		return buffer;
+	}
+
+	/* non buffered printing */
+	switch (item->type) {
+		case mcJSON_NULL:
+			return context_string_create("null", context);
+		case mcJSON_False:
+			return context_string_create("false", context);
+		case mcJSON_True:
+			return context_string_create("true", context);
+		case mcJSON_Number:
+			return print_number(item, NULL, context);
+		case mcJSON_String:
+			return print_string(item, NULL, context);
+		case mcJSON_Array:
+			return print_array(item, depth, format, NULL, context);
+		case mcJSON_Object:
+			return print_object(item, depth, format, NULL, context);
+		default:
+			return NULL;
+	}
+}
+
+/* Render an array to text */
+static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context) {
+	if (item == NULL) {
+		return NULL;
+	}
+
+	buffer_t *output = NULL;
+
+	/* Explicitly handle item->length == 0 */
+	if (item->length == 0) { /* empty array */
+		output = printbuffer_allocate(3, buffer, context);
+		if (output == NULL) {
+			return NULL;
+		}
+
+		/* fill with empty array */
+		output->content_length = output->position + 1;
+		if (buffer_copy_from_raw(output, output->position, (unsigned char*)"[]", 0, 3) != 0) {
+			if (output->content != NULL) {
+				output->content[output->position] = '\0';
+			}
+			if (buffer == NULL) {
+				context_buffer_destroy(output, context);
+			}
+			return NULL;
 		}
 		output->position += 2;
 
@@ -940,7 +2365,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 	/* buffered */
 	if (buffer != NULL) {
 		/* allocate the buffer */
-		if (printbuffer_allocate(1, buffer) == NULL) {
+		if (printbuffer_allocate(1, buffer, context) == NULL) {
 			return NULL;
 		}
 
@@ -951,14 +2376,14 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 		mcJSON *child = item->child;
 		bool fail = false;
 		while ((child != NULL) && !fail) {
-			if (print_value(child, depth + 1, format, buffer) == NULL) {
+			if (print_value(child, depth + 1, format, buffer, context) == NULL) {
 				buffer->content[buffer->position] = '\0';
 				return NULL;
 			}
 
 			if (child->next != NULL) {
 				size_t length = format ? 2 : 1; /* place for one space needed if format */
-				if (printbuffer_allocate(length + 1, buffer) == NULL) {
+				if (printbuffer_allocate(length + 1, buffer, context) == NULL) {
 					return NULL;
 				}
 				buffer->content[buffer->position] = ',';
@@ -971,7 +2396,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 			}
 			child = child->next;
 		}
-		if (printbuffer_allocate(2, buffer) == NULL) {
+		if (printbuffer_allocate(2, buffer, context) == NULL) {
 			return NULL;
 		}
 		buffer->content[buffer->position] = ']';
@@ -985,7 +2410,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 
 	/* unbuffered */
 	/* Allocate an array to hold the values for each */
-	buffer_t **entries = (buffer_t**)allocate(item->length * sizeof(buffer_t*), NULL);
+	buffer_t **entries = (buffer_t**)context_malloc(context, item->length * sizeof(buffer_t*));
 	if (entries == NULL) {
 		return NULL;
 	}
@@ -996,7 +2421,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 	size_t length = 2; /* "[]" */
 	bool fail = false;
 	for (size_t i = 0; (i < item->length) && (child != NULL) && !fail; child = child->next, i++) {
-		entries[i] = print_value(child, depth + 1, format, NULL);
+		entries[i] = print_value(child, depth + 1, format, NULL, context);
 		if (entries[i] == NULL) {
 			fail = true;
 			break;
@@ -1007,7 +2432,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 
 	/* If we didn't fail, try to alloc the output string */
 	if (!fail) {
-		output = printbuffer_allocate(length, NULL);
+		output = printbuffer_allocate(length, NULL, context);
 	}
 	/* If that fails, we fail. */
 	if ((output == NULL) || (output->content == NULL)) {
@@ -1037,7 +2462,7 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 				}
 				output->content[output->position] = '\0';
 			}
-			buffer_destroy_with_custom_deallocator(entries[i], mcJSON_free);
+			context_buffer_destroy(entries[i], context);
 			entries[i] = NULL;
 		}
 	}
@@ -1046,17 +2471,17 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 	if (fail) {
 		for (size_t i = 0; i < item->length; i++) {
 			if (entries[i] != NULL) {
-				buffer_destroy_with_custom_deallocator(entries[i], mcJSON_free);
+				context_buffer_destroy(entries[i], context);
 			}
 		}
-		mcJSON_free(entries);
+		context_free(context, entries);
 		if (output != NULL) {
-			buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+			context_buffer_destroy(output, context);
 		}
 		return NULL;
 	}
 
-	mcJSON_free(entries);
+	context_free(context, entries);
 	output->content[output->position] = ']';
 	output->position++;
 	output->content[output->position] = '\0';
@@ -1066,78 +2491,8 @@ static buffer_t *print_array(mcJSON * const item, const size_t depth, const bool
 	return output;
 }
 
-/* Build an object from the text. */
-static buffer_t *parse_object(mcJSON * const item, buffer_t * const input, mempool_t * const pool) {
-	if ((input == NULL) || (input->content == NULL)) {
-		return NULL;
-	}
-	if (input->content[input->position] != '{') { /* not an object! */
-		return NULL;
-	}
-
-	item->type = mcJSON_Object;
-	input->position++;
-	skip(input);
-	if (input->content[input->position] == '}') { /* empty object. */
-		input->position++;
-		return input;
-	}
-
-	mcJSON *child = mcJSON_New_Item(pool);
-	item->length++;
-	item->child = child;
-	if (item->child == NULL) {
-		return NULL;
-	}
-
-	/* parse first key-value pair */
-	if (skip(parse_string(child, skip(input), pool)) == NULL) {
-		return NULL;
-	}
-	child->name = child->valuestring; /* string was parsed to ->valuestring, but it was actually a name */
-	child->valuestring = NULL;
-	if (input->content[input->position] != ':') { /* fail! */
-		return NULL;
-	}
-	input->position++;
-	if (skip(parse_value(child, skip(input), pool)) == NULL) {
-		return NULL;
-	}
-
-	while ((input->position < input->buffer_length) && (input->content[input->position] == ',')) {
-		mcJSON *new_item = mcJSON_New_Item(pool);
-		item->length++;
-		if (new_item == NULL) { /* memory fail */
-			return NULL;
-		}
-		child->next = new_item;
-		new_item->prev = child;
-		child = new_item;
-		input->position++;
-		if (skip(parse_string(child, skip(input), pool)) == NULL) {
-			return NULL;
-		}
-		child->name = child->valuestring;
-		child->valuestring = NULL;
-		if (input->content[input->position] != ':') { /* fail! */
-			return NULL;
-		}
-		input->position++;
-		if (skip(parse_value(child, skip(input), pool)) == NULL) {
-			return NULL;
-		}
-	}
-
-	if (input->content[input->position] == '}') { /* end of object */
-		input->position++;
-		return input;
-	}
-
-	return NULL; /* malformed. */
-}
-
 /* Render an object to text. */
-static buffer_t *print_object(mcJSON * const item, size_t depth, const bool format, buffer_t * const buffer) {
+static buffer_t *print_object(mcJSON * const item, size_t depth, const bool format, buffer_t * const buffer, const mcJSON_Context * const context) {
 	if (item == NULL) {
 		return NULL;
 	}
@@ -1149,12 +2504,12 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 	if (item->length == 0) {
 		/* '{' + '}' + '\0' + format: '\n' + depth */
 		size_t length = format ? depth + 4 : 3;
-		output = printbuffer_allocate(length, buffer);
+		output = printbuffer_allocate(length, buffer, context);
 		if (output == NULL) {
 			return NULL;
 		}
 		if (output->content == NULL) {
-			buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+			context_buffer_destroy(output, context);
 			return NULL;
 		}
 
@@ -1180,7 +2535,7 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 	/* buffered */
 	if (buffer != NULL) {
 		/* allocate memory */
-		if (printbuffer_allocate(format ? 3 : 2, buffer) == NULL) {
+		if (printbuffer_allocate(format ? 3 : 2, buffer, context) == NULL) {
 			return NULL;
 		}
 
@@ -1196,7 +2551,7 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 		depth++;
 		while (child != NULL) {
 			if (format) {
-				if (printbuffer_allocate(depth, buffer) == NULL) {
+				if (printbuffer_allocate(depth, buffer, context) == NULL) {
 					return NULL;
 				}
 				for (size_t i = 0; i < depth; i++) {
@@ -1205,14 +2560,14 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 				buffer->position += depth;
 			}
 
-			if(print_string_ptr(child->name, buffer) == NULL) {
+			if(print_string_ptr(child->name, buffer, context) == NULL) {
 				if (buffer->content != NULL) {
 					buffer->content[buffer->position] = '\0';
 				}
 				return NULL;
 			}
 
-			if (printbuffer_allocate(format ? 2 : 1, buffer) == NULL) {
+			if (printbuffer_allocate(format ? 2 : 1, buffer, context) == NULL) {
 				return NULL;
 			}
 			buffer->content[buffer->position] = ':';
@@ -1222,7 +2577,7 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 				buffer->position++;
 			}
 
-			if (print_value(child, depth, format, buffer) == NULL) {
+			if (print_value(child, depth, format, buffer, context) == NULL) {
 				if (buffer->content != NULL) {
 					buffer->content[buffer->position] = '\0';
 				}
@@ -1230,7 +2585,7 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 			}
 
 			size_t length = (format ? 1 : 0) + ((child->next != NULL) ? 1 : 0); /* '\t'? ','? */
-			if (printbuffer_allocate(length + 1, buffer) == NULL) {
+			if (printbuffer_allocate(length + 1, buffer, context) == NULL) {
 				return NULL;
 			}
 			if (child->next != NULL) {
@@ -1244,7 +2599,7 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 			buffer->content[buffer->position] = '\0';
 			child = child->next;
 		}
-		if (printbuffer_allocate(format ? (depth + 1) : 2, buffer) == NULL) { /* (depth - 1) * '\t' + '}' + '\0' */
+		if (printbuffer_allocate(format ? (depth + 1) : 2, buffer, context) == NULL) { /* (depth - 1) * '\t' + '}' + '\0' */
 			return NULL;
 		}
 		if (format) {
@@ -1265,14 +2620,14 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 	/* unbuffered */
 	/* Allocate space for the names and the objects */
 	buffer_t **entries = NULL;
-	entries = (buffer_t**)allocate(item->length * sizeof(buffer_t*), NULL);
+	entries = (buffer_t**)context_malloc(context, item->length * sizeof(buffer_t*));
 	if (entries == NULL) {
 		return NULL;
 	}
 	buffer_t **names = NULL;
-	names = (buffer_t**)allocate(item->length * sizeof(buffer_t*), NULL);
+	names = (buffer_t**)context_malloc(context, item->length * sizeof(buffer_t*));
 	if (names == NULL) {
-		mcJSON_free(entries);
+		context_free(context, entries);
 		return NULL;
 	}
 	memset(entries, 0, sizeof(buffer_t*) * item->length);
@@ -1288,121 +2643,2645 @@ static buffer_t *print_object(mcJSON * const item, size_t depth, const bool form
 		length += (depth - 1) + 1;
 	}
 	for (size_t i = 0; (i < item->length) && (child != NULL) && !fail; child = child->next, i++) {
-		names[i] = print_string_ptr(child->name, NULL);
+		names[i] = print_string_ptr(child->name, NULL, context);
 		if (names[i] == NULL) {
 			fail = true;
 			break;
 		}
-		entries[i] = print_value(child, depth, format, NULL);
+		entries[i] = print_value(child, depth, format, NULL, context);
 		if (entries[i] == NULL) {
 			fail = true;
 			break;
 		}
 
-		/* strlen(name) + ':' + strlen(entry) + ',' + (format ? '\t' + '\n' + depth) */
-		length += names[i]->content_length + entries[i]->content_length + (format ? 2 + depth : 0);
+		/* strlen(name) + ':' + strlen(entry) + ',' + (format ? '\t' + '\n' + depth) */
+		length += names[i]->content_length + entries[i]->content_length + (format ? 2 + depth : 0);
+	}
+	length--; /* last entry has no ',' */
+
+	/* Try to allocate the output string */
+	if (!fail) {
+		output = context_buffer_create(length, length, context);
+	}
+	if ((output == NULL) || (output->content == NULL)) {
+		fail = true;
+	}
+
+	/* Compose the output: */
+	if (!fail) {
+		output->content[output->position] = '{';
+		output->position++;
+		if (format) {
+			output->content[output->position] = '\n';
+			output->position++;
+		}
+		output->content[output->position] = '\0';
+		for (size_t i = 0; i < item->length; i++) {
+			if (format) { /* indentation */
+				for (size_t j = 0; j < depth; j++) {
+					output->content[output->position + j] = '\t';
+				}
+				output->position += depth;
+			}
+			if (buffer_copy(output, output->position, names[i], 0, names[i]->content_length - 1) != 0) {
+				if (output->content != NULL) {
+					output->content[output->position] = '\0';
+				}
+				fail = true;
+				break;
+			}
+			output->position += names[i]->content_length - 1;
+
+			output->content[output->position] = ':';
+			output->position++;
+			if (format) {
+				output->content[output->position] = '\t';
+				output->position++;
+			}
+			if (buffer_copy(output, output->position, entries[i], 0, entries[i]->content_length - 1) != 0) {
+				if (output->content != NULL) {
+					output->content[output->position] = '\0';
+				}
+				fail = true;
+				break;
+			}
+			output->position += entries[i]->content_length - 1;
+
+			if (i != (item->length - 1)) {
+				output->content[output->position] = ',';
+				output->position++;
+			}
+
+			if (format) {
+				output->content[output->position] = '\n';
+				output->position++;
+			}
+			output->content[output->position] = '\0';
+
+			context_buffer_destroy(names[i], context);
+			names[i] = NULL;
+			context_buffer_destroy(entries[i], context);
+			entries[i] = NULL;
+		}
+	}
+
+	/* Handle failure */
+	if (fail) {
+		for (size_t i = 0; i < item->length; i++) {
+			if (names[i] != NULL) {
+				context_buffer_destroy(names[i], context);
+			}
+			if (entries[i] != NULL) {
+				context_buffer_destroy(entries[i], context);
+			}
+		}
+		context_free(context, names);
+		context_free(context, entries);
+		if (output != NULL) {
+			context_buffer_destroy(output, context);
+		}
+		return NULL;
+	}
+
+	context_free(context, names);
+	context_free(context, entries);
+	if (format) {
+		for (size_t i = 0; i < (depth - 1); i++) {
+			output->content[output->position + i] = '\t';
+		}
+		output->position += depth - 1;
+	}
+	output->content[output->position] = '}';
+	output->position++;
+	output->content[output->position] = '\0';
+
+	output->content_length = output->position + 1;
+
+	return output;
+}
+
+/* Two stage parsing:
+ * Stage 1 classifies the input in blocks of 64 bytes and creates an index
+ * of every structural character ('{', '}', '[', ']', ':', ','), every
+ * opening '"' and the first character of every other scalar outside of strings.
+ * Stage 2 builds the tree by walking this index instead of the raw text. */
+#define STRUCTURAL_BLOCK_SIZE 64
+
+/* bitmasks of one block, bit n represents byte n of the block */
+typedef struct block_masks {
+	uint64_t quote;
+	uint64_t backslash;
+	uint64_t structural;
+	uint64_t whitespace; /* everything <= 32, same as in skip */
+} block_masks;
+
+typedef void (*block_classifier)(const unsigned char * const block, block_masks * const masks);
+
+static void classify_block_scalar(const unsigned char * const block, block_masks * const masks) {
+	memset(masks, 0, sizeof(block_masks));
+	for (size_t i = 0; i < STRUCTURAL_BLOCK_SIZE; i++) {
+		const uint64_t bit = ((uint64_t)1) << i;
+		switch (block[i]) {
+			case '\"':
+				masks->quote |= bit;
+				break;
+			case '\\':
+				masks->backslash |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				masks->structural |= bit;
+				break;
+			default:
+				if (block[i] <= 32) {
+					masks->whitespace |= bit;
+				}
+		}
+	}
+}
+
+#ifdef MCJSON_X86_DISPATCH
+__attribute__((target("sse2")))
+static void classify_block_sse2(const unsigned char * const block, block_masks * const masks) {
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i case_bit = _mm_set1_epi8(0x20); /* maps '[' to '{' and ']' to '}' */
+	const __m128i open_brace = _mm_set1_epi8('{');
+	const __m128i close_brace = _mm_set1_epi8('}');
+	const __m128i colon = _mm_set1_epi8(':');
+	const __m128i comma = _mm_set1_epi8(',');
+
+	memset(masks, 0, sizeof(block_masks));
+	for (size_t i = 0; i < (STRUCTURAL_BLOCK_SIZE / 16); i++) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+		const __m128i folded = _mm_or_si128(chunk, case_bit);
+		const __m128i structural = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+		const __m128i whitespace = _mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space);
+
+		masks->quote |= ((uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) << (16 * i);
+		masks->backslash |= ((uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) << (16 * i);
+		masks->structural |= ((uint64_t)(uint16_t)_mm_movemask_epi8(structural)) << (16 * i);
+		masks->whitespace |= ((uint64_t)(uint16_t)_mm_movemask_epi8(whitespace)) << (16 * i);
+	}
+}
+
+__attribute__((target("avx2")))
+static void classify_block_avx2(const unsigned char * const block, block_masks * const masks) {
+	const __m256i quote = _mm256_set1_epi8('\"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i case_bit = _mm256_set1_epi8(0x20); /* maps '[' to '{' and ']' to '}' */
+	const __m256i open_brace = _mm256_set1_epi8('{');
+	const __m256i close_brace = _mm256_set1_epi8('}');
+	const __m256i colon = _mm256_set1_epi8(':');
+	const __m256i comma = _mm256_set1_epi8(',');
+
+	memset(masks, 0, sizeof(block_masks));
+	for (size_t i = 0; i < (STRUCTURAL_BLOCK_SIZE / 32); i++) {
+		const __m256i chunk = _mm256_loadu_si256((const __m256i*)(block + 32 * i));
+		const __m256i folded = _mm256_or_si256(chunk, case_bit);
+		const __m256i structural = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+		const __m256i whitespace = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, space), space);
+
+		masks->quote |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))) << (32 * i);
+		masks->backslash |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash))) << (32 * i);
+		masks->structural |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(structural)) << (32 * i);
+		masks->whitespace |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace)) << (32 * i);
+	}
+}
+#endif
+
+/* pick the fastest block classifier the CPU supports */
+static block_classifier select_block_classifier(void) {
+#ifdef MCJSON_X86_DISPATCH
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return classify_block_avx2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return classify_block_sse2;
+	}
+#endif
+	return classify_block_scalar;
+}
+
+/* bit n of the result is the xor of bits 0 to n of the input */
+static uint64_t prefix_xor(uint64_t bits) {
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+/* Stage 1: write the positions of all structurals into indices,
+ * which needs to have space for length entries. Returns the number
+ * of indices that have been found. */
+static size_t find_structurals(const unsigned char * const json, const size_t length, uint32_t * const indices) {
+	/* selected per call instead of being cached in a static, so that threads don't race on it */
+	const block_classifier classify = select_block_classifier();
+
+	uint64_t next_is_escaped = 0; /* first byte of the next block is escaped */
+	uint64_t previous_in_string = 0; /* all ones if the previous block ended inside a string */
+	uint64_t previous_scalar = 0; /* the previous block ended with a scalar */
+	size_t count = 0;
+	unsigned char padded_block[STRUCTURAL_BLOCK_SIZE];
+	for (size_t offset = 0; offset < length; offset += STRUCTURAL_BLOCK_SIZE) {
+		const unsigned char *block = json + offset;
+		if ((length - offset) < STRUCTURAL_BLOCK_SIZE) { /* pad the last block with whitespace */
+			memset(padded_block, ' ', sizeof(padded_block));
+			memcpy(padded_block, block, length - offset);
+			block = padded_block;
+		}
+
+		block_masks masks;
+		classify(block, &masks);
+
+		/* every backslash that isn't escaped itself escapes the next character,
+		 * backslashes are rare, so walking them one by one is fine */
+		uint64_t escaped = next_is_escaped;
+		uint64_t backslashes = masks.backslash & ~next_is_escaped;
+		next_is_escaped = 0;
+		while (backslashes != 0) {
+			const unsigned int position = trailing_zeroes(backslashes);
+			if (position == (STRUCTURAL_BLOCK_SIZE - 1)) {
+				next_is_escaped = 1;
+				break;
+			}
+			escaped |= ((uint64_t)1) << (position + 1);
+			/* remove this backslash and the escaped character */
+			backslashes = (position >= (STRUCTURAL_BLOCK_SIZE - 2)) ? 0 : (backslashes & ~((((uint64_t)1) << (position + 2)) - 1));
+		}
+
+		/* the opening quote is part of the string mask, the closing one isn't */
+		const uint64_t quotes = masks.quote & ~escaped;
+		const uint64_t in_string = prefix_xor(quotes) ^ previous_in_string;
+		previous_in_string = ((uint64_t)0) - (in_string >> (STRUCTURAL_BLOCK_SIZE - 1));
+
+		const uint64_t structurals = masks.structural & ~in_string;
+		const uint64_t string_starts = quotes & in_string;
+		const uint64_t scalars = ~(masks.structural | masks.whitespace | quotes | in_string);
+		const uint64_t scalar_starts = scalars & ~((scalars << 1) | previous_scalar);
+		previous_scalar = scalars >> (STRUCTURAL_BLOCK_SIZE - 1);
+
+		uint64_t bits = structurals | string_starts | scalar_starts;
+		while (bits != 0) {
+			indices[count] = (uint32_t)(offset + trailing_zeroes(bits));
+			count++;
+			bits &= bits - 1;
+		}
+	}
+
+	return count;
+}
+
+typedef struct structural_index {
+	const uint32_t *indices;
+	size_t count;
+	size_t current;
+	const mcJSON_ParseOptions *options;
+	name_table *names; /* interned names, NULL if they aren't interned */
+	utf8_validator validate_utf8;
+} structural_index;
+
+/* Stage 2: parse the name of an object member from the structural index,
+ * the ':' after it has to be the next index. */
+static bool parse_indexed_name(mcJSON * const child, buffer_t * const input, structural_index * const index, const mcJSON_Context * const context) {
+	if (index->current >= index->count) {
+		return false;
+	}
+	input->position = index->indices[index->current];
+	index->current++;
+	if (parse_name(child, input, index->names, context, index->options, index->validate_utf8) == NULL) {
+		return false;
+	}
+
+	/* parse_name skipped the ':' and the whitespace around it */
+	if ((index->current >= index->count)
+			|| (index->indices[index->current] >= input->position)
+			|| (input->content[index->indices[index->current]] != ':')) {
+		return false;
+	}
+	index->current++;
+
+	return true;
+}
+
+/* Stage 2: build a value from the structural index. Like in parse_value,
+ * nested arrays and objects don't recurse, the open ones are kept on an
+ * explicit stack instead. */
+static buffer_t *parse_indexed_value(mcJSON * const item, buffer_t * const input, structural_index * const index, const mcJSON_Context * const context) {
+	parse_frame local_stack[PARSE_STACK_SIZE];
+	parse_frame *stack = local_stack;
+	size_t stack_size = PARSE_STACK_SIZE;
+	size_t depth = 0;
+	mcJSON *current = item; /* the next value is parsed into this */
+	buffer_t *result = NULL;
+	while (true) {
+		if (index->current >= index->count) {
+			goto cleanup;
+		}
+		input->position = index->indices[index->current];
+		index->current++;
+
+		const unsigned char start = input->content[input->position];
+		if ((start == '[') || (start == '{')) {
+			if ((index->options->max_depth != 0) && (depth >= index->options->max_depth)) { /* too deep */
+				goto cleanup;
+			}
+			const bool is_object = (start == '{');
+			current->type = is_object ? mcJSON_Object : mcJSON_Array;
+			if (index->current >= index->count) {
+				goto cleanup;
+			}
+			if (input->content[index->indices[index->current]] == (is_object ? '}' : ']')) { /* empty array or object */
+				input->position = index->indices[index->current] + 1;
+				index->current++;
+			} else {
+				if (!parse_stack_reserve(&stack, &stack_size, local_stack, depth, context)) {
+					goto cleanup;
+				}
+				stack[depth].container = current;
+				stack[depth].last_child = NULL;
+				depth++;
+
+				/* continue with the first element */
+				current = parse_append(&stack[depth - 1], context);
+				if ((current == NULL) || (is_object && !parse_indexed_name(current, input, index, context))) {
+					goto cleanup;
+				}
+				continue;
+			}
+		} else if (parse_value(current, input, context, index->options, index->validate_utf8) == NULL) { /* scalars are handled by the regular parser */
+			goto cleanup;
+		}
+
+		/* the value is complete, go on with the next element or close arrays and objects */
+		while (true) {
+			if (depth == 0) {
+				result = input;
+				goto cleanup;
+			}
+
+			parse_frame * const frame = &stack[depth - 1];
+			const bool is_object = (frame->container->type == mcJSON_Object);
+			/* there mustn't be anything except whitespace between a value and the next index */
+			skip(input);
+			if ((index->current >= index->count) || (input->position != index->indices[index->current])) {
+				goto cleanup;
+			}
+			const unsigned char separator = input->content[input->position];
+			index->current++;
+			if (separator == ',') {
+				current = parse_append(frame, context);
+				if ((current == NULL) || (is_object && !parse_indexed_name(current, input, index, context))) {
+					goto cleanup;
+				}
+				break;
+			}
+			if (separator != (is_object ? '}' : ']')) { /* malformed */
+				goto cleanup;
+			}
+			input->position++;
+			depth--;
+		}
+	}
+
+cleanup:
+	if (stack != local_stack) {
+		context_free(context, stack);
+	}
+	return result;
+}
+
+mcJSON *mcJSON_ParseIndexedWithContext(buffer_t * const json, const mcJSON_Context * context) {
+	if ((json == NULL) || (json->content == NULL)) {
+		return NULL;
+	}
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	json->position = 0;
+
+	/* like the regular parser, stop at the first '\0' */
+	size_t length = json->content_length;
+	const unsigned char *terminator = memchr(json->content, '\0', json->content_length);
+	if (terminator != NULL) {
+		length = (size_t)(terminator - json->content);
+	}
+
+	if ((length == 0) || (length > UINT32_MAX)) { /* the index can only address 4GiB */
+		return mcJSON_ParseWithContext(json, context);
+	}
+	if ((context->max_length != 0) && (json->content_length > context->max_length)) {
+		return NULL;
+	}
+	const mcJSON_ParseOptions * const options = (context->options == NULL) ? &default_parse_options : context->options;
+
+	uint32_t *indices = (uint32_t*)context_malloc(context, length * sizeof(uint32_t));
+	if (indices == NULL) {
+		return NULL;
+	}
+	/* interning only works in a pool, because interned names can't be freed */
+	name_table interned = {NULL, 0, 0};
+	structural_index index = {
+		indices,
+		find_structurals(json->content, length, indices),
+		0,
+		options,
+		(options->intern_names && (context->pool != NULL)) ? &interned : NULL,
+		parse_utf8_validator(options)
+	};
+
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(context->pool);
+	mcJSON *root = mcJSON_New_Item(context);
+	if ((root != NULL) && (parse_indexed_value(root, json, &index, context) == NULL)) {
+		if (context->pool == NULL) {
+			delete_item(root, context);
+		}
+		root = NULL;
+	}
+	if (root == NULL) {
+		mcJSON_PoolRollback(context->pool, marker, true);
+	}
+
+	context_free(context, interned.entries);
+	context_free(context, indices);
+	return root;
+}
+
+mcJSON *mcJSON_ParseIndexed(buffer_t * const json, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_ParseIndexedWithContext(json, &context);
+}
+
+/* Validation:
+ * Checks the strict grammar of RFC 8259 without building a tree and without
+ * allocating anything. The open arrays and objects are kept in a bit stack
+ * on the C stack, a set bit is an object. */
+#define VALIDATE_STACK_WORDS (mcJSON_VALIDATE_MAX_DEPTH / 64)
+
+typedef struct validator {
+	const unsigned char *content;
+	size_t length;
+	size_t position;
+} validator;
+
+/* current character, '\0' at the end of the input */
+static unsigned char validator_peek(const validator * const state) {
+	return (state->position < state->length) ? state->content[state->position] : '\0';
+}
+
+static void validate_whitespace(validator * const state) {
+	while (state->position < state->length) {
+		const unsigned char character = state->content[state->position];
+		if ((character != ' ') && (character != '\t') && (character != '\n') && (character != '\r')) {
+			return;
+		}
+		state->position++;
+	}
+}
+
+static bool validate_literal(validator * const state, const char * const literal, const size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		if (validator_peek(state) != (unsigned char)literal[i]) {
+			return false;
+		}
+		state->position++;
+	}
+
+	return true;
+}
+
+/* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static bool validate_number(validator * const state) {
+	if (validator_peek(state) == '-') {
+		state->position++;
+	}
+
+	if (validator_peek(state) == '0') {
+		state->position++;
+	} else if (is_digit(validator_peek(state))) {
+		while (is_digit(validator_peek(state))) {
+			state->position++;
+		}
+	} else {
+		return false;
+	}
+
+	if (validator_peek(state) == '.') {
+		state->position++;
+		if (!is_digit(validator_peek(state))) {
+			return false;
+		}
+		while (is_digit(validator_peek(state))) {
+			state->position++;
+		}
+	}
+
+	if ((validator_peek(state) == 'e') || (validator_peek(state) == 'E')) {
+		state->position++;
+		if ((validator_peek(state) == '+') || (validator_peek(state) == '-')) {
+			state->position++;
+		}
+		if (!is_digit(validator_peek(state))) {
+			return false;
+		}
+		while (is_digit(validator_peek(state))) {
+			state->position++;
+		}
+	}
+
+	return true;
+}
+
+/* Check 4 hex digits after "\u" and return their value, UINT32_MAX if they are invalid. */
+static uint32_t validate_hex4(validator * const state) {
+	uint32_t value = 0;
+	for (size_t i = 0; i < 4; i++) {
+		const unsigned char character = validator_peek(state);
+		if (is_digit(character)) {
+			value = (value << 4) | (uint32_t)(character - '0');
+		} else if ((character >= 'a') && (character <= 'f')) {
+			value = (value << 4) | (uint32_t)(character - 'a' + 10);
+		} else if ((character >= 'A') && (character <= 'F')) {
+			value = (value << 4) | (uint32_t)(character - 'A' + 10);
+		} else {
+			return UINT32_MAX;
+		}
+		state->position++;
+	}
+
+	return value;
+}
+
+static bool validate_escape_sequence(validator * const state) {
+	state->position++; /* '\\' */
+	switch (validator_peek(state)) {
+		case '\"':
+		case '\\':
+		case '/':
+		case 'b':
+		case 'f':
+		case 'n':
+		case 'r':
+		case 't':
+			state->position++;
+			return true;
+		case 'u':
+			state->position++;
+			break;
+		default:
+			return false;
+	}
+
+	const size_t start = state->position;
+	const uint32_t unicode = validate_hex4(state);
+	if (unicode == UINT32_MAX) {
+		return false;
+	}
+	if ((unicode >= 0xDC00) && (unicode <= 0xDFFF)) { /* low surrogate without a high one */
+		state->position = start;
+		return false;
+	}
+	if ((unicode < 0xD800) || (unicode > 0xDBFF)) {
+		return true;
+	}
+
+	/* a high surrogate has to be followed by a low surrogate */
+	if (!validate_literal(state, "\\u", 2)) {
+		return false;
+	}
+	const size_t low_start = state->position;
+	const uint32_t low_surrogate = validate_hex4(state);
+	if ((low_surrogate < 0xDC00) || (low_surrogate > 0xDFFF)) {
+		state->position = low_start;
+		return false;
+	}
+
+	return true;
+}
+
+static bool validate_string(validator * const state) {
+	state->position++; /* opening '"' */
+	while (true) {
+		const unsigned char character = validator_peek(state);
+		if (character == '\"') {
+			state->position++;
+			return true;
+		}
+		if (character == '\\') {
+			if (!validate_escape_sequence(state)) {
+				return false;
+			}
+		} else if (character < 0x20) { /* control characters and the end of the input */
+			return false;
+		} else if (character < 0x80) {
+			state->position++;
+		} else if (!utf8_check_sequence(state->content, state->length, &state->position)) {
+			return false;
+		}
+	}
+}
+
+/* Check the key of an object member and the ':' after it. */
+static bool validate_key(validator * const state) {
+	validate_whitespace(state);
+	if ((validator_peek(state) != '\"') || !validate_string(state)) {
+		return false;
+	}
+	validate_whitespace(state);
+	if (validator_peek(state) != ':') {
+		return false;
+	}
+	state->position++;
+
+	return true;
+}
+
+bool mcJSON_Validate(const buffer_t * const json, size_t max_depth, size_t * const error_offset) {
+	if ((json == NULL) || (json->content == NULL)) {
+		if (error_offset != NULL) {
+			*error_offset = 0;
+		}
+		return false;
+	}
+	if ((max_depth == 0) || (max_depth > mcJSON_VALIDATE_MAX_DEPTH)) {
+		max_depth = mcJSON_VALIDATE_MAX_DEPTH;
+	}
+
+	validator state = {json->content, json->content_length, 0};
+	uint64_t objects[VALIDATE_STACK_WORDS] = {0};
+	size_t depth = 0;
+	bool valid = true;
+	bool expect_value = true;
+	while (valid) {
+		validate_whitespace(&state);
+		const unsigned char character = validator_peek(&state);
+
+		if (!expect_value) {
+			/* after a value: ',' or the end of the innermost array or object */
+			if (depth == 0) {
+				break;
+			}
+			const bool in_object = (objects[(depth - 1) / 64] >> ((depth - 1) % 64)) & 1;
+			if (character == ',') {
+				state.position++;
+				valid = !in_object || validate_key(&state);
+				expect_value = true;
+			} else if (character == (in_object ? '}' : ']')) {
+				state.position++;
+				depth--;
+			} else {
+				valid = false;
+			}
+			continue;
+		}
+
+		switch (character) {
+			case '{':
+			case '[':
+				if (depth == max_depth) {
+					valid = false;
+					break;
+				}
+				if (character == '{') {
+					objects[depth / 64] |= UINT64_C(1) << (depth % 64);
+				} else {
+					objects[depth / 64] &= ~(UINT64_C(1) << (depth % 64));
+				}
+				depth++;
+				state.position++;
+
+				/* empty array or object */
+				validate_whitespace(&state);
+				if (validator_peek(&state) == ((character == '{') ? '}' : ']')) {
+					state.position++;
+					depth--;
+					expect_value = false;
+				} else if (character == '{') {
+					valid = validate_key(&state);
+				}
+				break;
+			case '\"':
+				valid = validate_string(&state);
+				expect_value = false;
+				break;
+			case 't':
+				valid = validate_literal(&state, "true", sizeof("true") - 1);
+				expect_value = false;
+				break;
+			case 'f':
+				valid = validate_literal(&state, "false", sizeof("false") - 1);
+				expect_value = false;
+				break;
+			case 'n':
+				valid = validate_literal(&state, "null", sizeof("null") - 1);
+				expect_value = false;
+				break;
+			default:
+				valid = validate_number(&state);
+				expect_value = false;
+				break;
+		}
+	}
+
+	/* only whitespace may follow the root value, the input can be terminated by '\0' */
+	if (valid && (validator_peek(&state) != '\0')) {
+		valid = false;
+	}
+
+	if (!valid && (error_offset != NULL)) {
+		*error_offset = state.position;
+	}
+	return valid;
+}
+
+/* Incremental parsing:
+ * The input arrives in chunks, so the parser can't recurse. Instead it is
+ * a state machine with an explicit stack of the open arrays and objects
+ * that reports what it finds as events (SAX). mcJSON_Parser is such a
+ * parser with an event handler that builds the tree.
+ * Strings and numbers that are completely inside of a chunk are handled
+ * directly, only tokens that span several chunks are collected in a
+ * scratch buffer first. */
+typedef enum parser_state {
+	PARSER_VALUE, /* after ':' or ',' in an array, or at the beginning */
+	PARSER_VALUE_OR_END, /* after '[' */
+	PARSER_KEY, /* after ',' in an object */
+	PARSER_KEY_OR_END, /* after '{' */
+	PARSER_COLON, /* after a key */
+	PARSER_COMMA_OR_END, /* after a value inside an array or object */
+	PARSER_STRING, /* inside a string that started in an earlier chunk */
+	PARSER_NUMBER, /* inside a number that started in an earlier chunk */
+	PARSER_LITERAL, /* inside true, false or null */
+	PARSER_DONE, /* the root value is complete, only whitespace or '\0' may follow */
+	PARSER_ERROR
+} parser_state;
+
+struct mcJSON_SAXParser {
+	const mcJSON_SAXCallbacks *callbacks;
+	void *userdata;
+	mcJSON_Context context; /* allocates the parser and its buffers */
+	parser_state state;
+	bool string_is_key;
+	bool escaped; /* the current string ended with an unfinished escape sequence */
+	const char *literal;
+	size_t literal_position;
+	/* tokens that span several chunks, also used for unescaping */
+	unsigned char *scratch;
+	size_t scratch_length;
+	size_t scratch_size;
+	/* '[' or '{' for every open array or object */
+	unsigned char *containers;
+	size_t depth;
+	size_t containers_size;
+};
+
+/* Make room for at least one more element in a growing array from the allocator of context. */
+static bool array_reserve(void ** const array, size_t * const size, const size_t used, const size_t element_size, const mcJSON_Context * const context) {
+	if (used < *size) {
+		return true;
+	}
+
+	const size_t new_size = (*size == 0) ? 16 : (2 * *size);
+	void *new_array = context_malloc(context, new_size * element_size);
+	if (new_array == NULL) {
+		return false;
+	}
+	if (*array != NULL) {
+		memcpy(new_array, *array, used * element_size);
+		context_free(context, *array);
+	}
+	*array = new_array;
+	*size = new_size;
+
+	return true;
+}
+
+static bool parser_is_whitespace(const unsigned char character) {
+	return (character <= 32) && (character != '\0'); /* same as in skip */
+}
+
+static bool parser_is_number_character(const unsigned char character) {
+	return is_digit(character) || (character == '-') || (character == '+') || (character == '.') || (character == 'e') || (character == 'E');
+}
+
+static bool parser_scratch_reserve(mcJSON_SAXParser * const parser, const size_t size) {
+	if (size <= parser->scratch_size) {
+		return true;
+	}
+
+	const size_t new_size = pow2gt(size);
+	unsigned char *scratch = (unsigned char*)context_malloc(&parser->context, new_size);
+	if (scratch == NULL) {
+		return false;
+	}
+	if (parser->scratch != NULL) {
+		memcpy(scratch, parser->scratch, parser->scratch_length);
+		context_free(&parser->context, parser->scratch);
+	}
+	parser->scratch = scratch;
+	parser->scratch_size = new_size;
+
+	return true;
+}
+
+static bool parser_scratch_append(mcJSON_SAXParser * const parser, const unsigned char * const bytes, const size_t length) {
+	if (!parser_scratch_reserve(parser, parser->scratch_length + length)) {
+		return false;
+	}
+
+	memcpy(parser->scratch + parser->scratch_length, bytes, length);
+	parser->scratch_length += length;
+
+	return true;
+}
+
+static bool parser_value_complete(mcJSON_SAXParser * const parser) {
+	parser->state = (parser->depth == 0) ? PARSER_DONE : PARSER_COMMA_OR_END;
+	return true;
+}
+
+/* Finds the closing '"' of a string between position and end. Returns end
+ * if the string continues in the next chunk, escaped tells if the chunk
+ * ended in the middle of an escape sequence. first_delimiter is the position
+ * of the first '\\' or the return value if there is none. */
+static size_t parser_find_string_end(const unsigned char * const content, size_t position, const size_t end, bool * const escaped, size_t * const first_delimiter) {
+	*escaped = false;
+	position = find_string_delimiter(content, position, end);
+	*first_delimiter = position;
+	while (true) {
+		if ((position >= end) || (content[position] != '\\')) {
+			return position;
+		}
+		if ((position + 1) >= end) {
+			*escaped = true;
+			return end;
+		}
+		position = find_string_delimiter(content, position + 2, end);
+	}
+}
+
+/* Report the string between input->position and end_position (the closing '"'). */
+static bool parser_string_complete(mcJSON_SAXParser * const parser, buffer_t * const input, const size_t first_delimiter, const size_t end_position) {
+	if (first_delimiter == end_position) { /* no escape sequences, the string can be used as is */
+		buffer_create_with_existing_array(string, input->content + input->position, end_position - input->position + 1);
+		input->position = end_position + 1;
+		if (parser->string_is_key) {
+			parser->state = PARSER_COLON;
+			return (parser->callbacks->key == NULL) || parser->callbacks->key(parser->userdata, string);
+		}
+		return parser_value_complete(parser) && ((parser->callbacks->string == NULL) || parser->callbacks->string(parser->userdata, string));
+	}
+
+	/* unescape into the scratch buffer, this works in place if the input already is the scratch buffer */
+	if ((input->content != parser->scratch) && !parser_scratch_reserve(parser, end_position - input->position + 1)) {
+		return false;
+	}
+	buffer_create_with_existing_array(string, parser->scratch, parser->scratch_size);
+	string->position = 0;
+	if (!unescape_string(input, first_delimiter, end_position, string)) {
+		return false;
+	}
+	string->content[string->position] = '\0';
+	string->content_length = string->position + 1;
+	string->position = 0;
+	input->position = end_position + 1;
+
+	if (parser->string_is_key) {
+		parser->state = PARSER_COLON;
+		return (parser->callbacks->key == NULL) || parser->callbacks->key(parser->userdata, string);
+	}
+	return parser_value_complete(parser) && ((parser->callbacks->string == NULL) || parser->callbacks->string(parser->userdata, string));
+}
+
+/* Parse a string that starts at the current position. */
+static bool parser_begin_string(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	bool escaped;
+	size_t first_delimiter;
+	const size_t end_position = parser_find_string_end(input->content, input->position + 1, input->content_length, &escaped, &first_delimiter);
+	if (end_position < input->content_length) {
+		if (input->content[end_position] != '\"') { /* '\0' */
+			return false;
+		}
+
+		/* the whole string is in this chunk */
+		input->position++;
+		return parser_string_complete(parser, input, first_delimiter, end_position);
+	}
+
+	parser->scratch_length = 0;
+	if (!parser_scratch_append(parser, input->content + input->position, input->content_length - input->position)) {
+		return false;
+	}
+	parser->escaped = escaped;
+	parser->state = PARSER_STRING;
+	input->position = input->content_length;
+
+	return true;
+}
+
+/* Continue a string that started in an earlier chunk. */
+static bool parser_continue_string(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	size_t position = input->position;
+	if (parser->escaped) { /* the escaped character is the first one in this chunk */
+		position++;
+	}
+
+	bool escaped;
+	size_t first_delimiter;
+	size_t end_position = parser_find_string_end(input->content, position, input->content_length, &escaped, &first_delimiter);
+	if ((end_position < input->content_length) && (input->content[end_position] != '\"')) { /* '\0' */
+		return false;
+	}
+	const bool complete = (end_position < input->content_length);
+	if (complete) {
+		end_position++; /* including the closing '"' */
+	}
+	if (!parser_scratch_append(parser, input->content + input->position, end_position - input->position)) {
+		return false;
+	}
+	input->position = end_position;
+	parser->escaped = escaped;
+	if (!complete) {
+		return true;
+	}
+
+	/* the scratch buffer contains the whole string, including both '"' */
+	buffer_create_with_existing_array(string, parser->scratch, parser->scratch_length);
+	string->position = 1;
+	const size_t string_end = parser->scratch_length - 1;
+	return parser_string_complete(parser, string, find_string_delimiter(parser->scratch, 1, string_end), string_end);
+}
+
+static bool parser_number_complete(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	double number;
+	int64_t integer;
+	bool is_int64;
+	if (!scan_number(input, &number, &integer, &is_int64, &parser->context) || (input->position != input->content_length)) {
+		return false;
+	}
+
+	return parser_value_complete(parser) && ((parser->callbacks->number == NULL) || parser->callbacks->number(parser->userdata, number, is_int64 ? &integer : NULL));
+}
+
+/* Parse a number that starts at the current position. */
+static bool parser_begin_number(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	size_t end_position = input->position;
+	while ((end_position < input->content_length) && parser_is_number_character(input->content[end_position])) {
+		end_position++;
+	}
+
+	if (end_position < input->content_length) { /* the whole number is in this chunk */
+		buffer_create_with_existing_array(number, input->content + input->position, end_position - input->position);
+		input->position = end_position;
+		return parser_number_complete(parser, number);
+	}
+
+	parser->scratch_length = 0;
+	if (!parser_scratch_append(parser, input->content + input->position, end_position - input->position)) {
+		return false;
+	}
+	input->position = end_position;
+	parser->state = PARSER_NUMBER;
+
+	return true;
+}
+
+/* Continue a number that started in an earlier chunk. */
+static bool parser_continue_number(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	size_t end_position = input->position;
+	while ((end_position < input->content_length) && parser_is_number_character(input->content[end_position])) {
+		end_position++;
+	}
+
+	if (!parser_scratch_append(parser, input->content + input->position, end_position - input->position)) {
+		return false;
+	}
+	input->position = end_position;
+	if (end_position == input->content_length) { /* the number continues in the next chunk */
+		return true;
+	}
+
+	buffer_create_with_existing_array(number, parser->scratch, parser->scratch_length);
+	return parser_number_complete(parser, number);
+}
+
+static bool parser_continue_literal(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	while ((input->position < input->content_length) && (parser->literal[parser->literal_position] != '\0')) {
+		if (input->content[input->position] != (unsigned char)parser->literal[parser->literal_position]) {
+			return false;
+		}
+		input->position++;
+		parser->literal_position++;
+	}
+	if (parser->literal[parser->literal_position] != '\0') { /* continues in the next chunk */
+		return true;
+	}
+
+	parser_value_complete(parser);
+	const mcJSON_SAXCallbacks * const callbacks = parser->callbacks;
+	switch (parser->literal[0]) {
+		case 't':
+			return (callbacks->boolean == NULL) || callbacks->boolean(parser->userdata, true);
+		case 'f':
+			return (callbacks->boolean == NULL) || callbacks->boolean(parser->userdata, false);
+		default:
+			return (callbacks->null == NULL) || callbacks->null(parser->userdata);
+	}
+}
+
+static bool parser_begin_container(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	if (!array_reserve((void**)&parser->containers, &parser->containers_size, parser->depth, sizeof(unsigned char), &parser->context)) {
+		return false;
+	}
+	const unsigned char character = input->content[input->position];
+	parser->containers[parser->depth] = character;
+	parser->depth++;
+	input->position++;
+
+	if (character == '{') {
+		parser->state = PARSER_KEY_OR_END;
+		return (parser->callbacks->start_object == NULL) || parser->callbacks->start_object(parser->userdata);
+	}
+	parser->state = PARSER_VALUE_OR_END;
+	return (parser->callbacks->start_array == NULL) || parser->callbacks->start_array(parser->userdata);
+}
+
+static bool parser_end_container(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	input->position++;
+	parser->depth--;
+	parser_value_complete(parser);
+
+	if (parser->containers[parser->depth] == '{') {
+		return (parser->callbacks->end_object == NULL) || parser->callbacks->end_object(parser->userdata);
+	}
+	return (parser->callbacks->end_array == NULL) || parser->callbacks->end_array(parser->userdata);
+}
+
+/* Start parsing a value at the current position. */
+static bool parser_begin_value(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	const unsigned char character = input->content[input->position];
+	switch (character) {
+		case '{':
+		case '[':
+			return parser_begin_container(parser, input);
+
+		case '\"':
+			parser->string_is_key = false;
+			return parser_begin_string(parser, input);
+
+		case 't':
+			parser->literal = "true";
+			break;
+
+		case 'f':
+			parser->literal = "false";
+			break;
+
+		case 'n':
+			parser->literal = "null";
+			break;
+
+		default:
+			if ((character == '-') || is_digit(character)) {
+				return parser_begin_number(parser, input);
+			}
+			return false;
+	}
+
+	parser->literal_position = 0;
+	parser->state = PARSER_LITERAL;
+	return parser_continue_literal(parser, input);
+}
+
+/* Start parsing the key of an object member at the current position. */
+static bool parser_begin_key(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	if (input->content[input->position] != '\"') {
+		return false;
+	}
+	parser->string_is_key = true;
+
+	return parser_begin_string(parser, input);
+}
+
+/* Consume at least one byte of input. */
+static bool parser_step(mcJSON_SAXParser * const parser, buffer_t * const input) {
+	switch (parser->state) {
+		case PARSER_STRING:
+			return parser_continue_string(parser, input);
+		case PARSER_NUMBER:
+			return parser_continue_number(parser, input);
+		case PARSER_LITERAL:
+			return parser_continue_literal(parser, input);
+		default:
+			break;
+	}
+
+	const unsigned char character = input->content[input->position];
+	if (parser_is_whitespace(character)) {
+		input->position++;
+		return true;
+	}
+
+	switch (parser->state) {
+		case PARSER_VALUE_OR_END:
+			if (character == ']') {
+				return parser_end_container(parser, input);
+			}
+			return parser_begin_value(parser, input);
+
+		case PARSER_VALUE:
+			return parser_begin_value(parser, input);
+
+		case PARSER_KEY_OR_END:
+			if (character == '}') {
+				return parser_end_container(parser, input);
+			}
+			return parser_begin_key(parser, input);
+
+		case PARSER_KEY:
+			return parser_begin_key(parser, input);
+
+		case PARSER_COLON:
+			if (character != ':') {
+				return false;
+			}
+			input->position++;
+			parser->state = PARSER_VALUE;
+			return true;
+
+		case PARSER_COMMA_OR_END: {
+				const unsigned char container = parser->containers[parser->depth - 1];
+				if (character == ',') {
+					input->position++;
+					parser->state = (container == '{') ? PARSER_KEY : PARSER_VALUE;
+					return true;
+				}
+				if (((container == '[') && (character == ']')) || ((container == '{') && (character == '}'))) {
+					return parser_end_container(parser, input);
+				}
+			}
+			return false;
+
+		case PARSER_DONE: /* a terminating '\0' may follow the root value */
+			if (character != '\0') {
+				return false;
+			}
+			input->position++;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/* Create a SAX parser that allocates everything with the allocator of context. */
+static mcJSON_SAXParser *sax_parser_create(const mcJSON_SAXCallbacks * const callbacks, void * const userdata, const mcJSON_Context * const context) {
+	if (callbacks == NULL) {
+		return NULL;
+	}
+
+	mcJSON_SAXParser *parser = (mcJSON_SAXParser*)context_malloc(context, sizeof(mcJSON_SAXParser));
+	if (parser == NULL) {
+		return NULL;
+	}
+	memset(parser, 0, sizeof(mcJSON_SAXParser));
+	parser->callbacks = callbacks;
+	parser->userdata = userdata;
+	parser->context = *context;
+	parser->state = PARSER_VALUE;
+
+	return parser;
+}
+
+mcJSON_SAXParser *mcJSON_SAXParserCreate(const mcJSON_SAXCallbacks * const callbacks, void * const userdata) {
+	const mcJSON_Context context = pool_context(NULL);
+	return sax_parser_create(callbacks, userdata, &context);
+}
+
+bool mcJSON_SAXParserFeed(mcJSON_SAXParser * const parser, const buffer_t * const chunk) {
+	if ((parser == NULL) || (chunk == NULL) || (parser->state == PARSER_ERROR)) {
+		return false;
+	}
+	if (chunk->content_length == 0) {
+		return true;
+	}
+	if (chunk->content == NULL) {
+		parser->state = PARSER_ERROR;
+		return false;
+	}
+
+	buffer_create_with_existing_array(input, chunk->content, chunk->content_length);
+	while (input->position < input->content_length) {
+		if (!parser_step(parser, input)) {
+			parser->state = PARSER_ERROR;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool mcJSON_SAXParserFinish(mcJSON_SAXParser * const parser) {
+	if (parser == NULL) {
+		return false;
+	}
+
+	/* the end of the input also ends a number */
+	if (parser->state == PARSER_NUMBER) {
+		buffer_create_with_existing_array(number, parser->scratch, parser->scratch_length);
+		if (!parser_number_complete(parser, number)) {
+			parser->state = PARSER_ERROR;
+		}
+	}
+	const bool success = (parser->state == PARSER_DONE);
+
+	const mcJSON_Context context = parser->context;
+	context_free(&context, parser->scratch);
+	context_free(&context, parser->containers);
+	context_free(&context, parser);
+
+	return success;
+}
+
+/* mcJSON_ParseSAX with the allocator of context. */
+static bool parse_sax(const buffer_t * const json, const mcJSON_SAXCallbacks * const callbacks, void * const userdata, const mcJSON_Context * const context) {
+	mcJSON_SAXParser *parser = sax_parser_create(callbacks, userdata, context);
+	if (parser == NULL) {
+		return false;
+	}
+
+	mcJSON_SAXParserFeed(parser, json);
+	return mcJSON_SAXParserFinish(parser);
+}
+
+bool mcJSON_ParseSAX(const buffer_t * const json, const mcJSON_SAXCallbacks * const callbacks, void * const userdata) {
+	const mcJSON_Context context = pool_context(NULL);
+	return parse_sax(json, callbacks, userdata, &context);
+}
+
+/* Building a tree from the events of a mcJSON_SAXParser */
+typedef struct tree_frame {
+	mcJSON *container;
+	mcJSON *last_child;
+} tree_frame;
+
+struct mcJSON_Parser {
+	mcJSON_SAXParser *sax;
+	mcJSON_Context context; /* allocates everything, the tree in its pool if it has one */
+	mcJSON_PoolMarker start; /* the pool is rolled back to this if parsing fails */
+	mcJSON *root;
+	/* open arrays and objects */
+	tree_frame *stack;
+	size_t depth;
+	size_t stack_size;
+};
+
+/* Append a new item to the innermost array or object. */
+static mcJSON *tree_append(mcJSON_Parser * const parser) {
+	tree_frame * const frame = &parser->stack[parser->depth - 1];
+	mcJSON *child = mcJSON_New_Item(&parser->context);
+	if (child == NULL) {
+		return NULL;
+	}
+
+	if (frame->last_child == NULL) {
+		frame->container->child = child;
+	} else {
+		frame->last_child->next = child;
+		child->prev = frame->last_child;
+	}
+	frame->last_child = child;
+	frame->container->length++;
+
+	return child;
+}
+
+/* Get the item that the next value is parsed into. */
+static mcJSON *tree_value_item(mcJSON_Parser * const parser) {
+	if (parser->depth == 0) {
+		return parser->root;
+	}
+	if (parser->stack[parser->depth - 1].container->type == mcJSON_Object) {
+		return parser->stack[parser->depth - 1].last_child; /* was created together with its key */
+	}
+
+	return tree_append(parser);
+}
+
+/* Copy a string from the parser, it has a terminating '\0' or something else in its place. */
+static buffer_t *tree_copy_string(const buffer_t * const string, const mcJSON_Context * const context) {
+	buffer_t *copy = parsebuffer_allocate(string->content_length, string->content_length, context);
+	if (copy == NULL) {
+		return NULL;
+	}
+	memcpy(copy->content, string->content, string->content_length - 1);
+	copy->content[string->content_length - 1] = '\0';
+
+	return copy;
+}
+
+static bool tree_start_container(mcJSON_Parser * const parser, const mcJSON_Type type) {
+	mcJSON *container = tree_value_item(parser);
+	if ((container == NULL) || !array_reserve((void**)&parser->stack, &parser->stack_size, parser->depth, sizeof(tree_frame), &parser->context)) {
+		return false;
+	}
+	container->type = type;
+	parser->stack[parser->depth].container = container;
+	parser->stack[parser->depth].last_child = NULL;
+	parser->depth++;
+
+	return true;
+}
+
+static bool tree_start_object(void * const userdata) {
+	return tree_start_container((mcJSON_Parser*)userdata, mcJSON_Object);
+}
+
+static bool tree_start_array(void * const userdata) {
+	return tree_start_container((mcJSON_Parser*)userdata, mcJSON_Array);
+}
+
+static bool tree_end_container(void * const userdata) {
+	((mcJSON_Parser*)userdata)->depth--;
+	return true;
+}
+
+static bool tree_key(void * const userdata, const buffer_t * const key) {
+	mcJSON_Parser * const parser = (mcJSON_Parser*)userdata;
+	mcJSON *child = tree_append(parser);
+	if (child == NULL) {
+		return false;
+	}
+	child->name = tree_copy_string(key, &parser->context);
+
+	return child->name != NULL;
+}
+
+static bool tree_string(void * const userdata, const buffer_t * const string) {
+	mcJSON_Parser * const parser = (mcJSON_Parser*)userdata;
+	mcJSON *item = tree_value_item(parser);
+	if (item == NULL) {
+		return false;
+	}
+	item->type = mcJSON_String;
+	item->valuestring = tree_copy_string(string, &parser->context);
+
+	return item->valuestring != NULL;
+}
+
+static bool tree_number(void * const userdata, const double number, const int64_t * const integer) {
+	mcJSON *item = tree_value_item((mcJSON_Parser*)userdata);
+	if (item == NULL) {
+		return false;
+	}
+	number_set(item, number, integer);
+
+	return true;
+}
+
+static bool tree_boolean(void * const userdata, const bool value) {
+	mcJSON *item = tree_value_item((mcJSON_Parser*)userdata);
+	if (item == NULL) {
+		return false;
+	}
+	item->type = value ? mcJSON_True : mcJSON_False;
+
+	return true;
+}
+
+static bool tree_null(void * const userdata) {
+	mcJSON *item = tree_value_item((mcJSON_Parser*)userdata);
+	if (item == NULL) {
+		return false;
+	}
+	item->type = mcJSON_NULL;
+
+	return true;
+}
+
+static const mcJSON_SAXCallbacks tree_callbacks = {
+	tree_start_object,
+	tree_end_container, /* end_object */
+	tree_start_array,
+	tree_end_container, /* end_array */
+	tree_key,
+	tree_string,
+	tree_number,
+	tree_boolean,
+	tree_null
+};
+
+mcJSON_Parser *mcJSON_ParserCreateWithContext(const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+
+	mcJSON_Parser *parser = (mcJSON_Parser*)context_malloc(context, sizeof(mcJSON_Parser));
+	if (parser == NULL) {
+		return NULL;
+	}
+	memset(parser, 0, sizeof(mcJSON_Parser));
+	parser->context = *context;
+	parser->start = mcJSON_PoolMark(context->pool);
+
+	parser->sax = sax_parser_create(&tree_callbacks, parser, context);
+	if (parser->sax == NULL) {
+		context_free(context, parser);
+		return NULL;
+	}
+
+	parser->root = mcJSON_New_Item(&parser->context);
+	if (parser->root == NULL) {
+		mcJSON_SAXParserFinish(parser->sax);
+		context_free(context, parser);
+		return NULL;
+	}
+
+	return parser;
+}
+
+mcJSON_Parser *mcJSON_ParserCreate(mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_ParserCreateWithContext(&context);
+}
+
+bool mcJSON_ParserFeed(mcJSON_Parser * const parser, const buffer_t * const chunk) {
+	if (parser == NULL) {
+		return false;
+	}
+
+	return mcJSON_SAXParserFeed(parser->sax, chunk);
+}
+
+mcJSON *mcJSON_ParserFinish(mcJSON_Parser * const parser) {
+	if (parser == NULL) {
+		return NULL;
+	}
+
+	mcJSON *root = NULL;
+	if (mcJSON_SAXParserFinish(parser->sax)) {
+		root = parser->root;
+	} else if (parser->context.pool == NULL) {
+		delete_item(parser->root, &parser->context);
+	} else {
+		mcJSON_PoolRollback(parser->context.pool, parser->start, true);
+	}
+
+	const mcJSON_Context context = parser->context;
+	context_free(&context, parser->stack);
+	context_free(&context, parser);
+
+	return root;
+}
+
+/* Tape:
+ * An immutable tree in a single allocation. Every value is one 16 byte entry,
+ * in the order of the json text, followed by the entries of its children.
+ * Every member of an object is a name entry followed by the value. Numbers are
+ * stored in the entry, strings and names in an arena behind the entries, where
+ * equal names are only stored once.
+ * Instead of pointers, entries refer to each other by their index. */
+
+/* type of the entry in front of every value in an object */
+#define TAPE_NAME 0x80
+
+typedef struct tape_entry {
+	uint8_t type; /* mcJSON_Type or TAPE_NAME */
+	bool is_int64; /* value.integer contains the number */
+	/* The next value in the same array or object, 0 if there is none.
+	 * In objects, the name entry and the value both point to the next name. */
+	uint32_t next;
+	union {
+		double number;
+		int64_t integer;
+		struct {
+			uint32_t offset; /* in the string arena */
+			uint32_t length; /* without the terminating '\0' */
+		} string;
+		uint32_t length; /* number of values in an array or object */
+	} value;
+} tape_entry;
+
+struct mcJSON_Tape {
+	size_t count; /* number of entries */
+	size_t strings_length;
+	unsigned char *strings; /* '\0' terminated, behind the entries */
+	tape_entry entries[];
+};
+
+/* An array or object that is being built. */
+typedef struct tape_frame {
+	size_t container;
+	size_t last_child; /* name entry in objects, 0 if it is still empty */
+} tape_frame;
+
+/* Builds a tape from the events of a mcJSON_SAXParser, it is copied into
+ * one allocation of the exact size in the end. */
+typedef struct tape_builder {
+	const mcJSON_Context *context; /* allocates everything */
+	tape_entry *entries;
+	size_t count;
+	size_t size;
+	unsigned char *strings;
+	size_t strings_length;
+	size_t strings_size;
+	/* open arrays and objects */
+	tape_frame *stack;
+	size_t depth;
+	size_t stack_size;
+	/* Name entries with different names, so that names that repeat are only
+	 * once in the arena. Open addressing with linear probing, 0 is empty. */
+	size_t *names;
+	size_t names_size; /* power of 2 */
+	size_t names_count;
+} tape_builder;
+
+/* Append an entry of type, returns its index or mcJSON_TAPE_NONE if it can't be appended.
+ * Values that are not in an object and the names in an object are linked to
+ * their previous sibling. */
+static size_t tape_append(tape_builder * const builder, const uint8_t type) {
+	if ((builder->count >= UINT32_MAX)
+			|| !array_reserve((void**)&builder->entries, &builder->size, builder->count, sizeof(tape_entry), builder->context)) {
+		return mcJSON_TAPE_NONE;
+	}
+
+	const size_t index = builder->count;
+	memset(&builder->entries[index], 0, sizeof(tape_entry));
+	builder->entries[index].type = type;
+	builder->count++;
+
+	if (builder->depth == 0) { /* root */
+		return index;
+	}
+	tape_frame * const frame = &builder->stack[builder->depth - 1];
+	const bool in_object = (builder->entries[frame->container].type == mcJSON_Object);
+	if (in_object && (type != TAPE_NAME)) { /* was linked with its name */
+		return index;
+	}
+	if (frame->last_child != 0) {
+		builder->entries[frame->last_child].next = (uint32_t)index;
+		if (in_object) {
+			builder->entries[frame->last_child + 1].next = (uint32_t)index;
+		}
+	}
+	frame->last_child = index;
+	builder->entries[frame->container].value.length++;
+
+	return index;
+}
+
+/* Slot of the name entry with the same name as string, or the empty one where it belongs. */
+static size_t *tape_find_name(const tape_builder * const builder, size_t * const names, const size_t size, const unsigned char * const string, const size_t length) {
+	uint32_t hash = 2166136261u; /* FNV-1a */
+	for (size_t i = 0; i < length; i++) {
+		hash ^= string[i];
+		hash *= 16777619u;
+	}
+
+	size_t index = hash & (size - 1);
+	while (names[index] != 0) {
+		const tape_entry * const name = &builder->entries[names[index]];
+		if ((name->value.string.length == length) && (memcmp(builder->strings + name->value.string.offset, string, length) == 0)) {
+			break;
+		}
+		index = (index + 1) & (size - 1);
+	}
+
+	return &names[index];
+}
+
+/* Make room for one more name, the table is at most half full. */
+static bool tape_reserve_name(tape_builder * const builder) {
+	if ((2 * (builder->names_count + 1)) <= builder->names_size) {
+		return true;
+	}
+
+	const size_t new_size = (builder->names_size == 0) ? 64 : (2 * builder->names_size);
+	size_t *new_names = (size_t*)context_malloc(builder->context, new_size * sizeof(size_t));
+	if (new_names == NULL) {
+		return false;
+	}
+	memset(new_names, 0, new_size * sizeof(size_t));
+	for (size_t i = 0; i < builder->names_size; i++) {
+		if (builder->names[i] != 0) {
+			const tape_entry * const name = &builder->entries[builder->names[i]];
+			*tape_find_name(builder, new_names, new_size, builder->strings + name->value.string.offset, name->value.string.length) = builder->names[i];
+		}
+	}
+	context_free(builder->context, builder->names);
+	builder->names = new_names;
+	builder->names_size = new_size;
+
+	return true;
+}
+
+/* Append an entry for a string or name, the string is copied to the arena.
+ * Names that are already in the arena are shared. */
+static bool tape_append_string(tape_builder * const builder, const uint8_t type, const buffer_t * const string) {
+	const size_t length = string->content_length - 1;
+	size_t *name_slot = NULL;
+	if (type == TAPE_NAME) {
+		if (!tape_reserve_name(builder)) {
+			return false;
+		}
+		name_slot = tape_find_name(builder, builder->names, builder->names_size, string->content, length);
+	}
+
+	const size_t index = tape_append(builder, type);
+	if (index == mcJSON_TAPE_NONE) {
+		return false;
+	}
+	if ((name_slot != NULL) && (*name_slot != 0)) {
+		builder->entries[index].value.string = builder->entries[*name_slot].value.string;
+		return true;
+	}
+
+	if ((length >= UINT32_MAX) || ((builder->strings_length + length + 1) > UINT32_MAX)) {
+		return false;
+	}
+	if ((builder->strings_length + length + 1) > builder->strings_size) {
+		size_t new_size = (builder->strings_size == 0) ? 256 : builder->strings_size;
+		while (new_size < (builder->strings_length + length + 1)) {
+			new_size *= 2;
+		}
+		unsigned char *new_strings = (unsigned char*)context_realloc(builder->context, builder->strings, builder->strings_length, new_size);
+		if (new_strings == NULL) {
+			return false;
+		}
+		builder->strings = new_strings;
+		builder->strings_size = new_size;
+	}
+
+	builder->entries[index].value.string.offset = (uint32_t)builder->strings_length;
+	builder->entries[index].value.string.length = (uint32_t)length;
+	memcpy(builder->strings + builder->strings_length, string->content, length);
+	builder->strings[builder->strings_length + length] = '\0'; /* borrowed strings have '"' there */
+	builder->strings_length += length + 1;
+	if (name_slot != NULL) {
+		*name_slot = index;
+		builder->names_count++;
+	}
+
+	return true;
+}
+
+static bool tape_start_container(tape_builder * const builder, const mcJSON_Type type) {
+	const size_t index = tape_append(builder, (uint8_t)type);
+	if ((index == mcJSON_TAPE_NONE) || !array_reserve((void**)&builder->stack, &builder->stack_size, builder->depth, sizeof(tape_frame), builder->context)) {
+		return false;
+	}
+	builder->stack[builder->depth].container = index;
+	builder->stack[builder->depth].last_child = 0;
+	builder->depth++;
+
+	return true;
+}
+
+static bool tape_start_object(void * const userdata) {
+	return tape_start_container((tape_builder*)userdata, mcJSON_Object);
+}
+
+static bool tape_start_array(void * const userdata) {
+	return tape_start_container((tape_builder*)userdata, mcJSON_Array);
+}
+
+static bool tape_end_container(void * const userdata) {
+	((tape_builder*)userdata)->depth--;
+	return true;
+}
+
+static bool tape_key(void * const userdata, const buffer_t * const key) {
+	return tape_append_string((tape_builder*)userdata, TAPE_NAME, key);
+}
+
+static bool tape_string(void * const userdata, const buffer_t * const string) {
+	return tape_append_string((tape_builder*)userdata, mcJSON_String, string);
+}
+
+static bool tape_number(void * const userdata, const double number, const int64_t * const integer) {
+	tape_builder * const builder = (tape_builder*)userdata;
+	const size_t index = tape_append(builder, mcJSON_Number);
+	if (index == mcJSON_TAPE_NONE) {
+		return false;
+	}
+	if (integer != NULL) {
+		builder->entries[index].is_int64 = true;
+		builder->entries[index].value.integer = *integer;
+	} else {
+		builder->entries[index].value.number = number;
+	}
+
+	return true;
+}
+
+static bool tape_literal(tape_builder * const builder, const mcJSON_Type type) {
+	return tape_append(builder, (uint8_t)type) != mcJSON_TAPE_NONE;
+}
+
+static bool tape_boolean(void * const userdata, const bool value) {
+	return tape_literal((tape_builder*)userdata, value ? mcJSON_True : mcJSON_False);
+}
+
+static bool tape_null(void * const userdata) {
+	return tape_literal((tape_builder*)userdata, mcJSON_NULL);
+}
+
+static const mcJSON_SAXCallbacks tape_callbacks = {
+	tape_start_object,
+	tape_end_container, /* end_object */
+	tape_start_array,
+	tape_end_container, /* end_array */
+	tape_key,
+	tape_string,
+	tape_number,
+	tape_boolean,
+	tape_null
+};
+
+mcJSON_Tape *mcJSON_ParseTapeWithContext(const buffer_t * const json, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	if ((context->max_length != 0) && (json->content_length > context->max_length)) {
+		return NULL;
+	}
+
+	tape_builder builder;
+	memset(&builder, 0, sizeof(tape_builder));
+	builder.context = context;
+
+	mcJSON_Tape *tape = NULL;
+	if (!parse_sax(json, &tape_callbacks, &builder, context) || (builder.count == 0)) {
+		goto cleanup;
+	}
+
+	const size_t entries_size = builder.count * sizeof(tape_entry);
+	tape = (mcJSON_Tape*)context_malloc(context, sizeof(mcJSON_Tape) + entries_size + builder.strings_length);
+	if (tape == NULL) {
+		goto cleanup;
+	}
+	tape->count = builder.count;
+	tape->strings_length = builder.strings_length;
+	tape->strings = (unsigned char*)tape->entries + entries_size;
+	memcpy(tape->entries, builder.entries, entries_size);
+	if (builder.strings_length != 0) {
+		memcpy(tape->strings, builder.strings, builder.strings_length);
+	}
+
+cleanup:
+	context_free(context, builder.entries);
+	context_free(context, builder.strings);
+	context_free(context, builder.stack);
+	context_free(context, builder.names);
+
+	return tape;
+}
+
+mcJSON_Tape *mcJSON_ParseTape(const buffer_t * const json) {
+	return mcJSON_ParseTapeWithContext(json, NULL);
+}
+
+void mcJSON_TapeDeleteWithContext(mcJSON_Tape * const tape, const mcJSON_Context * const context) {
+	if (context == NULL) {
+		mcJSON_TapeDelete(tape);
+		return;
+	}
+
+	context_free(context, tape);
+}
+
+void mcJSON_TapeDelete(mcJSON_Tape * const tape) {
+	const mcJSON_Context context = pool_context(NULL);
+	context_free(&context, tape);
+}
+
+size_t mcJSON_TapeSize(const mcJSON_Tape * const tape) {
+	return sizeof(mcJSON_Tape) + (tape->count * sizeof(tape_entry)) + tape->strings_length;
+}
+
+/* Entry of a value, NULL if there is none. */
+static const tape_entry *tape_value(const mcJSON_Tape * const tape, const size_t value) {
+	if ((tape == NULL) || (value >= tape->count) || (tape->entries[value].type == TAPE_NAME)) {
+		return NULL;
+	}
+
+	return &tape->entries[value];
+}
+
+mcJSON_Type mcJSON_TapeType(const mcJSON_Tape * const tape, const size_t value) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if (entry == NULL) {
+		return 0;
+	}
+
+	return (mcJSON_Type)entry->type;
+}
+
+size_t mcJSON_TapeLength(const mcJSON_Tape * const tape, const size_t value) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if ((entry == NULL) || ((entry->type != mcJSON_Array) && (entry->type != mcJSON_Object))) {
+		return 0;
+	}
+
+	return entry->value.length;
+}
+
+size_t mcJSON_TapeChild(const mcJSON_Tape * const tape, const size_t value) {
+	if (mcJSON_TapeLength(tape, value) == 0) {
+		return mcJSON_TAPE_NONE;
+	}
+
+	/* skip the name of the first member */
+	return (tape->entries[value].type == mcJSON_Object) ? (value + 2) : (value + 1);
+}
+
+size_t mcJSON_TapeNext(const mcJSON_Tape * const tape, const size_t value) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if ((entry == NULL) || (entry->next == 0)) {
+		return mcJSON_TAPE_NONE;
+	}
+
+	/* the next member of an object starts with its name */
+	return (tape->entries[entry->next].type == TAPE_NAME) ? (entry->next + 1) : entry->next;
+}
+
+size_t mcJSON_TapeGetArrayItem(const mcJSON_Tape * const tape, const size_t array, size_t index) {
+	size_t item = mcJSON_TapeChild(tape, array);
+	for (; (item != mcJSON_TAPE_NONE) && (index > 0); index--) {
+		item = mcJSON_TapeNext(tape, item);
+	}
+
+	return item;
+}
+
+/* Compare the name entry with a name, the name has to be '\0' terminated like the other names. */
+static bool tape_name_equals(const mcJSON_Tape * const tape, const tape_entry * const entry, const buffer_t * const name) {
+	return (name->content_length == ((size_t)entry->value.string.length + 1))
+		&& (name->content[entry->value.string.length] == '\0')
+		&& (memcmp(tape->strings + entry->value.string.offset, name->content, entry->value.string.length) == 0);
+}
+
+size_t mcJSON_TapeGetObjectItem(const mcJSON_Tape * const tape, const size_t object, const buffer_t * const name) {
+	if ((name == NULL) || (name->content == NULL) || (mcJSON_TapeType(tape, object) != mcJSON_Object)) {
+		return mcJSON_TAPE_NONE;
+	}
+
+	for (size_t member = mcJSON_TapeChild(tape, object); member != mcJSON_TAPE_NONE; member = mcJSON_TapeNext(tape, member)) {
+		if (tape_name_equals(tape, &tape->entries[member - 1], name)) {
+			return member;
+		}
+	}
+
+	return mcJSON_TAPE_NONE;
+}
+
+/* Point string at a string in the arena. */
+static void tape_string_view(const mcJSON_Tape * const tape, const tape_entry * const entry, buffer_t * const string) {
+	const size_t length = (size_t)entry->value.string.length + 1;
+	buffer_init_with_pointer(string, tape->strings + entry->value.string.offset, length, length);
+}
+
+bool mcJSON_TapeGetName(const mcJSON_Tape * const tape, const size_t value, buffer_t * const name) {
+	if ((name == NULL) || (tape_value(tape, value) == NULL) || (value == 0) || (tape->entries[value - 1].type != TAPE_NAME)) {
+		return false;
+	}
+
+	tape_string_view(tape, &tape->entries[value - 1], name);
+	return true;
+}
+
+bool mcJSON_TapeGetDouble(const mcJSON_Tape * const tape, const size_t value, double * const number) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if ((number == NULL) || (entry == NULL) || (entry->type != mcJSON_Number)) {
+		return false;
+	}
+
+	*number = entry->is_int64 ? (double)entry->value.integer : entry->value.number;
+	return true;
+}
+
+bool mcJSON_TapeGetInt64(const mcJSON_Tape * const tape, const size_t value, int64_t * const number) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if ((number == NULL) || (entry == NULL) || (entry->type != mcJSON_Number) || !entry->is_int64) {
+		return false;
+	}
+
+	*number = entry->value.integer;
+	return true;
+}
+
+bool mcJSON_TapeGetBool(const mcJSON_Tape * const tape, const size_t value, bool * const boolean) {
+	const mcJSON_Type type = mcJSON_TapeType(tape, value);
+	if ((boolean == NULL) || ((type != mcJSON_True) && (type != mcJSON_False))) {
+		return false;
+	}
+
+	*boolean = (type == mcJSON_True);
+	return true;
+}
+
+bool mcJSON_TapeGetString(const mcJSON_Tape * const tape, const size_t value, buffer_t * const string) {
+	const tape_entry * const entry = tape_value(tape, value);
+	if ((string == NULL) || (entry == NULL) || (entry->type != mcJSON_String)) {
+		return false;
+	}
+
+	tape_string_view(tape, entry, string);
+	return true;
+}
+
+/* Cursor:
+ * Walks the json text forward and only looks at the values the caller
+ * asks for, everything else is skipped by counting brackets. The position
+ * is always the start of the current value or the closing bracket if
+ * there are no more values in the current array or object. Whether a
+ * string is the key of an object member is determined by the ':' after it,
+ * so the cursor needs no stack. */
+static size_t cursor_skip_whitespace(const buffer_t * const json, size_t position) {
+	while ((position < json->content_length) && (json->content[position] <= 32) && (json->content[position] != '\0')) {
+		position++;
+	}
+	return position;
+}
+
+/* Position after the closing '"' of the string at position, 0 if there is none. */
+static size_t cursor_string_end(const buffer_t * const json, size_t position) {
+	position++;
+	while (true) {
+		position = find_string_delimiter(json->content, position, json->content_length);
+		if ((position >= json->content_length) || (json->content[position] == '\0')) {
+			return 0;
+		}
+		if (json->content[position] == '\"') {
+			return position + 1;
+		}
+		if ((position + 1) >= json->content_length) { /* '\\' at the end */
+			return 0;
+		}
+		position += 2;
+	}
+}
+
+/* Position after the value at position without parsing it, 0 if it is malformed. */
+static size_t cursor_value_end(const buffer_t * const json, size_t position) {
+	const unsigned char * const content = json->content;
+	if (position >= json->content_length) {
+		return 0;
+	}
+	if (content[position] == '\"') {
+		return cursor_string_end(json, position);
+	}
+	if ((content[position] != '{') && (content[position] != '[')) { /* number or literal */
+		while ((position < json->content_length) && (content[position] > 32) && (content[position] != ',') && (content[position] != ']') && (content[position] != '}')) {
+			position++;
+		}
+		return position;
+	}
+
+	size_t depth = 0;
+	while (position < json->content_length) {
+		switch (content[position]) {
+			case '\"':
+				position = cursor_string_end(json, position);
+				if (position == 0) {
+					return 0;
+				}
+				continue;
+
+			case '{':
+			case '[':
+				depth++;
+				break;
+
+			case '}':
+			case ']':
+				depth--;
+				if (depth == 0) {
+					return position + 1;
+				}
+				break;
+
+			case '\0':
+				return 0;
+
+			default:
+				break;
+		}
+		position++;
+	}
+
+	return 0;
+}
+
+static bool cursor_at_end(const mcJSON_Cursor * const cursor) {
+	return (cursor->position >= cursor->json->content_length) || (cursor->json->content[cursor->position] == ']') || (cursor->json->content[cursor->position] == '}');
+}
+
+/* Move to the element of an array or object that starts at position
+ * (after '[', '{' or ','). Returns false if there is none. */
+static bool cursor_element(mcJSON_Cursor * const cursor, size_t position) {
+	const buffer_t * const json = cursor->json;
+	position = cursor_skip_whitespace(json, position);
+	cursor->position = position;
+	cursor->has_key = false;
+	if (cursor_at_end(cursor)) {
+		return false;
+	}
+
+	if (json->content[position] == '\"') {
+		const size_t string_end = cursor_string_end(json, position);
+		if (string_end == 0) {
+			cursor->position = json->content_length;
+			return false;
+		}
+		const size_t colon = cursor_skip_whitespace(json, string_end);
+		if ((colon < json->content_length) && (json->content[colon] == ':')) { /* the string was a key */
+			cursor->has_key = true;
+			cursor->key = position;
+			cursor->position = cursor_skip_whitespace(json, colon + 1);
+		}
+	}
+
+	return !cursor_at_end(cursor);
+}
+
+/* Move behind the current value to the next element of the current array or object. */
+static bool cursor_next_after(mcJSON_Cursor * const cursor, const size_t value_end) {
+	if (value_end == 0) { /* malformed */
+		cursor->position = cursor->json->content_length;
+		return false;
+	}
+
+	const size_t position = cursor_skip_whitespace(cursor->json, value_end);
+	if ((position < cursor->json->content_length) && (cursor->json->content[position] == ',')) {
+		return cursor_element(cursor, position + 1);
+	}
+
+	cursor->position = position;
+	cursor->has_key = false;
+	if (!cursor_at_end(cursor) && (cursor->depth != 0)) { /* neither ',' nor the end of an array or object */
+		cursor->position = cursor->json->content_length;
+	}
+	return false;
+}
+
+bool mcJSON_CursorInit(mcJSON_Cursor * const cursor, const buffer_t * const json) {
+	if ((cursor == NULL) || (json == NULL) || (json->content == NULL)) {
+		return false;
+	}
+
+	cursor->json = json;
+	cursor->depth = 0;
+	cursor->has_key = false;
+	cursor->key = 0;
+	cursor->position = cursor_skip_whitespace(json, 0);
+
+	return mcJSON_CursorType(cursor) != 0;
+}
+
+mcJSON_Type mcJSON_CursorType(const mcJSON_Cursor * const cursor) {
+	if ((cursor == NULL) || (cursor->position >= cursor->json->content_length)) {
+		return 0;
+	}
+
+	const unsigned char character = cursor->json->content[cursor->position];
+	switch (character) {
+		case '{':
+			return mcJSON_Object;
+		case '[':
+			return mcJSON_Array;
+		case '\"':
+			return mcJSON_String;
+		case 't':
+			return mcJSON_True;
+		case 'f':
+			return mcJSON_False;
+		case 'n':
+			return mcJSON_NULL;
+		default:
+			return ((character == '-') || is_digit(character)) ? mcJSON_Number : 0;
+	}
+}
+
+bool mcJSON_CursorEnter(mcJSON_Cursor * const cursor) {
+	const mcJSON_Type type = mcJSON_CursorType(cursor);
+	if ((type != mcJSON_Object) && (type != mcJSON_Array)) {
+		return false;
+	}
+
+	cursor->depth++;
+	return cursor_element(cursor, cursor->position + 1);
+}
+
+bool mcJSON_CursorNext(mcJSON_Cursor * const cursor) {
+	if ((cursor == NULL) || cursor_at_end(cursor)) {
+		return false;
+	}
+
+	return cursor_next_after(cursor, cursor_value_end(cursor->json, cursor->position));
+}
+
+bool mcJSON_CursorLeave(mcJSON_Cursor * const cursor) {
+	if ((cursor == NULL) || (cursor->depth == 0)) {
+		return false;
+	}
+
+	while (mcJSON_CursorNext(cursor)) {
+		/* skip the remaining values */
+	}
+	if (cursor->position >= cursor->json->content_length) { /* malformed */
+		return false;
+	}
+
+	cursor->depth--;
+	return cursor_next_after(cursor, cursor->position + 1);
+}
+
+/* compare the raw key at position to a '\0' terminated name */
+static bool cursor_key_equals(const mcJSON_Cursor * const cursor, const buffer_t * const name) {
+	const buffer_t * const json = cursor->json;
+	const size_t start = cursor->key + 1;
+	const size_t end = cursor_string_end(json, cursor->key) - 1;
+	const size_t first_delimiter = find_string_delimiter(json->content, start, end);
+	if (first_delimiter == end) { /* no escape sequences */
+		return ((end - start + 1) == name->content_length) && (memcmp(json->content + start, name->content, end - start) == 0);
+	}
+
+	/* escaped keys are compared run by run, every escape sequence is decoded on its own */
+	buffer_create_with_existing_array(input, json->content, json->content_length);
+	input->position = start;
+	unsigned char decoded[4];
+	size_t compared = 0; /* bytes of name that matched so far */
+	size_t run_end = first_delimiter;
+	while (true) {
+		const size_t run_length = run_end - input->position;
+		if (((compared + run_length + 1) > name->content_length) || (memcmp(json->content + input->position, name->content + compared, run_length) != 0)) {
+			return false;
+		}
+		compared += run_length;
+		input->position = run_end;
+		if (input->position >= end) {
+			return (compared + 1) == name->content_length;
+		}
+
+		buffer_create_with_existing_array(output, decoded, sizeof(decoded));
+		if (!parse_escape_sequence(input, output) || (input->position > end)
+				|| ((compared + output->position + 1) > name->content_length)
+				|| (memcmp(decoded, name->content + compared, output->position) != 0)) {
+			return false;
+		}
+		compared += output->position;
+		run_end = find_string_delimiter(json->content, input->position, end);
+	}
+}
+
+bool mcJSON_CursorFindField(mcJSON_Cursor * const cursor, const buffer_t * const name) {
+	if ((cursor == NULL) || (name == NULL) || (name->content_length == 0)) {
+		return false;
+	}
+
+	while (!cursor_at_end(cursor)) {
+		if (cursor->has_key && cursor_key_equals(cursor, name)) {
+			return true;
+		}
+		if (!mcJSON_CursorNext(cursor)) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+bool mcJSON_CursorGetDouble(const mcJSON_Cursor * const cursor, double * const value) {
+	if ((value == NULL) || (mcJSON_CursorType(cursor) != mcJSON_Number)) {
+		return false;
+	}
+
+	buffer_create_with_existing_array(input, cursor->json->content, cursor->json->content_length);
+	input->position = cursor->position;
+	int64_t integer;
+	bool is_int64;
+	const mcJSON_Context context = pool_context(NULL);
+	return scan_number(input, value, &integer, &is_int64, &context);
+}
+
+bool mcJSON_CursorGetInt64(const mcJSON_Cursor * const cursor, int64_t * const value) {
+	if ((value == NULL) || (mcJSON_CursorType(cursor) != mcJSON_Number)) {
+		return false;
+	}
+
+	buffer_create_with_existing_array(input, cursor->json->content, cursor->json->content_length);
+	input->position = cursor->position;
+	double number;
+	bool is_int64;
+	const mcJSON_Context context = pool_context(NULL);
+	return scan_number(input, &number, value, &is_int64, &context) && is_int64;
+}
+
+bool mcJSON_CursorGetBool(const mcJSON_Cursor * const cursor, bool * const value) {
+	const mcJSON_Type type = mcJSON_CursorType(cursor);
+	if ((value == NULL) || ((type != mcJSON_True) && (type != mcJSON_False))) {
+		return false;
+	}
+
+	*value = (type == mcJSON_True);
+	return true;
+}
+
+bool mcJSON_CursorGetString(const mcJSON_Cursor * const cursor, buffer_t * const string) {
+	if ((string == NULL) || (mcJSON_CursorType(cursor) != mcJSON_String)) {
+		return false;
+	}
+
+	const size_t start = cursor->position + 1;
+	const size_t end = cursor_string_end(cursor->json, cursor->position);
+	if ((end == 0) || (find_string_delimiter(cursor->json->content, start, end - 1) != (end - 1))) { /* malformed or escaped */
+		return false;
+	}
+
+	buffer_init_with_pointer(string, cursor->json->content + start, end - start, end - start);
+	return true;
+}
+
+/* Parse the current value into a tree, end is set to the position where the parser stopped. */
+static mcJSON *cursor_parse_value(const mcJSON_Cursor * const cursor, mempool_t * const pool, size_t * const end) {
+	if (mcJSON_CursorType(cursor) == 0) {
+		return NULL;
+	}
+
+	const mcJSON_Context context = pool_context(pool);
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	mcJSON *value = mcJSON_New_Item(&context);
+	if (value == NULL) {
+		return NULL;
+	}
+
+	buffer_create_with_existing_array(input, cursor->json->content, cursor->json->content_length);
+	input->position = cursor->position;
+	if (parse_value(value, input, &context, &default_parse_options, NULL) == NULL) {
+		if (pool == NULL) {
+			mcJSON_Delete(value);
+		}
+		mcJSON_PoolRollback(pool, marker, true);
+		return NULL;
+	}
+	if (end != NULL) {
+		*end = input->position;
+	}
+
+	return value;
+}
+
+mcJSON *mcJSON_CursorGetValue(const mcJSON_Cursor * const cursor, mempool_t * const pool) {
+	return cursor_parse_value(cursor, pool, NULL);
+}
+
+mcJSON *mcJSON_CursorTakeValue(mcJSON_Cursor * const cursor, mempool_t * const pool) {
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	size_t end;
+	mcJSON *value = cursor_parse_value(cursor, pool, &end);
+	if (value == NULL) {
+		return NULL;
+	}
+
+	/* The parser has to stop where the value ends, otherwise the rest of it would be skipped.
+	 * Inside of arrays and objects, cursor_next_after moves to the end of the input if neither
+	 * ',' nor the end follows, the root value can only be followed by whitespace. */
+	cursor_next_after(cursor, end);
+	const buffer_t * const json = cursor->json;
+	const bool malformed = (cursor->position >= json->content_length)
+		? (cursor->depth != 0)
+		: ((cursor->depth == 0) && (json->content[cursor->position] != '\0'));
+	if (malformed) {
+		if (pool == NULL) {
+			mcJSON_Delete(value);
+		}
+		mcJSON_PoolRollback(pool, marker, true);
+		return NULL;
+	}
+
+	return value;
+}
+
+/* Projected parsing:
+ * Only the values that one of the JSON Pointers (RFC 6901) points to are
+ * parsed, together with the arrays and objects on the way to them.
+ * Everything else is skipped with cursor_value_end and never allocated.
+ * depths[i] is the number of reference tokens of pointers[i] that match the
+ * path to the value that is currently parsed, so pointers[i] is still
+ * on this path if depths[i] is the current depth. */
+typedef struct projection {
+	const char * const *pointers;
+	size_t *depths;
+	size_t count;
+} projection;
+
+/* Reference token number index of pointer, NULL if it has less tokens. */
+static const char *pointer_token(const char * const pointer, const size_t index, size_t * const length) {
+	if (pointer[0] == '\0') { /* the whole document */
+		return NULL;
+	}
+
+	const char *token = pointer + 1;
+	for (size_t i = 0; i < index; i++) {
+		token = strchr(token, '/');
+		if (token == NULL) {
+			return NULL;
+		}
+		token++;
+	}
+	*length = strcspn(token, "/");
+
+	return token;
+}
+
+/* compare a reference token to a name, "~0" is '~' and "~1" is '/' */
+static bool token_equals_name(const char * const token, const size_t length, const buffer_t * const name) {
+	/* borrowed names have the closing '"' instead of the terminating '\0', so it isn't compared */
+	const size_t name_length = name->content_length - 1;
+	size_t position = 0;
+	for (size_t i = 0; i < length; i++, position++) {
+		if (position >= name_length) {
+			return false;
+		}
+		char character = token[i];
+		if ((character == '~') && ((i + 1) < length) && ((token[i + 1] == '0') || (token[i + 1] == '1'))) {
+			i++;
+			character = (token[i] == '0') ? '~' : '/';
+		}
+		if (name->content[position] != (unsigned char)character) {
+			return false;
+		}
+	}
+
+	return position == name_length;
+}
+
+/* compare a reference token to an array index, it can't have leading zeroes */
+static bool token_equals_index(const char * const token, const size_t length, const size_t index) {
+	if ((length == 0) || ((length > 1) && (token[0] == '0'))) {
+		return false;
+	}
+
+	size_t value = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (!is_digit((unsigned char)token[i]) || (value > ((SIZE_MAX - 9) / 10))) {
+			return false;
+		}
+		value = 10 * value + (size_t)(token[i] - '0');
+	}
+
+	return value == index;
+}
+
+/* Check if one of the pointers ends at the current depth, so the whole value is needed. */
+static bool projection_complete(const projection * const projection, const size_t depth) {
+	for (size_t i = 0; i < projection->count; i++) {
+		size_t length;
+		if ((projection->depths[i] == depth) && (pointer_token(projection->pointers[i], depth, &length) == NULL)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Move the pointers that lead to the member name (or the element at index if name is NULL)
+ * one level deeper. Returns false if there are none, the value can be skipped then. */
+static bool projection_descend(projection * const projection, const size_t depth, const buffer_t * const name, const size_t index) {
+	bool descended = false;
+	for (size_t i = 0; i < projection->count; i++) {
+		if (projection->depths[i] != depth) {
+			continue;
+		}
+
+		size_t length;
+		const char * const token = pointer_token(projection->pointers[i], depth, &length);
+		if ((token != NULL) && ((name != NULL) ? token_equals_name(token, length, name) : token_equals_index(token, length, index))) {
+			projection->depths[i] = depth + 1;
+			descended = true;
+		}
+	}
+
+	return descended;
+}
+
+/* Move all pointers that went deeper back to depth. */
+static void projection_ascend(projection * const projection, const size_t depth) {
+	for (size_t i = 0; i < projection->count; i++) {
+		if (projection->depths[i] > depth) {
+			projection->depths[i] = depth;
+		}
+	}
+}
+
+/* Position after the value at the current position without parsing it, NULL if it is malformed. */
+static buffer_t *projection_skip(buffer_t * const input) {
+	const size_t end = cursor_value_end(input, input->position);
+	if (end == 0) {
+		return NULL;
 	}
-	length--; /* last entry has no ',' */
+	input->position = end;
 
-	/* Try to allocate the output string */
-	if (!fail) {
-		output = buffer_create_with_custom_allocator(length, length, mcJSON_malloc, mcJSON_free);
+	return input;
+}
+
+static buffer_t *parse_projected_value(mcJSON * const item, buffer_t * const input, projection * const projection, const size_t depth, const mcJSON_Context * const context);
+
+/* Append child to the children of item. last is the current last child and becomes child. */
+static void projection_append(mcJSON * const item, mcJSON ** const last, mcJSON * const child) {
+	if (*last == NULL) {
+		item->child = child;
+	} else {
+		(*last)->next = child;
+		child->prev = *last;
 	}
-	if ((output == NULL) || (output->content == NULL)) {
-		fail = true;
+	*last = child;
+	item->length++;
+}
+
+/* Only the elements that are on the way to a pointer are parsed. Skipped elements
+ * before them are replaced by null, so the indices stay the same. */
+static buffer_t *parse_projected_array(mcJSON * const item, buffer_t * const input, projection * const projection, const size_t depth, const mcJSON_Context * const context) {
+	item->type = mcJSON_Array;
+	input->position++;
+	skip(input);
+	if (input->content[input->position] == ']') { /* empty array */
+		input->position++;
+		return input;
 	}
 
-	/* Compose the output: */
-	if (!fail) {
-		output->content[output->position] = '{';
-		output->position++;
-		if (format) {
-			output->content[output->position] = '\n';
-			output->position++;
-		}
-		output->content[output->position] = '\0';
-		for (size_t i = 0; i < item->length; i++) {
-			if (format) { /* indentation */
-				for (size_t j = 0; j < depth; j++) {
-					output->content[output->position + j] = '\t';
-				}
-				output->position += depth;
-			}
-			if (buffer_copy(output, output->position, names[i], 0, names[i]->content_length - 1) != 0) {
-				if (output->content != NULL) {
-					output->content[output->position] = '\0';
+	mcJSON *last = NULL;
+	for (size_t index = 0; true; index++) {
+		if (projection_descend(projection, depth, NULL, index)) {
+			while (item->length < index) { /* placeholders for the skipped elements */
+				mcJSON *placeholder = mcJSON_New_Item(context);
+				if (placeholder == NULL) {
+					return NULL;
 				}
-				fail = true;
-				break;
+				placeholder->type = mcJSON_NULL;
+				projection_append(item, &last, placeholder);
 			}
-			output->position += names[i]->content_length - 1;
 
-			output->content[output->position] = ':';
-			output->position++;
-			if (format) {
-				output->content[output->position] = '\t';
-				output->position++;
+			mcJSON *child = mcJSON_New_Item(context);
+			if (child == NULL) {
+				return NULL;
 			}
-			if (buffer_copy(output, output->position, entries[i], 0, entries[i]->content_length - 1) != 0) {
-				if (output->content != NULL) {
-					output->content[output->position] = '\0';
-				}
-				fail = true;
-				break;
+			projection_append(item, &last, child);
+			if (parse_projected_value(child, input, projection, depth + 1, context) == NULL) {
+				return NULL;
 			}
-			output->position += entries[i]->content_length - 1;
+			projection_ascend(projection, depth);
+		} else if (projection_skip(input) == NULL) {
+			return NULL;
+		}
 
-			if (i != (item->length - 1)) {
-				output->content[output->position] = ',';
-				output->position++;
-			}
+		skip(input);
+		if (input->content[input->position] == ']') { /* end of array */
+			input->position++;
+			return input;
+		}
+		if (input->content[input->position] != ',') { /* malformed */
+			return NULL;
+		}
+		input->position++;
+		skip(input);
+	}
+}
 
-			if (format) {
-				output->content[output->position] = '\n';
-				output->position++;
-			}
-			output->content[output->position] = '\0';
+/* Only the members that are on the way to a pointer are parsed. */
+static buffer_t *parse_projected_object(mcJSON * const item, buffer_t * const input, projection * const projection, const size_t depth, const mcJSON_Context * const context) {
+	item->type = mcJSON_Object;
+	input->position++;
+	skip(input);
+	if (input->content[input->position] == '}') { /* empty object */
+		input->position++;
+		return input;
+	}
 
-			buffer_destroy_with_custom_deallocator(names[i], mcJSON_free);
-			names[i] = NULL;
-			buffer_destroy_with_custom_deallocator(entries[i], mcJSON_free);
-			entries[i] = NULL;
+	mcJSON *last = NULL;
+	while (true) {
+		/* the name has to be parsed to know if the member is needed */
+		const mcJSON_PoolMarker marker = mcJSON_PoolMark(context->pool);
+		mcJSON *child = mcJSON_New_Item(context);
+		if (child == NULL) {
+			return NULL;
 		}
-	}
+		if (skip(parse_string(child, input, context, &default_parse_options, NULL)) == NULL) {
+			if (context->pool == NULL) {
+				delete_item(child, context);
+			}
+			return NULL;
+		}
+		child->name = child->valuestring;
+		child->name_is_borrowed = child->valuestring_is_borrowed;
+		child->valuestring = NULL;
+		child->valuestring_is_borrowed = false;
+		if (input->content[input->position] != ':') { /* malformed */
+			if (context->pool == NULL) {
+				delete_item(child, context);
+			}
+			return NULL;
+		}
+		input->position++;
+		skip(input);
 
-	/* Handle failure */
-	if (fail) {
-		for (size_t i = 0; i < item->length; i++) {
-			if (names[i] != NULL) {
-				buffer_destroy_with_custom_deallocator(names[i], mcJSON_free);
+		if (projection_descend(projection, depth, child->name, 0)) {
+			projection_append(item, &last, child);
+			if (parse_projected_value(child, input, projection, depth + 1, context) == NULL) {
+				return NULL;
 			}
-			if (entries[i] != NULL) {
-				buffer_destroy_with_custom_deallocator(entries[i], mcJSON_free);
+			projection_ascend(projection, depth);
+		} else {
+			/* the member isn't needed, so the memory for its name is given back */
+			if (context->pool == NULL) {
+				delete_item(child, context);
+			} else {
+				mcJSON_PoolRollback(context->pool, marker, false);
+			}
+			if (projection_skip(input) == NULL) {
+				return NULL;
 			}
 		}
-		mcJSON_free(names);
-		mcJSON_free(entries);
-		if (output != NULL) {
-			buffer_destroy_with_custom_deallocator(output, mcJSON_free);
+
+		skip(input);
+		if (input->content[input->position] == '}') { /* end of object */
+			input->position++;
+			return input;
+		}
+		if (input->content[input->position] != ',') { /* malformed */
+			return NULL;
 		}
+		input->position++;
+		skip(input);
+	}
+}
+
+static buffer_t *parse_projected_value(mcJSON * const item, buffer_t * const input, projection * const projection, const size_t depth, const mcJSON_Context * const context) {
+	if (projection_complete(projection, depth)) {
+		return parse_value(item, input, context, &default_parse_options, NULL);
+	}
+
+	switch (input->content[input->position]) {
+		case '[':
+			return parse_projected_array(item, input, projection, depth, context);
+
+		case '{':
+			return parse_projected_object(item, input, projection, depth, context);
+
+		default: /* the pointers go deeper than the document, but the value is already there */
+			return parse_value(item, input, context, &default_parse_options, NULL);
+	}
+}
+
+mcJSON *mcJSON_ParseProjected(buffer_t * const json, const char * const * const pointers, const size_t pointer_count, mempool_t * const pool) {
+	if ((json == NULL) || (json->content == NULL) || ((pointers == NULL) && (pointer_count != 0))) {
 		return NULL;
 	}
+	for (size_t i = 0; i < pointer_count; i++) {
+		if ((pointers[i] == NULL) || ((pointers[i][0] != '\0') && (pointers[i][0] != '/'))) {
+			return NULL;
+		}
+	}
 
-	mcJSON_free(names);
-	mcJSON_free(entries);
-	if (format) {
-		for (size_t i = 0; i < (depth - 1); i++) {
-			output->content[output->position + i] = '\t';
+	const mcJSON_Context context = pool_context(pool);
+	projection projection = {pointers, NULL, pointer_count};
+	if (pointer_count != 0) {
+		projection.depths = (size_t*)context_malloc(&context, pointer_count * sizeof(size_t));
+		if (projection.depths == NULL) {
+			return NULL;
 		}
-		output->position += depth - 1;
+		memset(projection.depths, 0, pointer_count * sizeof(size_t));
 	}
-	output->content[output->position] = '}';
-	output->position++;
-	output->content[output->position] = '\0';
 
-	output->content_length = output->position + 1;
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	mcJSON *root = mcJSON_New_Item(&context);
+	if (root == NULL) {
+		context_free(&context, projection.depths);
+		return NULL;
+	}
+	json->position = 0;
+	if (parse_projected_value(root, skip(json), &projection, 0, &context) == NULL) {
+		if (pool == NULL) {
+			delete_item(root, &context);
+		}
+		mcJSON_PoolRollback(pool, marker, true);
+		root = NULL;
+	}
+	context_free(&context, projection.depths);
 
-	return output;
+	return root;
 }
 
 mcJSON *mcJSON_GetArrayItem(const mcJSON * const array, size_t index) {
@@ -1414,9 +5293,25 @@ mcJSON *mcJSON_GetArrayItem(const mcJSON * const array, size_t index) {
 	return child;
 }
 
+/* compare the name of an item to a '\0' terminated string */
+static bool name_equals(const mcJSON * const item, const buffer_t * const string) {
+	if (item->name == string) { /* e.g. an interned name */
+		return true;
+	}
+	if (!item->name_is_borrowed) {
+		return buffer_compare(item->name, string) == 0;
+	}
+
+	/* borrowed names have something else instead of the terminating '\0' */
+	return (item->name->content_length == string->content_length)
+		&& (string->content_length != 0)
+		&& (string->content[string->content_length - 1] == '\0')
+		&& (memcmp(item->name->content, string->content, string->content_length - 1) == 0);
+}
+
 mcJSON *mcJSON_GetObjectItem(const mcJSON * const object, const buffer_t * const string) {
 	mcJSON *child = object->child;
-	while ((child != NULL) && (buffer_compare(child->name, string) != 0)) {
+	while ((child != NULL) && !name_equals(child, string)) {
 		child = child->next;
 	}
 	return child;
@@ -1429,8 +5324,8 @@ static void insert_into_object(mcJSON * const prev, mcJSON * const item) {
 }
 
 /* Utility for handling references. */
-static mcJSON *create_reference(const mcJSON * const item, mempool_t * const pool) {
-	mcJSON *reference = mcJSON_New_Item(pool);
+static mcJSON *create_reference(const mcJSON * const item, const mcJSON_Context * const context) {
+	mcJSON *reference = mcJSON_New_Item(context);
 
 	if (reference == NULL) {
 		return NULL;
@@ -1438,12 +5333,20 @@ static mcJSON *create_reference(const mcJSON * const item, mempool_t * const poo
 
 	memcpy(reference, item, sizeof(mcJSON));
 	reference->name = NULL;
+	reference->name_is_borrowed = false;
 	reference->is_reference = true;
 	reference->next = reference->prev = NULL;
 
 	return reference;
 }
 
+/* Items that are detached from a tree in the pool of context stay in the pool. */
+static void delete_detached(mcJSON * const item, const mcJSON_Context * const context) {
+	if (context->pool == NULL) {
+		delete_item(item, context);
+	}
+}
+
 /* Add item to array/object. */
 void mcJSON_AddItemToArray(mcJSON * const array, mcJSON * const item, mempool_t * const pool __attribute__((unused))) {
 	if (array == NULL) {
@@ -1467,48 +5370,72 @@ void mcJSON_AddItemToArray(mcJSON * const array, mcJSON * const item, mempool_t
 	array->length++;
 }
 
-void mcJSON_AddItemToObject(mcJSON * const object, const buffer_t * const string, mcJSON * const item, mempool_t * const pool) {
-	if (item == NULL) {
-		return;
+/* Replace the name of item with a copy of string. */
+static bool set_name(mcJSON * const item, const buffer_t * const string, const bool string_is_const, const mcJSON_Context * const context) {
+	if (!(item->string_is_const) && (item->name != NULL)) {
+		string_deallocate(item->name, item->name_is_borrowed, context);
 	}
 
-	if ((item->name != NULL) && (item->name->content != NULL)) {
-		parsebuffer_deallocate(item->name, pool);
+	item->name_is_borrowed = false;
+	item->string_is_const = false;
+	item->name = parsebuffer_allocate(string->content_length, string->content_length, context);
+	if (buffer_clone(item->name, string) != 0) {
+		//TODO proper error handling
+		return false;
 	}
+	item->string_is_const = string_is_const;
 
-	item->name = parsebuffer_allocate(string->content_length, string->content_length, pool);
-	if (buffer_clone(item->name, string) != 0) {
+	return true;
+}
+
+void mcJSON_AddItemToObjectWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	if ((item == NULL) || !set_name(item, string, false, context)) {
 		return;
 	}
 
-	mcJSON_AddItemToArray(object, item, pool);
+	mcJSON_AddItemToArray(object, item, context->pool);
+}
+
+void mcJSON_AddItemToObject(mcJSON * const object, const buffer_t * const string, mcJSON * const item, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_AddItemToObjectWithContext(object, string, item, &context);
 }
 
 /* TODO remove this? */
-void mcJSON_AddItemToObjectCS(mcJSON * const object, const buffer_t * const string, mcJSON * const item, mempool_t * const pool) {
-	if (item == NULL) {
+void mcJSON_AddItemToObjectCSWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	if ((item == NULL) || !set_name(item, string, true, context)) {
 		return;
 	}
 
-	if (!(item->string_is_const) && (item->name != NULL) && (item->name->content != NULL)) {
-		parsebuffer_deallocate(item->name, pool);
-	}
+	mcJSON_AddItemToArray(object, item, context->pool);
+}
 
-	item->name = parsebuffer_allocate(string->content_length, string->content_length, pool);
-	int status = buffer_clone(item->name, string);
-	if (status != 0) {
-		//TODO proper error handling
-		return;
-	}
-	item->string_is_const = true;
-	mcJSON_AddItemToArray(object, item, pool);
+void mcJSON_AddItemToObjectCS(mcJSON * const object, const buffer_t * const string, mcJSON * const item, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_AddItemToObjectCSWithContext(object, string, item, &context);
 }
 
+void mcJSON_AddItemReferenceToArrayWithContext(mcJSON * const array, const mcJSON * const item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON_AddItemToArray(array, create_reference(item, context), context->pool);
+}
 void mcJSON_AddItemReferenceToArray(mcJSON * const array, const mcJSON * const item, mempool_t * const pool) {
-	mcJSON_AddItemToArray(array, create_reference(item, pool), pool);
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_AddItemReferenceToArrayWithContext(array, item, &context);
+}
+void mcJSON_AddItemReferenceToObjectWithContext(mcJSON * const object, const buffer_t * const string, const mcJSON * const item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON_AddItemToObjectWithContext(object, string, create_reference(item, context), context);
 }
 void mcJSON_AddItemReferenceToObject(mcJSON * const object, const buffer_t * const string, const mcJSON * const item, mempool_t * const pool) {
-	mcJSON_AddItemToObject(object, string, create_reference(item, pool), pool);
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_AddItemReferenceToObjectWithContext(object, string, item, &context);
 }
 
 /* detach child from parent */
@@ -1540,16 +5467,28 @@ mcJSON *mcJSON_DetachItemFromArray(mcJSON * const array, const size_t index) {
 	return detach_item(array, mcJSON_GetArrayItem(array, index));
 }
 
+void mcJSON_DeleteItemFromArrayWithContext(mcJSON * const array, const size_t index, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	delete_detached(mcJSON_DetachItemFromArray(array, index), context);
+}
+
 void mcJSON_DeleteItemFromArray(mcJSON * const array, const size_t index) {
-	mcJSON_Delete(mcJSON_DetachItemFromArray(array, index));
+	mcJSON_DeleteItemFromArrayWithContext(array, index, NULL);
 }
 
 mcJSON *mcJSON_DetachItemFromObject(mcJSON * const object, const buffer_t * const string) {
 	return detach_item(object, mcJSON_GetObjectItem(object, string));
 }
 
+void mcJSON_DeleteItemFromObjectWithContext(mcJSON * const object, const buffer_t * const string, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	delete_detached(mcJSON_DetachItemFromObject(object, string), context);
+}
+
 void   mcJSON_DeleteItemFromObject(mcJSON * const object, const buffer_t * const string) {
-	mcJSON_Delete(mcJSON_DetachItemFromObject(object, string));
+	mcJSON_DeleteItemFromObjectWithContext(object, string, NULL);
 }
 
 /* insert an item into an array or object after "previous" */
@@ -1573,7 +5512,7 @@ void   mcJSON_InsertItemInArray(mcJSON * const array, const size_t index, mcJSON
 	insert_item(array, mcJSON_GetArrayItem(array, index), new_item, pool);
 }
 
-void replace_item(mcJSON * const parent, mcJSON * const child, mcJSON * const new_item, mempool_t * const pool __attribute__((unused))) {
+void replace_item(mcJSON * const parent, mcJSON * const child, mcJSON * const new_item, const mcJSON_Context * const context) {
 	if (child == NULL) {
 		return;
 	}
@@ -1594,146 +5533,249 @@ void replace_item(mcJSON * const parent, mcJSON * const child, mcJSON * const ne
 	child->prev = NULL;
 	child->next = NULL;
 
-	mcJSON_Delete(child);
+	delete_detached(child, context);
 }
 
 /* Replace array/object items with new ones. */
+void mcJSON_ReplaceItemInArrayWithContext(mcJSON * const array, const size_t index, mcJSON * const new_item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	replace_item(array, mcJSON_GetArrayItem(array, index), new_item, context);
+}
+
 void mcJSON_ReplaceItemInArray(mcJSON * const array, const size_t index, mcJSON * const new_item, mempool_t * const pool) {
-	replace_item(array, mcJSON_GetArrayItem(array, index), new_item, pool);
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_ReplaceItemInArrayWithContext(array, index, new_item, &context);
+}
+
+void mcJSON_ReplaceItemInObjectWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const new_item, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON *child = mcJSON_GetObjectItem(object, string);
+	if ((child == NULL) || !set_name(new_item, string, false, context)) {
+		return;
+	}
+	replace_item(object, child, new_item, context);
 }
 
 void mcJSON_ReplaceItemInObject(mcJSON * const object, const buffer_t * const string, mcJSON * const new_item, mempool_t * const pool) {
-	replace_item(object, mcJSON_GetObjectItem(object, string), new_item, pool);
+	const mcJSON_Context context = pool_context(pool);
+	mcJSON_ReplaceItemInObjectWithContext(object, string, new_item, &context);
 }
 
 /* Create basic types: */
-mcJSON *mcJSON_CreateNull(mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
+/* Create an item of type with the allocator or in the pool of context. */
+static mcJSON *create_item(const mcJSON_Type type, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON *item = mcJSON_New_Item(context);
 	if (item) {
-		item->type = mcJSON_NULL;
+		item->type = type;
 	}
 	return item;
 }
+
+mcJSON *mcJSON_CreateNullWithContext(const mcJSON_Context * const context) {
+	return create_item(mcJSON_NULL, context);
+}
+mcJSON *mcJSON_CreateNull(mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(mcJSON_NULL, &context);
+}
+mcJSON *mcJSON_CreateTrueWithContext(const mcJSON_Context * const context) {
+	return create_item(mcJSON_True, context);
+}
 mcJSON *mcJSON_CreateTrue(mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
-	if (item) {
-		item->type = mcJSON_True;
-	}
-	return item;
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(mcJSON_True, &context);
+}
+mcJSON *mcJSON_CreateFalseWithContext(const mcJSON_Context * const context) {
+	return create_item(mcJSON_False, context);
 }
 mcJSON *mcJSON_CreateFalse(mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
-	if (item) {
-		item->type = mcJSON_False;
-	}
-	return item;
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(mcJSON_False, &context);
+}
+mcJSON *mcJSON_CreateBoolWithContext(const bool b, const mcJSON_Context * const context) {
+	return create_item(b ? mcJSON_True : mcJSON_False, context);
 }
 mcJSON *mcJSON_CreateBool(const bool b, mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(b ? mcJSON_True : mcJSON_False, &context);
+}
+mcJSON *mcJSON_CreateNumberWithContext(const double num, const mcJSON_Context * const context) {
+	mcJSON *item = create_item(mcJSON_Number, context);
 	if (item) {
-		item->type = b ? mcJSON_True : mcJSON_False;
+		item->valuedouble = num;
+		if (isfinite(num) && !isnan(num) && (num <= INT_MAX) && (num >= INT_MIN)) {
+			item->valueint = (int)num;
+		} else {
+			item->valueint = 0;
+		}
+		/* 2^63 is exact as double, INT64_MAX isn't */
+		if (isfinite(num) && (floor(num) == num) && (num >= -9223372036854775808.0) && (num < 9223372036854775808.0)) {
+			item->is_int64 = true;
+			item->valueint64 = (int64_t)num;
+		}
 	}
 	return item;
 }
 mcJSON *mcJSON_CreateNumber(const double num, mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateNumberWithContext(num, &context);
+}
+mcJSON *mcJSON_CreateInt64WithContext(const int64_t number, const mcJSON_Context * const context) {
+	mcJSON *item = create_item(mcJSON_Number, context);
 	if (item) {
-		item->type = mcJSON_Number;
-		item->valuedouble = num;
-		if (isfinite(num) && !isnan(num) && (num <= INT_MAX) && (num >= INT_MIN)) {
-			item->valueint = (int)num;
+		item->valuedouble = (double)number;
+		if ((number <= INT_MAX) && (number >= INT_MIN)) {
+			item->valueint = (int)number;
 		} else {
 			item->valueint = 0;
 		}
+		item->is_int64 = true;
+		item->valueint64 = number;
 	}
 	return item;
 }
-mcJSON *mcJSON_CreateString(const buffer_t * const string, mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
+mcJSON *mcJSON_CreateInt64(const int64_t number, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateInt64WithContext(number, &context);
+}
+mcJSON *mcJSON_CreateStringWithContext(const buffer_t * const string, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON *item = create_item(mcJSON_String, context);
 	if (item) {
-		item->type = mcJSON_String;
-		item->valuestring = parsebuffer_allocate(string->content_length, string->content_length, pool);
+		item->valuestring = parsebuffer_allocate(string->content_length, string->content_length, context);
 		int status = buffer_clone(item->valuestring, string);
 		if (status != 0) {
-			if (pool != NULL) {
-				mcJSON_Delete(item);
-			}
+			delete_detached(item, context);
 			return NULL;
 		}
 	}
 	return item;
 }
+mcJSON *mcJSON_CreateString(const buffer_t * const string, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateStringWithContext(string, &context);
+}
 
-mcJSON *mcJSON_CreateHexString(const buffer_t * const binary, mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
+mcJSON *mcJSON_CreateHexStringWithContext(const buffer_t * const binary, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
+	mcJSON *item = create_item(mcJSON_String, context);
 	if (item == NULL) {
 		return NULL;
 	}
 
-	item->type = mcJSON_String;
-	item->valuestring = parsebuffer_allocate(binary->content_length * 2 + 1, binary->content_length * 2 + 1, pool);
+	item->valuestring = parsebuffer_allocate(binary->content_length * 2 + 1, binary->content_length * 2 + 1, context);
 
 	if (buffer_clone_as_hex(item->valuestring, binary) != 0) {
-		if (pool == NULL) {
-			mcJSON_Delete(item);
-		}
+		delete_detached(item, context);
 		return NULL;
 	}
 
 	return item;
 }
 
+mcJSON *mcJSON_CreateHexString(const buffer_t * const binary, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateHexStringWithContext(binary, &context);
+}
+
+mcJSON *mcJSON_CreateArrayWithContext(const mcJSON_Context * const context) {
+	return create_item(mcJSON_Array, context);
+}
 mcJSON *mcJSON_CreateArray(mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
-	if (item) {
-		item->type = mcJSON_Array;
-	}
-	return item;
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(mcJSON_Array, &context);
+}
+mcJSON *mcJSON_CreateObjectWithContext(const mcJSON_Context * const context) {
+	return create_item(mcJSON_Object, context);
 }
 mcJSON *mcJSON_CreateObject(mempool_t * const pool) {
-	mcJSON *item = mcJSON_New_Item(pool);
-	if (item) {
-		item->type = mcJSON_Object;
-	}
-	return item;
+	const mcJSON_Context context = pool_context(pool);
+	return create_item(mcJSON_Object, &context);
 }
 
 /* Create Arrays: */
-mcJSON *mcJSON_CreateIntArray(const int * const numbers, const size_t count, mempool_t * const pool) {
-	mcJSON *array = mcJSON_CreateArray(pool);
+mcJSON *mcJSON_CreateIntArrayWithContext(const int * const numbers, const size_t count, const mcJSON_Context * const context) {
+	mcJSON *array = mcJSON_CreateArrayWithContext(context);
 	mcJSON *child = array->child;
 	for (size_t i = 0; i < count; i++) {
-		mcJSON *number = mcJSON_CreateNumber((double)numbers[i], pool);
-		insert_item(array, child, number, pool);
+		mcJSON *number = mcJSON_CreateNumberWithContext((double)numbers[i], context);
+		insert_item(array, child, number, NULL);
 	}
 
 	return array;
 }
 
-mcJSON *mcJSON_CreateDoubleArray(const double * const numbers, const size_t count, mempool_t * const pool) {
-	mcJSON *array = mcJSON_CreateArray(pool);
+mcJSON *mcJSON_CreateIntArray(const int * const numbers, const size_t count, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateIntArrayWithContext(numbers, count, &context);
+}
+
+mcJSON *mcJSON_CreateDoubleArrayWithContext(const double * const numbers, const size_t count, const mcJSON_Context * const context) {
+	mcJSON *array = mcJSON_CreateArrayWithContext(context);
 	mcJSON *child = array->child;
 	for (size_t i = 0; i < count; i++) {
-		mcJSON *number = mcJSON_CreateNumber(numbers[i], pool);
-		insert_item(array, child, number, pool);
+		mcJSON *number = mcJSON_CreateNumberWithContext(numbers[i], context);
+		insert_item(array, child, number, NULL);
 	}
 
 	return array;
 }
 
-mcJSON *mcJSON_CreateStringArray(const buffer_t **strings, const size_t count, mempool_t * const pool) {
-	mcJSON *array = mcJSON_CreateArray(pool);
+mcJSON *mcJSON_CreateDoubleArray(const double * const numbers, const size_t count, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateDoubleArrayWithContext(numbers, count, &context);
+}
+
+mcJSON *mcJSON_CreateStringArrayWithContext(const buffer_t **strings, const size_t count, const mcJSON_Context * const context) {
+	mcJSON *array = mcJSON_CreateArrayWithContext(context);
 	mcJSON *child = array->child;
 	for (size_t i = 0; i < count; i++) {
-		mcJSON *string = mcJSON_CreateString(strings[i], pool);
-		insert_item(array, child, string, pool);
+		mcJSON *string = mcJSON_CreateStringWithContext(strings[i], context);
+		insert_item(array, child, string, NULL);
 	}
 
 	return array;
 }
 
+mcJSON *mcJSON_CreateStringArray(const buffer_t **strings, const size_t count, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_CreateStringArrayWithContext(strings, count, &context);
+}
+
 /* Duplication */
-mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t * const pool) {
+/* Copy a string, borrowed strings are terminated properly in the copy. */
+static buffer_t *duplicate_string(const buffer_t * const string, const bool borrowed, const mcJSON_Context * const context) {
+	if (!borrowed) {
+		buffer_t *copy = parsebuffer_allocate(string->buffer_length, string->buffer_length, context);
+		if (copy == NULL) {
+			return NULL;
+		}
+		if (buffer_clone(copy, string) != 0) {
+			parsebuffer_deallocate(copy, context);
+			return NULL;
+		}
+		return copy;
+	}
+
+	buffer_t *copy = parsebuffer_allocate(string->content_length, string->content_length, context);
+	if ((copy == NULL) || (copy->content == NULL)) {
+		return NULL;
+	}
+	memcpy(copy->content, string->content, string->content_length - 1);
+	copy->content[string->content_length - 1] = '\0';
+
+	return copy;
+}
+
+mcJSON *mcJSON_DuplicateWithContext(const mcJSON * const item, const int recurse, const mcJSON_Context * context) {
+	mcJSON_Context default_context;
+	context = context_or_default(context, &default_context);
 	mcJSON *newitem;
 	mcJSON *cptr;
 	mcJSON *nptr = NULL;
@@ -1743,30 +5785,30 @@ mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t
 		return NULL;
 	}
 	/* Create new item */
-	newitem = mcJSON_New_Item(pool);
+	newitem = mcJSON_New_Item(context);
 	if (newitem == NULL) {
 		return NULL;
 	}
 	/* Copy over all vars */
 	newitem->type = item->type;
 	newitem->is_reference = false;
-	newitem->string_is_const = item->string_is_const;
+	newitem->string_is_const = false; /* the name is copied */
 	newitem->length = item->length;
 	newitem->valueint = item->valueint;
 	newitem->valuedouble = item->valuedouble;
+	newitem->is_int64 = item->is_int64;
+	newitem->valueint64 = item->valueint64;
 	if ((item->valuestring != NULL) && (item->valuestring->content != NULL)) {
-		newitem->valuestring = parsebuffer_allocate(item->valuestring->buffer_length, item->valuestring->buffer_length, pool);
-		int status = buffer_clone(newitem->valuestring, item->valuestring);
-		if (status != 0) {
-			mcJSON_Delete(newitem);
+		newitem->valuestring = duplicate_string(item->valuestring, item->valuestring_is_borrowed, context);
+		if (newitem->valuestring == NULL) {
+			delete_detached(newitem, context);
 			return NULL;
 		}
 	}
 	if ((item->name != NULL) && (item->name->content != NULL)) {
-		newitem->name = parsebuffer_allocate(item->name->buffer_length, item->name->buffer_length, pool);
-		int status = buffer_clone(newitem->name, item->name);
-		if (status != 0) {
-			mcJSON_Delete(newitem);
+		newitem->name = duplicate_string(item->name, item->name_is_borrowed, context);
+		if (newitem->name == NULL) {
+			delete_detached(newitem, context);
 			return NULL;
 		}
 	}
@@ -1777,9 +5819,9 @@ mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t
 	/* Walk the ->next chain for the child. */
 	cptr = item->child;
 	while (cptr) {
-		newchild = mcJSON_Duplicate(cptr, 1, pool); /* Duplicate (with recurse) each item in the ->next chain */
+		newchild = mcJSON_DuplicateWithContext(cptr, 1, context); /* Duplicate (with recurse) each item in the ->next chain */
 		if (newchild == NULL) {
-			mcJSON_Delete(newitem);
+			delete_detached(newitem, context);
 			return NULL;
 		}
 		if (nptr) { /* If newitem->child already set, then crosswire ->prev and ->next and move on */
@@ -1795,6 +5837,11 @@ mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t
 	return newitem;
 }
 
+mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t * const pool) {
+	const mcJSON_Context context = pool_context(pool);
+	return mcJSON_DuplicateWithContext(item, recurse, &context);
+}
+
 void mcJSON_Minify(buffer_t * const json) {
 	json->position = 0;
 	size_t write_position = json->position;
@@ -43,6 +43,8 @@
 #ifndef mcJSON__h
 #define mcJSON__h
 
+#include <stdint.h>
+
 #include "buffer/buffer.h"
 
 #ifdef __cplusplus
@@ -65,6 +67,35 @@ typedef enum mcJSON_Type {
  * chunk of memory that is used for parsing a json into it. */
 typedef buffer_t mempool_t;
 
+/* Create a mempool_t that never runs out of space. It starts with a block of
+ * block_size bytes and chains new blocks with growing sizes when it is full.
+ * Free it and everything that was allocated from it with mcJSON_ArenaDestroy. */
+extern mempool_t *mcJSON_ArenaCreate(const size_t block_size);
+extern void mcJSON_ArenaDestroy(mempool_t * const arena);
+/* Check if pool was created by one of the mcJSON_ArenaCreate functions. */
+extern bool mcJSON_PoolIsArena(const mempool_t * const pool);
+/* Create an arena that allocates its blocks like arena, so it can be merged into it.
+ * Returns NULL if arena isn't an arena. */
+extern mempool_t *mcJSON_ArenaCreateLike(const mempool_t * const arena, const size_t block_size);
+/* Move all blocks of source into arena and free source, everything that was allocated
+ * from source stays valid until arena is destroyed. Both have to allocate their blocks
+ * the same way, see mcJSON_ArenaCreateLike. New allocations continue in the current
+ * block of source. Markers of arena stay valid, rolling back to them frees the blocks of source. */
+extern void mcJSON_ArenaMerge(mempool_t * const arena, mempool_t * const source);
+
+/* Position in a mempool_t that it can be rolled back to. */
+typedef struct mcJSON_PoolMarker {
+	unsigned char *block;
+	size_t position;
+} mcJSON_PoolMarker;
+extern mcJSON_PoolMarker mcJSON_PoolMark(const mempool_t * const pool);
+/* Free everything that was allocated from pool after the marker was taken.
+ * If wipe is true, the freed memory is overwritten with zeroes. */
+extern void mcJSON_PoolRollback(mempool_t * const pool, const mcJSON_PoolMarker marker, const bool wipe);
+/* Free everything that was allocated from pool, arenas only keep their biggest block.
+ * This invalidates all markers. If wipe is true, the freed memory is overwritten with zeroes. */
+extern void mcJSON_PoolReset(mempool_t * const pool, const bool wipe);
+
 /* The mcJSON structure: */
 typedef struct mcJSON {
 	struct mcJSON *next, *prev; /* next/prev allow you to walk array/object chains. Alternatively, use GetArrayItem/GetObjectItem */
@@ -72,13 +103,17 @@ typedef struct mcJSON {
 	struct mcJSON *child; /* An array or object item will have a child pointer pointing to a chain of the items in the array/object. */
 
 	mcJSON_Type type; /* The type of the item, as above. */
-	/* bitfield with two boolean variables */
+	/* bitfield with five boolean variables */
 	bool is_reference : 1;
 	bool string_is_const : 1;
+	bool valuestring_is_borrowed : 1; /* valuestring points into the parsed input */
+	bool name_is_borrowed : 1; /* name points into the parsed input */
+	bool is_int64 : 1; /* valueint64 contains the exact number */
 
 	buffer_t * valuestring; /* The item's string, if type==mcJSON_String */
 	int valueint; /* The item's number, if type==mcJSON_Number */
 	double valuedouble; /* The item's number, if type==mcJSON_Number */
+	int64_t valueint64; /* The item's number, if type==mcJSON_Number and is_int64 */
 
 	buffer_t * name; /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
 } mcJSON;
@@ -91,6 +126,63 @@ typedef struct mcJSON_Hooks {
 /* Supply malloc, realloc and free functions to mcJSON */
 extern void mcJSON_InitHooks(const mcJSON_Hooks * const hooks);
 
+/* Returns a name that is equal to the length bytes of name, or NULL if it isn't known.
+ * The returned name is shared by many trees and must not be changed, it has
+ * a terminating '\0' that is counted in content_length. */
+typedef buffer_t *(*mcJSON_NameResolver)(void * const userdata, const unsigned char * const name, const size_t length);
+
+/* Options for mcJSON_ParseWithOptions, NULL means all options are false. */
+typedef struct mcJSON_ParseOptions {
+	/* Strings and names without escape sequences point directly into
+	 * the input instead of being copied. The input has to outlive the tree.
+	 * Because the closing '"' takes the place of the terminating '\0',
+	 * these strings can't be used as C strings (e.g. by mcJSON_Utils). */
+	bool borrow_strings;
+	/* Strings and names are unescaped inside the input and point there.
+	 * This destroys the input, which has to outlive the tree. Other than
+	 * with borrow_strings, the strings are '\0' terminated. */
+	bool in_situ;
+	/* Maximum nesting of arrays and objects, deeper json fails to parse.
+	 * 0 means no limit. Neither parsing nor mcJSON_Delete recurse, so deep json
+	 * only costs memory, but printing and mcJSON_Duplicate still recurse. */
+	size_t max_depth;
+	/* Fail if a string or name isn't valid UTF-8 (overlong forms, surrogates and
+	 * code points above U+10FFFF are invalid as well). Other than that, the bytes
+	 * of strings are copied without checking them. */
+	bool validate_utf8;
+	/* Members of objects with equal names share one name in the pool instead of
+	 * each having a copy, these names are marked with string_is_const. This only
+	 * works when parsing into a pool and saves memory if keys repeat, e.g. in an
+	 * array of records. Interning is per document. */
+	bool intern_names;
+	/* Names of object members that resolve_name knows aren't allocated, the item
+	 * points to the returned name and is marked with string_is_const. The names
+	 * have to outlive the tree. Names without escape sequences are resolved straight
+	 * from the input. See mcJSON_KeyDictionary in mcJSON_Dictionary.h.
+	 * NULL doesn't resolve names. */
+	mcJSON_NameResolver resolve_name;
+	void *resolver_data; /* passed to resolve_name */
+} mcJSON_ParseOptions;
+
+/* Per instance configuration. Other than the hooks from mcJSON_InitHooks, a context
+ * only affects the calls it is passed to, so every thread can use its own allocator.
+ * Initialize it with mcJSON_ContextInit and change what you need. */
+typedef struct mcJSON_Context {
+	void *(*malloc_fn)(void * const userdata, const size_t size);
+	/* can be NULL, then memory is moved with malloc_fn and free_fn */
+	void *(*realloc_fn)(void * const userdata, void * const pointer, const size_t size);
+	void (*free_fn)(void * const userdata, void * const pointer);
+	void *userdata; /* passed to the allocator functions */
+	mempool_t *pool; /* parse into this pool, NULL allocates every item with malloc_fn */
+	const mcJSON_ParseOptions *options; /* NULL means all options are false */
+	size_t max_length; /* length of the longest json that is parsed, 0 means no limit */
+} mcJSON_Context;
+/* The default context, it uses the hooks from mcJSON_InitHooks, no pool and no limits.
+ * All functions that don't take a context behave as if they got this one. */
+extern void mcJSON_ContextInit(mcJSON_Context * const context);
+/* Like mcJSON_ArenaCreate, but the blocks are allocated with the allocator of context. */
+extern mempool_t *mcJSON_ArenaCreateWithContext(const size_t block_size, const mcJSON_Context * const context);
+
 
 /* Supply a block of JSON, and this returns a mcJSON object you can interrogate. Call mcJSON_Delete when finished. */
 extern mcJSON *mcJSON_Parse(buffer_t * const json);
@@ -98,17 +190,189 @@ extern mcJSON *mcJSON_Parse(buffer_t * const json);
  * This supports buffered parsing, a big chunk of memory
  * is allocated once and the json tree is parsed into it.
  * The size needs to be large enough otherwise allocation
- * will fail at some point. */
+ * will fail at some point. If parsing fails, the pool is
+ * wiped and rolled back to where it was before. */
 extern mcJSON *mcJSON_ParseWithBuffer(buffer_t * const json, mempool_t * const pool);
+/* Like mcJSON_ParseWithBuffer, but with options, see mcJSON_ParseOptions. */
+extern mcJSON *mcJSON_ParseWithOptions(buffer_t * const json, mempool_t * const pool, const mcJSON_ParseOptions * const options);
+/* Parse with the pool, options and limits of context. Trees that aren't in a pool
+ * have to be deleted with mcJSON_DeleteWithContext and the same context. */
+extern mcJSON *mcJSON_ParseWithContext(buffer_t * const json, const mcJSON_Context * const context);
+/* Like mcJSON_ParseWithBuffer, but strings are unescaped inside json without
+ * allocating any string storage. json gets destroyed and has to outlive the tree. */
+extern mcJSON *mcJSON_ParseInSitu(buffer_t * const json, mempool_t * const pool);
 extern mcJSON *mcJSON_ParseBuffered(buffer_t *const json, const size_t bufer_length);
+/* Like mcJSON_ParseBuffered, but with the options and limits of context, the buffer
+ * is allocated with its allocator (the pool of context is ignored). Free the tree
+ * with the free_fn of context. */
+extern mcJSON *mcJSON_ParseBufferedWithContext(buffer_t * const json, const size_t buffer_length, const mcJSON_Context * const context);
+/* Size of the mempool_t that mcJSON_ParseWithBuffer needs for json, without parsing it.
+ * This is exact for valid json if the content of the pool is aligned like memory
+ * returned by malloc. Returns 0 if json is obviously invalid. */
+extern size_t mcJSON_ParseBufferSize(const buffer_t * const json);
+/* Like mcJSON_ParseBuffered, but with a buffer of exactly the right size. */
+extern mcJSON *mcJSON_ParseBufferedExact(buffer_t * const json);
+/* Like mcJSON_ParseWithBuffer, but json has to contain exactly one value
+ * and be terminated by '\0'. pool can be NULL. */
+extern mcJSON *mcJSON_ParseRecord(buffer_t * const json, mempool_t * const pool);
+/* Called by mcJSON_ParseLines for every record, json is NULL if it couldn't be parsed.
+ * offset and length describe the line in the input. json lives in a pool that
+ * is reset for the next record, so it is only valid until the callback returns
+ * and must not be deleted. Return false to stop. */
+typedef bool (*mcJSON_LineCallback)(void * const userdata, mcJSON * const json, const size_t offset, const size_t length);
+/* Parse newline delimited json (JSON Lines), every non empty line has to contain one value.
+ * All records are parsed into the same arena with blocks of pool_size bytes, it grows if
+ * a record doesn't fit. Invalid records (or ones that memory allocation failed for) are
+ * passed to the callback as NULL. Returns false if the callback stopped or the arena or
+ * the copy of a line couldn't be allocated. */
+extern bool mcJSON_ParseLines(const buffer_t * const lines, const size_t pool_size, const mcJSON_LineCallback callback, void * const userdata);
+/* Parse in two stages: First create an index of all structural characters
+ * (using SSE2/AVX2 if the CPU supports it), then build the tree from this index.
+ * Creates the same tree as mcJSON_ParseWithBuffer, pool can be NULL. */
+extern mcJSON *mcJSON_ParseIndexed(buffer_t * const json, mempool_t * const pool);
+/* Like mcJSON_ParseIndexed, but with the pool, options and limits of context,
+ * like mcJSON_ParseWithContext. The index is allocated with the allocator of context. */
+extern mcJSON *mcJSON_ParseIndexedWithContext(buffer_t * const json, const mcJSON_Context * const context);
+/* Maximum nesting depth that mcJSON_Validate supports. */
+#define mcJSON_VALIDATE_MAX_DEPTH 4096
+/* Check if json is valid according to RFC 8259 (including strict UTF-8)
+ * without building a tree and without allocating memory.
+ * Arrays and objects may be nested up to max_depth levels, 0 means
+ * mcJSON_VALIDATE_MAX_DEPTH, which is also the upper limit.
+ * If the json is invalid and error_offset isn't NULL, it is set to the
+ * offset of the first byte that doesn't fit. */
+extern bool mcJSON_Validate(const buffer_t * const json, size_t max_depth, size_t * const error_offset);
+/* Event based parsing (SAX), no tree is built. Every callback can be NULL and
+ * returns false to stop parsing. Strings are only valid during the callback.
+ * Like all strings, their content_length includes the terminating '\0', but strings
+ * without escape sequences point directly into the input and have the closing '"'
+ * in its place instead. integer is NULL unless the number is an integer that fits into 64 bit. */
+typedef struct mcJSON_SAXCallbacks {
+	bool (*start_object)(void * const userdata);
+	bool (*end_object)(void * const userdata);
+	bool (*start_array)(void * const userdata);
+	bool (*end_array)(void * const userdata);
+	bool (*key)(void * const userdata, const buffer_t * const key);
+	bool (*string)(void * const userdata, const buffer_t * const string);
+	bool (*number)(void * const userdata, const double number, const int64_t * const integer);
+	bool (*boolean)(void * const userdata, const bool value);
+	bool (*null)(void * const userdata);
+} mcJSON_SAXCallbacks;
+/* Parse json and report it to the callbacks, returns false if the json was invalid. */
+extern bool mcJSON_ParseSAX(const buffer_t * const json, const mcJSON_SAXCallbacks * const callbacks, void * const userdata);
+/* Incremental event based parsing, works like mcJSON_Parser. */
+typedef struct mcJSON_SAXParser mcJSON_SAXParser;
+extern mcJSON_SAXParser *mcJSON_SAXParserCreate(const mcJSON_SAXCallbacks * const callbacks, void * const userdata);
+extern bool mcJSON_SAXParserFeed(mcJSON_SAXParser * const parser, const buffer_t * const chunk);
+/* Finish parsing and destroy the parser. Returns false if the json was invalid or incomplete. */
+extern bool mcJSON_SAXParserFinish(mcJSON_SAXParser * const parser);
+
+/* Incremental parsing, the json can be fed in chunks of arbitrary size.
+ * The parser keeps its state between chunks, even inside of strings and numbers. */
+typedef struct mcJSON_Parser mcJSON_Parser;
+/* Create a parser, the tree is parsed into pool, if it isn't NULL. */
+extern mcJSON_Parser *mcJSON_ParserCreate(mempool_t * const pool);
+/* Like mcJSON_ParserCreate, but the parser and the tree are allocated with the allocator
+ * and the pool of context. Trees that aren't in a pool have to be deleted with
+ * mcJSON_DeleteWithContext and the same context. */
+extern mcJSON_Parser *mcJSON_ParserCreateWithContext(const mcJSON_Context * const context);
+/* Parse the next chunk of json, returns false on error. */
+extern bool mcJSON_ParserFeed(mcJSON_Parser * const parser, const buffer_t * const chunk);
+/* Finish parsing and destroy the parser. Returns the tree, or NULL if the json
+ * was invalid or incomplete. On failure, pool is rolled back like in mcJSON_ParseWithBuffer. */
+extern mcJSON *mcJSON_ParserFinish(mcJSON_Parser * const parser);
+/* Immutable tree for reading, 16 bytes per value plus the strings, all in a single
+ * allocation. Values are referred to by their index in the tape, the root is 0.
+ * The values follow each other in the order of the json text. */
+typedef struct mcJSON_Tape mcJSON_Tape;
+/* Index that refers to no value. */
+#define mcJSON_TAPE_NONE SIZE_MAX
+/* Parse json into a tape, json doesn't need to be terminated by '\0'.
+ * Returns NULL if it is invalid or too big (more than 4 GiB of strings or
+ * 2^32 values). Call mcJSON_TapeDelete when finished. */
+extern mcJSON_Tape *mcJSON_ParseTape(const buffer_t * const json);
+/* Like mcJSON_ParseTape, but the tape and all temporary memory are allocated with the
+ * allocator of context and max_length applies, the pool and options are ignored.
+ * Delete the tape with mcJSON_TapeDeleteWithContext and the same context. */
+extern mcJSON_Tape *mcJSON_ParseTapeWithContext(const buffer_t * const json, const mcJSON_Context * const context);
+extern void mcJSON_TapeDelete(mcJSON_Tape * const tape);
+extern void mcJSON_TapeDeleteWithContext(mcJSON_Tape * const tape, const mcJSON_Context * const context);
+/* Number of bytes that the tape occupies. */
+extern size_t mcJSON_TapeSize(const mcJSON_Tape * const tape);
+/* Type of a value, 0 if there is no such value. */
+extern mcJSON_Type mcJSON_TapeType(const mcJSON_Tape * const tape, const size_t value);
+/* Number of values in an array or object, 0 for everything else. */
+extern size_t mcJSON_TapeLength(const mcJSON_Tape * const tape, const size_t value);
+/* First value in an array or object, mcJSON_TAPE_NONE if it is empty. */
+extern size_t mcJSON_TapeChild(const mcJSON_Tape * const tape, const size_t value);
+/* Value after value in the same array or object, mcJSON_TAPE_NONE if it was the last one. */
+extern size_t mcJSON_TapeNext(const mcJSON_Tape * const tape, const size_t value);
+/* Like mcJSON_GetArrayItem and mcJSON_GetObjectItem, return mcJSON_TAPE_NONE if there is no such value. */
+extern size_t mcJSON_TapeGetArrayItem(const mcJSON_Tape * const tape, const size_t array, size_t index);
+extern size_t mcJSON_TapeGetObjectItem(const mcJSON_Tape * const tape, const size_t object, const buffer_t * const name);
+/* Read a value, these return false if it has the wrong type. Strings and names are
+ * pointed to inside the tape without copying, they are '\0' terminated. */
+extern bool mcJSON_TapeGetName(const mcJSON_Tape * const tape, const size_t value, buffer_t * const name);
+extern bool mcJSON_TapeGetDouble(const mcJSON_Tape * const tape, const size_t value, double * const number);
+extern bool mcJSON_TapeGetInt64(const mcJSON_Tape * const tape, const size_t value, int64_t * const number);
+extern bool mcJSON_TapeGetBool(const mcJSON_Tape * const tape, const size_t value, bool * const boolean);
+extern bool mcJSON_TapeGetString(const mcJSON_Tape * const tape, const size_t value, buffer_t * const string);
+/* Forward only cursor over json text. Only the values that are asked for
+ * are parsed, everything else is skipped by matching brackets without
+ * checking if it is valid. json has to outlive the cursor. */
+typedef struct mcJSON_Cursor {
+	const buffer_t *json;
+	size_t position; /* start of the current value or end of the current array/object */
+	size_t key; /* opening '"' of the current value's name, if has_key */
+	size_t depth;
+	bool has_key;
+} mcJSON_Cursor;
+/* Point the cursor at the root value, returns false if there is none. */
+extern bool mcJSON_CursorInit(mcJSON_Cursor * const cursor, const buffer_t * const json);
+/* Type of the current value, 0 at the end of an array or object. */
+extern mcJSON_Type mcJSON_CursorType(const mcJSON_Cursor * const cursor);
+/* Move to the first value inside the current array or object.
+ * Returns false if it is empty (the cursor is at its end then) or if
+ * the current value is no array or object (the cursor doesn't move then). */
+extern bool mcJSON_CursorEnter(mcJSON_Cursor * const cursor);
+/* Move to the next value in the current array or object, false at the end. */
+extern bool mcJSON_CursorNext(mcJSON_Cursor * const cursor);
+/* Skip the rest of the current array or object and move to the value after it, false if there is none. */
+extern bool mcJSON_CursorLeave(mcJSON_Cursor * const cursor);
+/* Move forward to the member with the given name in the current object, false if there is none. */
+extern bool mcJSON_CursorFindField(mcJSON_Cursor * const cursor, const buffer_t * const name);
+/* Read the current value, these return false if it has the wrong type. */
+extern bool mcJSON_CursorGetDouble(const mcJSON_Cursor * const cursor, double * const value);
+extern bool mcJSON_CursorGetInt64(const mcJSON_Cursor * const cursor, int64_t * const value);
+extern bool mcJSON_CursorGetBool(const mcJSON_Cursor * const cursor, bool * const value);
+/* Point string at the current string inside of json without copying. The closing '"' takes the place
+ * of the terminating '\0'. Fails for strings with escape sequences, use mcJSON_CursorGetValue for those. */
+extern bool mcJSON_CursorGetString(const mcJSON_Cursor * const cursor, buffer_t * const string);
+/* Parse the current value into a tree, pool can be NULL. Like mcJSON_Parse, this needs json to be terminated by '\0'. */
+extern mcJSON *mcJSON_CursorGetValue(const mcJSON_Cursor * const cursor, mempool_t * const pool);
+/* Like mcJSON_CursorGetValue, but also move to the next value like mcJSON_CursorNext.
+ * Fails if the parsed value isn't followed by ',' or the end of the current array or
+ * object (or by the end of json for the root value), e.g. for "[1x]" or "[truefalse]". */
+extern mcJSON *mcJSON_CursorTakeValue(mcJSON_Cursor * const cursor, mempool_t * const pool);
+/* Parse only the values that the JSON Pointers (RFC 6901) point to and the arrays and objects
+ * on the way to them, so mcJSONUtils_GetPointer finds them in the tree. Everything else is skipped
+ * by matching brackets without checking if it is valid. Skipped array elements before a needed one
+ * are replaced by null to keep the indices. With no pointers, the root has no children.
+ * pool can be NULL, on failure it is rolled back like in mcJSON_ParseWithBuffer. */
+extern mcJSON *mcJSON_ParseProjected(buffer_t * const json, const char * const * const pointers, const size_t pointer_count, mempool_t * const pool);
 /* Render a mcJSON entity to text for transfer/storage. Free the char* when finished. */
 extern buffer_t *mcJSON_Print(mcJSON * const item);
 /* Render a mcJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
 extern buffer_t *mcJSON_PrintUnformatted(mcJSON * const item);
 /* Render a mcJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. format = false gives unformatted, = true gives formatted */
 extern buffer_t *mcJSON_PrintBuffered(mcJSON * const item, const size_t prebuffer, const bool format);
+/* Like mcJSON_PrintBuffered, but memory is allocated with the allocator of context.
+ * Free the result and its content with the free_fn of context. */
+extern buffer_t *mcJSON_PrintWithContext(mcJSON * const item, const bool format, const mcJSON_Context * const context);
 /* Delete a mcJSON entity and all subentities. */
 extern void mcJSON_Delete(mcJSON * const c);
+/* Delete a tree that was allocated with the allocator of context. */
+extern void mcJSON_DeleteWithContext(mcJSON * const item, const mcJSON_Context * const context);
 
 /* Retrieve item number "item" from array "array". Returns NULL if unsuccessful. */
 extern mcJSON *mcJSON_GetArrayItem(const mcJSON *const array, size_t index);
@@ -116,6 +380,10 @@ extern mcJSON *mcJSON_GetArrayItem(const mcJSON *const array, size_t index);
 extern mcJSON *mcJSON_GetObjectItem(const mcJSON * const object, const buffer_t * const string);
 /* check if a given Number is an Integer */
 extern bool mcJSON_IsInteger(const mcJSON * const number);
+/* check if a given Number is an integer that fits into 64 bit */
+extern bool mcJSON_IsInt64(const mcJSON * const number);
+/* get a Number as 64 bit integer, exact if mcJSON_IsInt64, 0 if it doesn't fit */
+extern int64_t mcJSON_GetInt64(const mcJSON * const number);
 /* check if a given json object is a boolean */
 extern bool mcJSON_IsBoolean(const mcJSON * const json);
 
@@ -125,15 +393,31 @@ extern mcJSON *mcJSON_CreateTrue(mempool_t *pool);
 extern mcJSON *mcJSON_CreateFalse(mempool_t *pool);
 extern mcJSON *mcJSON_CreateBool(const bool b, mempool_t *pool);
 extern mcJSON *mcJSON_CreateNumber(const double num, mempool_t *pool);
+extern mcJSON *mcJSON_CreateInt64(const int64_t number, mempool_t *pool);
 extern mcJSON *mcJSON_CreateString(const buffer_t * const string, mempool_t *pool);
 extern mcJSON *mcJSON_CreateHexString(const buffer_t * const binary, mempool_t *pool); /* create a hex string from binary input */
 extern mcJSON *mcJSON_CreateArray(mempool_t *pool);
 extern mcJSON *mcJSON_CreateObject(mempool_t *pool);
+/* Like the functions above, but with the allocator or in the pool of context. Trees that
+ * are built with a context have to be changed and deleted with the same context. */
+extern mcJSON *mcJSON_CreateNullWithContext(const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateTrueWithContext(const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateFalseWithContext(const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateBoolWithContext(const bool b, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateNumberWithContext(const double num, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateInt64WithContext(const int64_t number, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateStringWithContext(const buffer_t * const string, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateHexStringWithContext(const buffer_t * const binary, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateArrayWithContext(const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateObjectWithContext(const mcJSON_Context * const context);
 
 /* These utilities create an Array of count items. */
 extern mcJSON *mcJSON_CreateIntArray(const int *numbers, const size_t count, mempool_t * const pool);
 extern mcJSON *mcJSON_CreateDoubleArray(const double *numbers, const size_t count, mempool_t * const pool);
 extern mcJSON *mcJSON_CreateStringArray(const buffer_t **strings, const size_t count, mempool_t * const pool);
+extern mcJSON *mcJSON_CreateIntArrayWithContext(const int *numbers, const size_t count, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateDoubleArrayWithContext(const double *numbers, const size_t count, const mcJSON_Context * const context);
+extern mcJSON *mcJSON_CreateStringArrayWithContext(const buffer_t **strings, const size_t count, const mcJSON_Context * const context);
 
 /* Append item to the specified array/object. */
 extern void mcJSON_AddItemToArray(mcJSON * const array, mcJSON * const item, mempool_t *pool);
@@ -142,23 +426,36 @@ extern void mcJSON_AddItemToObjectCS(mcJSON * const object, const buffer_t * con
 /* Append reference to item to the specified array/object. Use this when you want to add an existing mcJSON to a new mcJSON, but don't want to corrupt your existing mcJSON. */
 extern void mcJSON_AddItemReferenceToArray(mcJSON * const array, const mcJSON * const item, mempool_t * const pool);
 extern void mcJSON_AddItemReferenceToObject(mcJSON * const object, const buffer_t * const string, const mcJSON * const item, mempool_t * const pool);
+/* The names and references are allocated with the allocator or in the pool of context. */
+extern void mcJSON_AddItemToObjectWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const item, const mcJSON_Context * const context);
+extern void mcJSON_AddItemToObjectCSWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const item, const mcJSON_Context * const context);
+extern void mcJSON_AddItemReferenceToArrayWithContext(mcJSON * const array, const mcJSON * const item, const mcJSON_Context * const context);
+extern void mcJSON_AddItemReferenceToObjectWithContext(mcJSON * const object, const buffer_t * const string, const mcJSON * const item, const mcJSON_Context * const context);
 
 /* Remove/Detatch items from Arrays/Objects. */
 extern mcJSON *mcJSON_DetachItemFromArray(mcJSON * const array, const size_t index);
 extern void mcJSON_DeleteItemFromArray(mcJSON *const array, const size_t index);
 extern mcJSON *mcJSON_DetachItemFromObject(mcJSON * const object, const buffer_t * const string);
 extern void mcJSON_DeleteItemFromObject(mcJSON * const object, const buffer_t * const string);
+/* Delete with the allocator of context, items in the pool of context are only detached. */
+extern void mcJSON_DeleteItemFromArrayWithContext(mcJSON *const array, const size_t index, const mcJSON_Context * const context);
+extern void mcJSON_DeleteItemFromObjectWithContext(mcJSON * const object, const buffer_t * const string, const mcJSON_Context * const context);
 
 /* Update array items. */
 extern void mcJSON_InsertItemInArray(mcJSON * const array, const size_t index, mcJSON * const newitem, mempool_t * const pool);	/* Shifts pre-existing items to the right. */
 extern void mcJSON_ReplaceItemInArray(mcJSON * const array, const size_t index, mcJSON * const newitem, mempool_t * const pool);
 extern void mcJSON_ReplaceItemInObject(mcJSON * const object, const buffer_t * const string, mcJSON * const newitem, mempool_t * const pool);
+/* The replaced item is deleted like in mcJSON_DeleteItemFromArrayWithContext. */
+extern void mcJSON_ReplaceItemInArrayWithContext(mcJSON * const array, const size_t index, mcJSON * const newitem, const mcJSON_Context * const context);
+extern void mcJSON_ReplaceItemInObjectWithContext(mcJSON * const object, const buffer_t * const string, mcJSON * const newitem, const mcJSON_Context * const context);
 
 /* Duplicate a mcJSON item */
 extern mcJSON *mcJSON_Duplicate(const mcJSON * const item, const int recurse, mempool_t * const pool);
 /* Duplicate will create a new, identical mcJSON item to the one you pass, in new memory that will
 need to be released. With recurse!=0, it will duplicate any children connected to the item.
 The item->next and ->prev pointers are always zero on return from Duplicate. */
+/* Like mcJSON_Duplicate, but with the allocator or in the pool of context. */
+extern mcJSON *mcJSON_DuplicateWithContext(const mcJSON * const item, const int recurse, const mcJSON_Context * const context);
 
 extern void mcJSON_Minify(buffer_t * const json);
 
@@ -170,9 +467,9 @@ extern void mcJSON_Minify(buffer_t * const json);
 #define mcJSON_AddNumberToObject(object, name, n, pool) mcJSON_AddItemToObject(object, name, mcJSON_CreateNumber(n, pool), pool)
 #define mcJSON_AddStringToObject(object, name, s, pool) mcJSON_AddItemToObject(object, name, mcJSON_CreateString(s, pool), pool)
 
-/* When assigning an integer value, it needs to be propagated to valuedouble too. */
-#define mcJSON_SetIntValue(object,val)			((object)?(object)->valueint=(object)->valuedouble=(val):(val))
-#define mcJSON_SetNumberValue(object,val)		((object)?(object)->valueint=(object)->valuedouble=(val):(val))
+/* When assigning an integer value, it needs to be propagated to valuedouble and valueint64 too. */
+#define mcJSON_SetIntValue(object,val)			((object)?((object)->is_int64=true,(object)->valueint64=(int64_t)(val),(object)->valueint=(object)->valuedouble=(val)):(val))
+#define mcJSON_SetNumberValue(object,val)		((object)?((object)->is_int64=false,(object)->valueint=(object)->valuedouble=(val)):(val))
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,162 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "mcJSON_Dictionary.h"
+
+/* Open addressing with linear probing. The size is fixed when the dictionary is
+ * created so that it is never more than half full, names are never moved or removed. */
+struct mcJSON_KeyDictionary {
+	pthread_rwlock_t lock;
+	buffer_t **names;
+	size_t size; /* power of 2 */
+	size_t count;
+	size_t limit;
+};
+
+/* FNV-1a */
+static size_t dictionary_hash(const unsigned char * const name, const size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= name[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/* Slot of the equal name, or the empty one where it belongs. The lock has to be held. */
+static buffer_t **dictionary_find(const mcJSON_KeyDictionary * const dictionary, const unsigned char * const name, const size_t length) {
+	size_t index = dictionary_hash(name, length) & (dictionary->size - 1);
+	while (dictionary->names[index] != NULL) {
+		const buffer_t * const known = dictionary->names[index];
+		if (((known->content_length - 1) == length) && (memcmp(known->content, name, length) == 0)) {
+			break;
+		}
+		index = (index + 1) & (dictionary->size - 1);
+	}
+
+	return &dictionary->names[index];
+}
+
+/* Look the name up with the lock held for writing and add it if it is
+ * still unknown. Known names are resolved with the lock held for reading. */
+static buffer_t *dictionary_learn(mcJSON_KeyDictionary * const dictionary, const unsigned char * const name, const size_t length) {
+	pthread_rwlock_wrlock(&dictionary->lock);
+	buffer_t ** const slot = dictionary_find(dictionary, name, length);
+	if ((*slot == NULL) && (dictionary->count < dictionary->limit)) {
+		buffer_t * const copy = buffer_create_on_heap(length + 1, length + 1);
+		if (copy != NULL) {
+			memcpy(copy->content, name, length);
+			copy->content[length] = '\0';
+			*slot = copy;
+			dictionary->count++;
+		}
+	}
+	buffer_t * const result = *slot;
+	pthread_rwlock_unlock(&dictionary->lock);
+
+	return result;
+}
+
+mcJSON_KeyDictionary *mcJSON_KeyDictionaryCreate(const size_t limit) {
+	if ((limit == 0) || (limit > (SIZE_MAX / sizeof(buffer_t*) / 4))) {
+		return NULL;
+	}
+
+	mcJSON_KeyDictionary *dictionary = (mcJSON_KeyDictionary*)malloc(sizeof(mcJSON_KeyDictionary));
+	if (dictionary == NULL) {
+		return NULL;
+	}
+	dictionary->size = 1;
+	while (dictionary->size < (2 * limit)) {
+		dictionary->size *= 2;
+	}
+	dictionary->count = 0;
+	dictionary->limit = limit;
+	dictionary->names = (buffer_t**)calloc(dictionary->size, sizeof(buffer_t*));
+	if (dictionary->names == NULL) {
+		free(dictionary);
+		return NULL;
+	}
+	if (pthread_rwlock_init(&dictionary->lock, NULL) != 0) {
+		free(dictionary->names);
+		free(dictionary);
+		return NULL;
+	}
+
+	return dictionary;
+}
+
+void mcJSON_KeyDictionaryDestroy(mcJSON_KeyDictionary * const dictionary) {
+	if (dictionary == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < dictionary->size; i++) {
+		if (dictionary->names[i] != NULL) {
+			buffer_destroy_from_heap(dictionary->names[i]);
+		}
+	}
+	pthread_rwlock_destroy(&dictionary->lock);
+	free(dictionary->names);
+	free(dictionary);
+}
+
+void mcJSON_KeyDictionaryAttach(mcJSON_KeyDictionary * const dictionary, mcJSON_ParseOptions * const options) {
+	options->resolve_name = mcJSON_KeyDictionaryResolve;
+	options->resolver_data = dictionary;
+}
+
+buffer_t *mcJSON_KeyDictionaryAdd(mcJSON_KeyDictionary * const dictionary, const buffer_t * const name) {
+	if ((name == NULL) || (name->content == NULL) || (name->content_length == 0)) {
+		return NULL;
+	}
+
+	return dictionary_learn(dictionary, name->content, name->content_length - 1);
+}
+
+buffer_t *mcJSON_KeyDictionaryResolve(void * const userdata, const unsigned char * const name, const size_t length) {
+	mcJSON_KeyDictionary * const dictionary = (mcJSON_KeyDictionary*)userdata;
+
+	pthread_rwlock_rdlock(&dictionary->lock);
+	buffer_t * const known = *dictionary_find(dictionary, name, length);
+	const bool full = (dictionary->count >= dictionary->limit);
+	pthread_rwlock_unlock(&dictionary->lock);
+	if ((known != NULL) || full) {
+		return known;
+	}
+
+	/* another thread might have learned the name in the meantime */
+	return dictionary_learn(dictionary, name, length);
+}
+
+size_t mcJSON_KeyDictionaryCount(mcJSON_KeyDictionary * const dictionary) {
+	pthread_rwlock_rdlock(&dictionary->lock);
+	const size_t count = dictionary->count;
+	pthread_rwlock_unlock(&dictionary->lock);
+
+	return count;
+}
@@ -0,0 +1,57 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "mcJSON.h"
+
+#ifndef mcJSON_DICTIONARY__H
+#define mcJSON_DICTIONARY__H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Names of object members that are shared by every document parsed with it,
+ * so that documents with the same keys (e.g. records of a stream) don't allocate
+ * their names. Unknown names are learned until the dictionary holds limit names,
+ * after that only known names are resolved. The dictionary can be used by many
+ * threads at the same time, the trees point to its names, so it has to outlive them. */
+typedef struct mcJSON_KeyDictionary mcJSON_KeyDictionary;
+
+/* Create an empty dictionary for at most limit names, limit can't be 0. */
+mcJSON_KeyDictionary *mcJSON_KeyDictionaryCreate(const size_t limit);
+/* Destroy dictionary, trees that were parsed with it mustn't be used anymore. */
+void mcJSON_KeyDictionaryDestroy(mcJSON_KeyDictionary * const dictionary);
+/* Let parses with options resolve names with dictionary. */
+void mcJSON_KeyDictionaryAttach(mcJSON_KeyDictionary * const dictionary, mcJSON_ParseOptions * const options);
+
+/* Add the '\0' terminated name, e.g. to know the keys of a schema in advance.
+ * Returns the name of dictionary, or NULL if it is full or memory allocation failed. */
+buffer_t *mcJSON_KeyDictionaryAdd(mcJSON_KeyDictionary * const dictionary, const buffer_t * const name);
+/* The mcJSON_NameResolver of a dictionary, dictionary is the userdata. Learns the
+ * name if it isn't known and the dictionary isn't full. */
+buffer_t *mcJSON_KeyDictionaryResolve(void * const dictionary, const unsigned char * const name, const size_t length);
+/* Number of names in dictionary. */
+size_t mcJSON_KeyDictionaryCount(mcJSON_KeyDictionary * const dictionary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
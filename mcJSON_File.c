@@ -0,0 +1,199 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE /* MAP_ANONYMOUS */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mcJSON_File.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+struct mcJSON_File {
+	unsigned char *content;
+	size_t length; /* including the terminating '\0' */
+	size_t mapping_length; /* 0 if the file was read */
+};
+
+/* Read the file into memory, this is only used if it can't be mapped. */
+static bool file_read(mcJSON_File * const file, const int descriptor, const size_t size) {
+	file->content = (unsigned char*)malloc(size + 1);
+	if (file->content == NULL) {
+		return false;
+	}
+
+	size_t position = 0;
+	while (position < size) {
+		const ssize_t result = read(descriptor, file->content + position, size - position);
+		if ((result == -1) && (errno == EINTR)) {
+			continue;
+		}
+		if (result <= 0) {
+			free(file->content);
+			file->content = NULL;
+			return false;
+		}
+		position += (size_t)result;
+	}
+	file->content[size] = '\0';
+	file->length = size + 1;
+	file->mapping_length = 0;
+
+	return true;
+}
+
+/* Map the file into memory, the '\0' after it comes from the zeroes that fill
+ * the rest of the last page. If the file ends exactly at the end of a page, an
+ * anonymous mapping that is one page longer than the file is reserved first and
+ * the file is mapped over its front, so the '\0' comes from the page after it. */
+static bool file_map(mcJSON_File * const file, const int descriptor, const size_t size, const size_t page_size) {
+	if ((size % page_size) != 0) {
+		void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapping == MAP_FAILED) {
+			return false;
+		}
+		file->content = (unsigned char*)mapping;
+		file->mapping_length = size;
+	} else {
+#ifdef MAP_ANONYMOUS
+		if (size > (SIZE_MAX - page_size)) {
+			return false;
+		}
+		void *reserved = mmap(NULL, size + page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (reserved == MAP_FAILED) {
+			return false;
+		}
+		if (mmap(reserved, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, descriptor, 0) == MAP_FAILED) {
+			munmap(reserved, size + page_size);
+			return false;
+		}
+		file->content = (unsigned char*)reserved;
+		file->mapping_length = size + page_size;
+#else
+		return false;
+#endif
+	}
+	posix_madvise(file->content, size, POSIX_MADV_SEQUENTIAL); /* only a hint, so errors don't matter */
+	file->length = size + 1;
+
+	return true;
+}
+
+static mcJSON_File *file_open(const char * const path) {
+	const int descriptor = open(path, O_RDONLY);
+	if (descriptor == -1) {
+		return NULL;
+	}
+
+	mcJSON_File *file = NULL;
+	struct stat status;
+	if ((fstat(descriptor, &status) != 0) || (status.st_size < 0) || ((uintmax_t)status.st_size >= SIZE_MAX)) {
+		goto cleanup;
+	}
+	const size_t size = (size_t)status.st_size;
+
+	file = (mcJSON_File*)malloc(sizeof(mcJSON_File));
+	if (file == NULL) {
+		goto cleanup;
+	}
+
+	const long page_size = sysconf(_SC_PAGESIZE);
+	if ((size != 0) && (page_size > 0) && file_map(file, descriptor, size, (size_t)page_size)) {
+		goto cleanup;
+	}
+
+	if (!file_read(file, descriptor, size)) {
+		free(file);
+		file = NULL;
+	}
+
+cleanup:
+	close(descriptor);
+	return file;
+}
+
+void mcJSON_FileClose(mcJSON_File * const file) {
+	if (file == NULL) {
+		return;
+	}
+
+	if (file->mapping_length != 0) {
+		munmap(file->content, file->mapping_length);
+	} else {
+		free(file->content);
+	}
+	free(file);
+}
+
+const unsigned char *mcJSON_FileContent(const mcJSON_File * const file, size_t * const length) {
+	if (file == NULL) {
+		return NULL;
+	}
+
+	if (length != NULL) {
+		*length = file->length;
+	}
+	return file->content;
+}
+
+bool mcJSON_FileIsMapped(const mcJSON_File * const file) {
+	return (file != NULL) && (file->mapping_length != 0);
+}
+
+mcJSON *mcJSON_ParseFile(const char * const path, mempool_t * const pool, const unsigned int flags, mcJSON_File ** const file) {
+	if (file != NULL) {
+		*file = NULL;
+	}
+	if ((path == NULL) || (((flags & mcJSON_FILE_BORROW_STRINGS) != 0) && (file == NULL))) {
+		return NULL;
+	}
+
+	mcJSON_File *opened = file_open(path);
+	if (opened == NULL) {
+		return NULL;
+	}
+
+	const mcJSON_ParseOptions options = {
+		(flags & mcJSON_FILE_BORROW_STRINGS) != 0, /* borrow_strings */
+		false, /* in_situ */
+		0, /* max_depth */
+		false, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+	buffer_create_with_existing_array(json, opened->content, opened->length);
+	mcJSON *root = mcJSON_ParseWithOptions(json, pool, &options);
+	if ((root == NULL) || (file == NULL)) {
+		mcJSON_FileClose(opened);
+	} else {
+		*file = opened;
+	}
+
+	return root;
+}
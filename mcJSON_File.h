@@ -0,0 +1,58 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "mcJSON.h"
+
+#ifndef mcJSON_FILE__H
+#define mcJSON_FILE__H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Flags for mcJSON_ParseFile: */
+/* Strings without escape sequences point into the file instead of being copied,
+ * like borrow_strings in mcJSON_ParseOptions. This needs the file to stay open. */
+#define mcJSON_FILE_BORROW_STRINGS 0x1
+
+/* A file that is mapped into memory (or read if that isn't possible). */
+typedef struct mcJSON_File mcJSON_File;
+
+/* Parse a file without copying it first, it is mapped into memory read only and parsed
+ * directly from there. Files whose size is a multiple of the page size are mapped in front
+ * of an additional zeroed page, which provides the terminating '\0'. Only files that can't
+ * be mapped (e.g. empty files) are read into memory instead. pool can be NULL.
+ * If file is NULL, the file is closed before returning. Otherwise it is kept open and
+ * *file is set if parsing succeeds, close it with mcJSON_FileClose after the tree isn't
+ * used anymore. mcJSON_FILE_BORROW_STRINGS needs file. */
+mcJSON *mcJSON_ParseFile(const char * const path, mempool_t * const pool, const unsigned int flags, mcJSON_File ** const file);
+/* Unmap a file from mcJSON_ParseFile, the strings that were borrowed from it become invalid. */
+void mcJSON_FileClose(mcJSON_File * const file);
+/* The '\0' terminated content of a file, *length is set to its length including the '\0'
+ * if length isn't NULL. Borrowed strings point into this. */
+const unsigned char *mcJSON_FileContent(const mcJSON_File * const file, size_t * const length);
+/* true if the file is mapped into memory, false if it had to be read. */
+bool mcJSON_FileIsMapped(const mcJSON_File * const file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,631 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "mcJSON_Parallel.h"
+
+#define ALIGNMENT_OF(type) offsetof( struct { char c; type t; }, t )
+
+/* Arrays that are smaller than this per thread are parsed by fewer threads. */
+#define MIN_ARRAY_BYTES_PER_THREAD (64 * 1024)
+
+/* Chunks are the unit of work. They are big enough to make the locking
+ * negligible but small enough to balance the work between the threads
+ * and to keep the trees of a chunk in the cache until they are delivered. */
+#define MIN_CHUNK_SIZE (16 * 1024)
+#define MAX_CHUNK_SIZE (256 * 1024)
+#define CHUNKS_PER_THREAD 8
+/* Initial block size of the arena of every thread relative to the chunk size,
+ * the arena grows if the trees of a chunk don't fit. */
+#define POOL_SIZE_FACTOR 16
+
+typedef struct record {
+	mcJSON *json;
+	size_t offset;
+	size_t length;
+} record;
+
+typedef struct line_engine {
+	const buffer_t *lines;
+	size_t end; /* end of the input without the terminating '\0' */
+	size_t chunk_size;
+	size_t chunk_count;
+	bool ordered;
+	mcJSON_LineCallback callback;
+	void *userdata;
+	mcJSON_Context context; /* allocator of mcJSON_InitHooks */
+
+	pthread_mutex_t lock;
+	pthread_cond_t delivered_changed;
+	/* protected by lock */
+	size_t next_chunk;
+	size_t delivered; /* number of chunks that have been passed to the callback in order */
+	bool stop;
+	bool failed;
+} line_engine;
+
+typedef struct line_worker {
+	line_engine *engine;
+	pthread_t thread;
+	mempool_t *pool; /* arena */
+	/* '\0' terminated copy of the current line */
+	unsigned char *line;
+	size_t line_size;
+	record *records;
+	size_t record_count;
+	size_t records_size;
+} line_worker;
+
+static void *context_malloc(const mcJSON_Context * const context, const size_t size) {
+	return context->malloc_fn(context->userdata, size);
+}
+
+static void context_free(const mcJSON_Context * const context, void * const pointer) {
+	if (pointer != NULL) {
+		context->free_fn(context->userdata, pointer);
+	}
+}
+
+/* Make room for at least one more element in a growing array. */
+static bool array_reserve(void ** const array, size_t * const size, const size_t used, const size_t element_size, const mcJSON_Context * const context) {
+	if (used < *size) {
+		return true;
+	}
+
+	const size_t new_size = (*size == 0) ? 64 : (2 * *size);
+	void *new_array = context_malloc(context, new_size * element_size);
+	if (new_array == NULL) {
+		return false;
+	}
+	if (*array != NULL) {
+		memcpy(new_array, *array, used * element_size);
+		context_free(context, *array);
+	}
+	*array = new_array;
+	*size = new_size;
+
+	return true;
+}
+
+/* Start of a chunk, chunks begin after the first newline in front of their nominal start. */
+static size_t chunk_start(const line_engine * const engine, const size_t index) {
+	if (index == 0) {
+		return 0;
+	}
+	const size_t nominal_start = index * engine->chunk_size;
+	if (nominal_start >= engine->end) {
+		return engine->end;
+	}
+
+	const unsigned char *newline = memchr(engine->lines->content + nominal_start - 1, '\n', engine->end - nominal_start + 1);
+	if (newline == NULL) {
+		return engine->end;
+	}
+
+	return (size_t)(newline - engine->lines->content) + 1;
+}
+
+static bool add_record(line_worker * const worker, mcJSON * const json, const size_t offset, const size_t length) {
+	if (!array_reserve((void**)&worker->records, &worker->records_size, worker->record_count, sizeof(record), &worker->engine->context)) {
+		return false;
+	}
+
+	worker->records[worker->record_count].json = json;
+	worker->records[worker->record_count].offset = offset;
+	worker->records[worker->record_count].length = length;
+	worker->record_count++;
+
+	return true;
+}
+
+static bool parse_chunk(line_worker * const worker, const size_t start, const size_t end) {
+	const unsigned char * const content = worker->engine->lines->content;
+	mcJSON_PoolReset(worker->pool, false);
+	worker->record_count = 0;
+
+	size_t next_line = start;
+	for (size_t offset = start; offset < end; offset = next_line) {
+		const unsigned char *newline = memchr(content + offset, '\n', end - offset);
+		const size_t length = (newline == NULL) ? (end - offset) : (size_t)(newline - (content + offset));
+		next_line = offset + length + 1;
+
+		/* skip empty lines */
+		size_t position = offset;
+		while ((position < (offset + length)) && (content[position] <= 32) && (content[position] != '\0')) {
+			position++;
+		}
+		if (position == (offset + length)) {
+			continue;
+		}
+
+		if (worker->line_size <= length) {
+			context_free(&worker->engine->context, worker->line);
+			worker->line_size = 0;
+			worker->line = (unsigned char*)context_malloc(&worker->engine->context, length + 1);
+			if (worker->line == NULL) {
+				return false;
+			}
+			worker->line_size = length + 1;
+		}
+		memcpy(worker->line, content + offset, length);
+		worker->line[length] = '\0';
+		buffer_create_with_existing_array(line, worker->line, length + 1);
+
+		/* invalid records are passed to the callback as NULL */
+		mcJSON *json = mcJSON_ParseRecord(line, worker->pool);
+		if (!add_record(worker, json, offset, length)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Pass the records of a chunk to the callback, their trees stay in the arena until the next chunk resets it. */
+static void deliver_chunk(line_worker * const worker, const size_t index) {
+	line_engine * const engine = worker->engine;
+
+	pthread_mutex_lock(&engine->lock);
+	while (engine->ordered && !engine->stop && (engine->delivered != index)) {
+		pthread_cond_wait(&engine->delivered_changed, &engine->lock);
+	}
+	for (size_t i = 0; !engine->stop && (i < worker->record_count); i++) {
+		const record * const current = &worker->records[i];
+		if (!engine->callback(engine->userdata, current->json, current->offset, current->length)) {
+			engine->stop = true;
+		}
+	}
+	engine->delivered++;
+	pthread_cond_broadcast(&engine->delivered_changed);
+	pthread_mutex_unlock(&engine->lock);
+	worker->record_count = 0;
+}
+
+static void fail(line_engine * const engine) {
+	pthread_mutex_lock(&engine->lock);
+	engine->stop = true;
+	engine->failed = true;
+	pthread_cond_broadcast(&engine->delivered_changed);
+	pthread_mutex_unlock(&engine->lock);
+}
+
+static void *line_worker_run(void *argument) {
+	line_worker * const worker = (line_worker*)argument;
+	line_engine * const engine = worker->engine;
+
+	while (true) {
+		pthread_mutex_lock(&engine->lock);
+		if (engine->stop || (engine->next_chunk >= engine->chunk_count)) {
+			pthread_mutex_unlock(&engine->lock);
+			break;
+		}
+		const size_t index = engine->next_chunk;
+		engine->next_chunk++;
+		pthread_mutex_unlock(&engine->lock);
+
+		if (!parse_chunk(worker, chunk_start(engine, index), chunk_start(engine, index + 1))) {
+			fail(engine);
+			break;
+		}
+		deliver_chunk(worker, index);
+	}
+
+	return NULL;
+}
+
+bool mcJSONParallel_ParseLines(const buffer_t * const lines, size_t threads, const bool ordered, const mcJSON_LineCallback callback, void * const userdata) {
+	if ((lines == NULL) || (lines->content == NULL) || (callback == NULL)) {
+		return false;
+	}
+
+	if (threads == 0) {
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (processors > 0) ? (size_t)processors : 1;
+	}
+
+	line_engine engine;
+	engine.lines = lines;
+	engine.end = lines->content_length;
+	if ((engine.end != 0) && (lines->content[engine.end - 1] == '\0')) {
+		engine.end--;
+	}
+	engine.chunk_size = engine.end / (threads * CHUNKS_PER_THREAD);
+	if (engine.chunk_size < MIN_CHUNK_SIZE) {
+		engine.chunk_size = MIN_CHUNK_SIZE;
+	} else if (engine.chunk_size > MAX_CHUNK_SIZE) {
+		engine.chunk_size = MAX_CHUNK_SIZE;
+	}
+	engine.chunk_count = (engine.end + engine.chunk_size - 1) / engine.chunk_size;
+	if (threads > engine.chunk_count) {
+		threads = engine.chunk_count;
+	}
+	if (threads == 0) { /* no input */
+		return true;
+	}
+	engine.ordered = ordered;
+	engine.callback = callback;
+	engine.userdata = userdata;
+	engine.next_chunk = 0;
+	engine.delivered = 0;
+	engine.stop = false;
+	engine.failed = false;
+	mcJSON_ContextInit(&engine.context);
+
+	line_worker *workers = (line_worker*)context_malloc(&engine.context, threads * sizeof(line_worker));
+	if (workers == NULL) {
+		return false;
+	}
+	memset(workers, 0, threads * sizeof(line_worker));
+	if (pthread_mutex_init(&engine.lock, NULL) != 0) {
+		context_free(&engine.context, workers);
+		return false;
+	}
+	if (pthread_cond_init(&engine.delivered_changed, NULL) != 0) {
+		pthread_mutex_destroy(&engine.lock);
+		context_free(&engine.context, workers);
+		return false;
+	}
+
+	const size_t pool_size = POOL_SIZE_FACTOR * engine.chunk_size;
+	size_t worker_count = 0;
+	for (; worker_count < threads; worker_count++) {
+		workers[worker_count].engine = &engine;
+		workers[worker_count].pool = mcJSON_ArenaCreateWithContext(pool_size, &engine.context);
+		if (workers[worker_count].pool == NULL) {
+			break;
+		}
+	}
+
+	/* the first worker runs on the calling thread */
+	size_t started = 1;
+	if (worker_count != 0) {
+		for (; started < worker_count; started++) {
+			if (pthread_create(&workers[started].thread, NULL, line_worker_run, &workers[started]) != 0) {
+				break; /* the other threads take over the work */
+			}
+		}
+		line_worker_run(&workers[0]);
+		for (size_t i = 1; i < started; i++) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+
+	for (size_t i = 0; i < worker_count; i++) {
+		mcJSON_ArenaDestroy(workers[i].pool);
+		context_free(&engine.context, workers[i].line);
+		context_free(&engine.context, workers[i].records);
+	}
+	pthread_cond_destroy(&engine.delivered_changed);
+	pthread_mutex_destroy(&engine.lock);
+	context_free(&engine.context, workers);
+
+	return (worker_count != 0) && !engine.stop;
+}
+
+/* Every thread parses a range of the elements of the top level array into its own
+ * part of the pool (or its own arena) and links them into a chain. */
+typedef struct array_worker {
+	const buffer_t *json;
+	const size_t *starts; /* start of every element of the array */
+	size_t count; /* number of elements */
+	size_t end; /* the closing ']' */
+	size_t first;
+	size_t last;
+	mempool_t *pool; /* NULL, a slice of the pool or an arena */
+	mempool_t slice;
+	mempool_t *arena; /* own arena that is merged into the pool, NULL if there is none */
+	pthread_t thread;
+	mcJSON *head;
+	mcJSON *tail;
+	bool failed;
+} array_worker;
+
+static void *array_worker_run(void *argument) {
+	array_worker * const worker = (array_worker*)argument;
+
+	for (size_t i = worker->first; i < worker->last; i++) {
+		mcJSON_Cursor cursor = {worker->json, worker->starts[i], 0, 1, false};
+		mcJSON *element = mcJSON_CursorTakeValue(&cursor, worker->pool);
+		/* the element has to end right in front of the next one, otherwise the parser stopped inside of it */
+		const size_t next = ((i + 1) < worker->count) ? worker->starts[i + 1] : worker->end;
+		if ((element == NULL) || (cursor.position != next)) {
+			if ((element != NULL) && (worker->pool == NULL)) {
+				mcJSON_Delete(element);
+			}
+			worker->failed = true;
+			return NULL;
+		}
+
+		if (worker->tail == NULL) {
+			worker->head = element;
+		} else {
+			worker->tail->next = element;
+			element->prev = worker->tail;
+		}
+		worker->tail = element;
+	}
+
+	return NULL;
+}
+
+/* Find the start of every element of the array the cursor points to. Only the
+ * separators are checked here, the elements themselves are checked by parsing them. */
+static size_t *scan_array(mcJSON_Cursor * const cursor, size_t * const count, const mcJSON_Context * const context) {
+	size_t *starts = NULL;
+	size_t starts_size = 0;
+	*count = 0;
+
+	if (mcJSON_CursorEnter(cursor)) {
+		do {
+			if ((mcJSON_CursorType(cursor) == 0) || cursor->has_key
+					|| !array_reserve((void**)&starts, &starts_size, *count, sizeof(size_t), context)) {
+				context_free(context, starts);
+				return NULL;
+			}
+			starts[*count] = cursor->position;
+			(*count)++;
+		} while (mcJSON_CursorNext(cursor));
+	}
+
+	/* the cursor has to be at the closing ']' without a ',' in front of it */
+	const buffer_t * const json = cursor->json;
+	size_t position = cursor->position;
+	if ((position >= json->content_length) || (json->content[position] != ']')) {
+		context_free(context, starts);
+		return NULL;
+	}
+	do {
+		position--;
+	} while ((json->content[position] <= 32) && (position > 0));
+	if (json->content[position] == ',') {
+		context_free(context, starts);
+		return NULL;
+	}
+
+	if (starts == NULL) { /* empty array */
+		starts = (size_t*)context_malloc(context, sizeof(size_t));
+	}
+	return starts;
+}
+
+/* Size of an allocation in a mempool_t including the padding in front of the next one. */
+static size_t aligned_size(const size_t size) {
+	const size_t alignment = ALIGNMENT_OF(intmax_t);
+	return ((size + alignment - 1) / alignment) * alignment;
+}
+
+/* Size that the elements first to last need in a mempool_t, every element is measured
+ * like mcJSON_ParseBufferSize measures a whole json. */
+static size_t range_pool_size(const array_worker * const worker) {
+	size_t size = 0;
+	for (size_t i = worker->first; i < worker->last; i++) {
+		const size_t next = ((i + 1) < worker->count) ? worker->starts[i + 1] : worker->end;
+		buffer_create_with_existing_array(element, worker->json->content + worker->starts[i], next - worker->starts[i]);
+		size += aligned_size(mcJSON_ParseBufferSize(element));
+	}
+
+	return size;
+}
+
+/* Give every worker the pool it parses into. Arenas can't be shared between threads,
+ * so every worker but the first one gets its own arena that is merged into the pool
+ * in the end. Other pools are split into slices of exactly the size that the elements
+ * of every worker need, the last worker gets the rest. */
+static bool assign_pools(array_worker * const workers, const size_t threads, mempool_t * const pool) {
+	if (pool == NULL) {
+		return true;
+	}
+
+	if (mcJSON_PoolIsArena(pool)) {
+		workers[0].pool = pool;
+		for (size_t i = 1; i < threads; i++) {
+			workers[i].arena = mcJSON_ArenaCreateLike(pool, pool->buffer_length);
+			if (workers[i].arena == NULL) {
+				return false;
+			}
+			workers[i].pool = workers[i].arena;
+		}
+
+		return true;
+	}
+
+	/* every slice has to start aligned like the allocations in it */
+	const size_t alignment = ALIGNMENT_OF(intmax_t);
+	size_t slice_start = pool->position + ((alignment - (((size_t)(pool->content + pool->position)) % alignment)) % alignment);
+	for (size_t i = 0; i < threads; i++) {
+		if (slice_start > pool->buffer_length) {
+			return false;
+		}
+		size_t slice_size = pool->buffer_length - slice_start;
+		if (i != (threads - 1)) {
+			const size_t range_size = range_pool_size(&workers[i]);
+			if (range_size > slice_size) {
+				return false;
+			}
+			slice_size = range_size;
+		}
+		buffer_init_with_pointer(&workers[i].slice, pool->content + slice_start, slice_size, 0);
+		workers[i].slice.position = 0;
+		workers[i].pool = &workers[i].slice;
+		slice_start += slice_size;
+	}
+
+	return true;
+}
+
+/* Destroy the arenas of the workers that haven't been merged into the pool. */
+static void destroy_arenas(array_worker * const workers, const size_t threads) {
+	for (size_t i = 0; i < threads; i++) {
+		mcJSON_ArenaDestroy(workers[i].arena);
+	}
+}
+
+mcJSON *mcJSONParallel_ParseWithBuffer(buffer_t * const json, mempool_t * const pool, size_t threads) {
+	mcJSON_Cursor cursor;
+	if ((json == NULL) || (json->content_length == 0) || (json->content[json->content_length - 1] != '\0')
+			|| !mcJSON_CursorInit(&cursor, json)) {
+		return NULL;
+	}
+	if (mcJSON_CursorType(&cursor) != mcJSON_Array) {
+		return mcJSON_CursorTakeValue(&cursor, pool);
+	}
+
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	size_t count;
+	size_t *starts = scan_array(&cursor, &count, &context);
+	if (starts == NULL) {
+		return NULL;
+	}
+	/* only whitespace can follow the array */
+	size_t position = cursor.position + 1;
+	while ((json->content[position] <= 32) && (json->content[position] != '\0')) {
+		position++;
+	}
+	if (json->content[position] != '\0') {
+		context_free(&context, starts);
+		return NULL;
+	}
+
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	mcJSON *root = mcJSON_CreateArray(pool);
+	if (root == NULL) {
+		context_free(&context, starts);
+		return NULL;
+	}
+
+	if (threads == 0) {
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (processors > 0) ? (size_t)processors : 1;
+	}
+	const size_t total_bytes = (count == 0) ? 0 : (cursor.position - starts[0]);
+	if (threads > (total_bytes / MIN_ARRAY_BYTES_PER_THREAD)) {
+		threads = total_bytes / MIN_ARRAY_BYTES_PER_THREAD;
+	}
+	if (threads > count) {
+		threads = count;
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	array_worker *workers = (array_worker*)context_malloc(&context, threads * sizeof(array_worker));
+	if (workers == NULL) {
+		context_free(&context, starts);
+		if (pool == NULL) {
+			mcJSON_Delete(root);
+		}
+		mcJSON_PoolRollback(pool, marker, false);
+		return NULL;
+	}
+
+	memset(workers, 0, threads * sizeof(array_worker));
+
+	/* split the elements into ranges of roughly the same size in bytes */
+	size_t element = 0;
+	for (size_t i = 0; i < threads; i++) {
+		workers[i].json = json;
+		workers[i].starts = starts;
+		workers[i].count = count;
+		workers[i].end = cursor.position;
+		workers[i].first = element;
+		const size_t range_end = (i == (threads - 1)) ? cursor.position : (starts[0] + ((i + 1) * total_bytes / threads));
+		while ((element < count) && ((element == workers[i].first) || (starts[element] < range_end))) {
+			element++;
+		}
+		workers[i].last = element;
+	}
+
+	if (!assign_pools(workers, threads, pool)) {
+		destroy_arenas(workers, threads);
+		context_free(&context, workers);
+		context_free(&context, starts);
+		mcJSON_PoolRollback(pool, marker, false);
+		return NULL;
+	}
+
+	/* the first range is parsed on the calling thread */
+	size_t started = 1;
+	for (; started < threads; started++) {
+		if (pthread_create(&workers[started].thread, NULL, array_worker_run, &workers[started]) != 0) {
+			break;
+		}
+	}
+	array_worker_run(&workers[0]);
+	for (size_t i = 1; i < started; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+	for (size_t i = started; i < threads; i++) { /* ranges that didn't get a thread */
+		array_worker_run(&workers[i]);
+	}
+
+	/* link the chains together */
+	bool failed = false;
+	mcJSON *tail = NULL;
+	for (size_t i = 0; i < threads; i++) {
+		failed = failed || workers[i].failed;
+		if (workers[i].head == NULL) {
+			continue;
+		}
+		if (tail == NULL) {
+			root->child = workers[i].head;
+		} else {
+			tail->next = workers[i].head;
+			workers[i].head->prev = tail;
+		}
+		tail = workers[i].tail;
+	}
+	root->length = count;
+
+	if (failed) {
+		destroy_arenas(workers, threads);
+		context_free(&context, workers);
+		context_free(&context, starts);
+		if (pool == NULL) {
+			mcJSON_Delete(root);
+		}
+		mcJSON_PoolRollback(pool, marker, true);
+		return NULL;
+	}
+
+	if (mcJSON_PoolIsArena(pool)) {
+		for (size_t i = 0; i < threads; i++) {
+			mcJSON_ArenaMerge(pool, workers[i].arena);
+		}
+	} else if (pool != NULL) {
+		/* the parts of the pool before the last one can't be used anymore */
+		pool->position = (size_t)(workers[threads - 1].slice.content - pool->content) + workers[threads - 1].slice.position;
+	}
+	context_free(&context, workers);
+	context_free(&context, starts);
+
+	return root;
+}
+
+mcJSON *mcJSONParallel_Parse(buffer_t * const json, size_t threads) {
+	return mcJSONParallel_ParseWithBuffer(json, NULL, threads);
+}
@@ -0,0 +1,63 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "mcJSON.h"
+
+#ifndef mcJSON_PARALLEL__H
+#define mcJSON_PARALLEL__H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parse newline delimited json like mcJSON_ParseLines, but with multiple threads.
+ * The input is split into chunks at line boundaries, every thread parses whole
+ * chunks into its own arena. If ordered is true, the records are passed to the
+ * callback in the order of the input, otherwise in the order they are finished.
+ * The callback is never called concurrently and the tree is only valid until it
+ * returns. threads == 0 uses one thread per processor. Memory is allocated with
+ * the hooks from mcJSON_InitHooks. Returns false if the callback stopped or memory
+ * allocation failed. With a single thread this is about as fast as mcJSON_ParseLines,
+ * inputs smaller than two chunks (32 KiB) are parsed by one thread only. */
+bool mcJSONParallel_ParseLines(const buffer_t * const lines, size_t threads, const bool ordered, const mcJSON_LineCallback callback, void * const userdata);
+
+/* Parse a big top level array with multiple threads. The elements are found by
+ * matching brackets first and then parsed concurrently, every thread builds a chain
+ * of elements that are linked together in the end. Other json is parsed on the
+ * calling thread. json has to be terminated by '\0' and other than with mcJSON_Parse,
+ * only whitespace may follow the value. Call mcJSON_Delete when finished.
+ * threads == 0 uses one thread per processor, every thread gets at least 64 KiB of
+ * the array. Because of the extra pass that finds the elements, this is slower than
+ * mcJSON_Parse on a single thread (about 0.6 to 0.75 times its throughput in
+ * benchmark-parallel), so it only pays off with several processors and big arrays. */
+mcJSON *mcJSONParallel_Parse(buffer_t * const json, size_t threads);
+/* Like mcJSONParallel_Parse, but the tree is created in pool like mcJSON_ParseWithBuffer.
+ * Every thread gets a part of the pool of exactly the size that its elements need
+ * (this takes an extra pass over the array), so a pool of mcJSON_ParseBufferSize bytes
+ * is enough. If pool is an arena, every thread parses into its own arena instead and
+ * they are merged into pool in the end. Like in mcJSON_ParseWithBuffer, the pool is
+ * rolled back if this fails. */
+mcJSON *mcJSONParallel_ParseWithBuffer(buffer_t * const json, mempool_t * const pool, size_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -223,6 +223,9 @@ static int mcJSONUtils_Compare(mcJSON *a, mcJSON *b) {
 	}
 	switch (a->type) {
 		case mcJSON_Number:
+			if (a->is_int64 && b->is_int64) {
+				return (a->valueint64 != b->valueint64) ? -2 : 0; /* numeric mismatch. */
+			}
 			return ((a->valueint != b->valueint) || (a->valuedouble != b->valuedouble)) ? -2 : 0; /* numeric mismatch. */
 		case mcJSON_String:
 			return (strcmp((char*)a->valuestring->content, (char*)b->valuestring->content) != 0) ? -3 : 0; /* string mismatch. */
@@ -425,7 +428,7 @@ static void mcJSONUtils_CompareToPatch(mcJSON *patches, const char *path, mcJSON
 
 	switch (from->type) {
 		case mcJSON_Number:
-			if ((from->valueint != to->valueint) || (from->valuedouble != to->valuedouble)) {
+			if ((from->is_int64 && to->is_int64) ? (from->valueint64 != to->valueint64) : ((from->valueint != to->valueint) || (from->valuedouble != to->valuedouble))) {
 				mcJSONUtils_GeneratePatch(patches, "replace", path, 0, to);
 			}
 			return;
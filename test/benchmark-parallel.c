@@ -0,0 +1,146 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../mcJSON_Parallel.h"
+
+/* Compare the throughput of mcJSON_ParseLines with mcJSONParallel_ParseLines
+ * and of mcJSON_Parse with mcJSONParallel_Parse for a big array,
+ * for every thread count up to the number of processors. This isn't run as
+ * a test because the results depend on the machine. */
+
+#define RECORD_COUNT 500000
+
+static bool count_record(void * const userdata, mcJSON * const json, const size_t offset, const size_t length) {
+	(void)offset;
+	(void)length;
+	if (json != NULL) {
+		(*(size_t*)userdata)++;
+	}
+	return true;
+}
+
+static double now(void) {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec + ((double)time.tv_nsec / 1e9);
+}
+
+static void report(const char *name, const size_t threads, const size_t bytes, const double seconds, const double serial_seconds) {
+	printf("%-10s %2zu threads: %8.1f MB/s, speedup %.2f\n", name, threads, (double)bytes / (seconds * 1e6), serial_seconds / seconds);
+}
+
+int main(void) {
+	const size_t size = RECORD_COUNT * 200;
+	buffer_t *lines = buffer_create_on_heap(size, 0);
+	if (lines == NULL) {
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < RECORD_COUNT; i++) {
+		lines->content_length += (size_t)snprintf((char*)lines->content + lines->content_length, size - lines->content_length,
+			"{\"time\": %zu, \"level\": \"info\", \"message\": \"request %zu handled\", \"latency\": %zu.25, \"tags\": [\"http\", \"api\"], \"ok\": true}\n",
+			1500000000 + i, i, i % 1000);
+	}
+
+	size_t count = 0;
+	double start = now();
+	mcJSON_ParseLines(lines, 4096, count_record, &count);
+	const double serial_seconds = now() - start;
+	report("serial", 1, lines->content_length, serial_seconds, serial_seconds);
+
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	for (size_t threads = 1; threads <= (size_t)((processors > 0) ? processors : 1); threads *= 2) {
+		count = 0;
+		start = now();
+		mcJSONParallel_ParseLines(lines, threads, true, count_record, &count);
+		report("ordered", threads, lines->content_length, now() - start, serial_seconds);
+
+		count = 0;
+		start = now();
+		mcJSONParallel_ParseLines(lines, threads, false, count_record, &count);
+		report("unordered", threads, lines->content_length, now() - start, serial_seconds);
+	}
+
+
+	/* the same records as one big array */
+	for (size_t i = 0; i < lines->content_length; i++) {
+		if (lines->content[i] == '\n') {
+			lines->content[i] = ',';
+		}
+	}
+	memmove(lines->content + 1, lines->content, lines->content_length);
+	lines->content[0] = '[';
+	lines->content[lines->content_length] = ']'; /* instead of the last ',' */
+	lines->content[lines->content_length + 1] = '\0';
+	lines->content_length += 2;
+	start = now();
+	mcJSON *array = mcJSON_Parse(lines);
+	const double array_serial_seconds = now() - start;
+	if (array == NULL) {
+		buffer_destroy_from_heap(lines);
+		return EXIT_FAILURE;
+	}
+	mcJSON_Delete(array);
+	report("array", 1, lines->content_length, array_serial_seconds, array_serial_seconds);
+	for (size_t threads = 1; threads <= (size_t)((processors > 0) ? processors : 1); threads *= 2) {
+		start = now();
+		array = mcJSONParallel_Parse(lines, threads);
+		report("parallel", threads, lines->content_length, now() - start, array_serial_seconds);
+		if (array == NULL) {
+			buffer_destroy_from_heap(lines);
+			return EXIT_FAILURE;
+		}
+		mcJSON_Delete(array);
+	}
+
+	buffer_destroy_from_heap(lines);
+
+	return EXIT_SUCCESS;
+}
@@ -48,6 +48,142 @@
 #include "../mcJSON.h"
 
 
+/* Check if other has the same content as json, other gets deleted. */
+static int same_tree(mcJSON *json, mcJSON *other, const char *description) {
+	if (other == NULL) {
+		fprintf(stderr, "ERROR: Failed %s!\n", description);
+		return 0;
+	}
+
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	buffer_t *other_output = mcJSON_PrintUnformatted(other);
+	mcJSON_Delete(other);
+	int status = (output != NULL) && (other_output != NULL) && (buffer_compare(output, other_output) == 0);
+	if (!status) {
+		fprintf(stderr, "ERROR: %s created a different tree!\n", description);
+	}
+	if (output != NULL) {
+		buffer_destroy_from_heap(output);
+	}
+	if (other_output != NULL) {
+		buffer_destroy_from_heap(other_output);
+	}
+
+	return status;
+}
+
+/* Parse text to JSON with the incremental parser, in chunks of chunk_size bytes. */
+static mcJSON *parse_in_chunks(buffer_t *input_string, size_t chunk_size) {
+	mcJSON_Parser *parser = mcJSON_ParserCreate(NULL);
+	if (parser == NULL) {
+		return NULL;
+	}
+
+	for (size_t position = 0; position < input_string->content_length; position += chunk_size) {
+		size_t length = input_string->content_length - position;
+		if (length > chunk_size) {
+			length = chunk_size;
+		}
+		buffer_create_with_existing_array(chunk, input_string->content + position, length);
+		if (!mcJSON_ParserFeed(parser, chunk)) {
+			break;
+		}
+	}
+
+	return mcJSON_ParserFinish(parser);
+}
+
+/* Walk over the children of json with a cursor, skipping over them has to find the same values. */
+static int same_as_cursor(mcJSON *json, buffer_t *input_string) {
+	mcJSON_Cursor cursor;
+	if (!mcJSON_CursorInit(&cursor, input_string)
+			|| !same_tree(json, mcJSON_CursorGetValue(&cursor, NULL), "parsing with a cursor")) {
+		return 0;
+	}
+	if ((json->type != mcJSON_Array) && (json->type != mcJSON_Object)) {
+		return 1;
+	}
+
+	bool has_value = mcJSON_CursorEnter(&cursor);
+	for (mcJSON *child = json->child; child != NULL; child = child->next) {
+		if (!has_value || !same_tree(child, mcJSON_CursorGetValue(&cursor, NULL), "walking with a cursor")) {
+			return 0;
+		}
+		has_value = mcJSON_CursorNext(&cursor);
+	}
+
+	return !has_value && (mcJSON_CursorType(&cursor) == 0);
+}
+
+/* Parsing into a pool of mcJSON_ParseBufferSize bytes has to use all of it, one byte less isn't enough. */
+static int exact_buffer_size(mcJSON *json, buffer_t *input_string) {
+	const size_t size = mcJSON_ParseBufferSize(input_string);
+	if (size == 0) {
+		return 0;
+	}
+	mempool_t *pool = buffer_create_on_heap(size, 0);
+	mempool_t *small_pool = buffer_create_on_heap(size - 1, 0);
+	if ((pool == NULL) || (small_pool == NULL)) {
+		if (pool != NULL) {
+			buffer_destroy_from_heap(pool);
+		}
+		if (small_pool != NULL) {
+			buffer_destroy_from_heap(small_pool);
+		}
+		return 0;
+	}
+
+	/* the pool is rolled back if parsing fails */
+	const bool too_small = (mcJSON_ParseWithBuffer(input_string, small_pool) == NULL) && (small_pool->position == 0);
+	buffer_destroy_from_heap(small_pool);
+	if (!too_small) {
+		fprintf(stderr, "ERROR: A pool smaller than mcJSON_ParseBufferSize was big enough!\n");
+		buffer_destroy_from_heap(pool);
+		return 0;
+	}
+
+	mcJSON *buffered_json = mcJSON_ParseWithBuffer(input_string, pool);
+	if (buffered_json == NULL) {
+		fprintf(stderr, "ERROR: The pool of mcJSON_ParseBufferSize wasn't big enough!\n");
+		buffer_destroy_from_heap(pool);
+		return 0;
+	}
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	buffer_t *buffered_output = mcJSON_PrintUnformatted(buffered_json);
+	int status = (pool->position == size) && (output != NULL) && (buffered_output != NULL) && (buffer_compare(output, buffered_output) == 0);
+	if (output != NULL) {
+		buffer_destroy_from_heap(output);
+	}
+	if (buffered_output != NULL) {
+		buffer_destroy_from_heap(buffered_output);
+	}
+	buffer_destroy_from_heap(pool);
+
+	return status;
+}
+
+/* Parsing into an arena that has to grow has to create the same tree. */
+static int same_in_arena(mcJSON *json, buffer_t *input_string) {
+	mempool_t *arena = mcJSON_ArenaCreate(0);
+	if (arena == NULL) {
+		return 0;
+	}
+
+	mcJSON *arena_json = mcJSON_ParseWithBuffer(input_string, arena);
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	buffer_t *arena_output = (arena_json == NULL) ? NULL : mcJSON_PrintUnformatted(arena_json);
+	int status = (output != NULL) && (arena_output != NULL) && (buffer_compare(output, arena_output) == 0);
+	if (output != NULL) {
+		buffer_destroy_from_heap(output);
+	}
+	if (arena_output != NULL) {
+		buffer_destroy_from_heap(arena_output);
+	}
+	mcJSON_ArenaDestroy(arena);
+
+	return status;
+}
+
 /* Parse text to JSON, then render back to text, and print! */
 int doit(buffer_t *input_string, FILE *output_file) {
 	buffer_t *output = NULL;
@@ -94,6 +230,53 @@ int doit(buffer_t *input_string, FILE *output_file) {
 	}
 	buffer_destroy_from_heap(output);
 
+	//Alternative ways of parsing have to create the same tree
+	if (!same_tree(json, mcJSON_ParseIndexed(input_string, NULL), "indexed parsing")) {
+		mcJSON_Delete(json);
+		return 0;
+	}
+	mcJSON_ParseOptions borrow_options = {.borrow_strings = true};
+	mcJSON *borrowed_json = mcJSON_ParseWithOptions(input_string, NULL, &borrow_options);
+	if (!same_tree(json, mcJSON_Duplicate(borrowed_json, 1, NULL), "duplicating borrowed strings")
+			|| !same_tree(json, borrowed_json, "parsing with borrowed strings")) {
+		mcJSON_Delete(json);
+		return 0;
+	}
+	const size_t chunk_sizes[] = {1, 7, 4096};
+	for (size_t i = 0; i < (sizeof(chunk_sizes) / sizeof(*chunk_sizes)); i++) {
+		if (!same_tree(json, parse_in_chunks(input_string, chunk_sizes[i]), "incremental parsing")) {
+			mcJSON_Delete(json);
+			return 0;
+		}
+	}
+	buffer_t *in_situ_buffer = buffer_create_on_heap(input_string->content_length, input_string->content_length);
+	if (buffer_clone(in_situ_buffer, input_string) != 0) {
+		buffer_destroy_from_heap(in_situ_buffer);
+		mcJSON_Delete(json);
+		return 0;
+	}
+	int in_situ_status = same_tree(json, mcJSON_ParseInSitu(in_situ_buffer, NULL), "parsing in situ");
+	buffer_destroy_from_heap(in_situ_buffer);
+	if (!in_situ_status) {
+		mcJSON_Delete(json);
+		return 0;
+	}
+	if (!exact_buffer_size(json, input_string)) {
+		fprintf(stderr, "ERROR: mcJSON_ParseBufferSize isn't exact!\n");
+		mcJSON_Delete(json);
+		return 0;
+	}
+	if (!same_in_arena(json, input_string)) {
+		fprintf(stderr, "ERROR: Parsing into an arena created a different tree!\n");
+		mcJSON_Delete(json);
+		return 0;
+	}
+	if (!same_as_cursor(json, input_string)) {
+		fprintf(stderr, "ERROR: Cursor didn't find the same values!\n");
+		mcJSON_Delete(json);
+		return 0;
+	}
+
 	mcJSON_Delete(json);
 
 	// Test minify
@@ -102,7 +102,26 @@ int main (int argc, char **argv) {
 			fprintf(output_file, "%.*s\n", (int)print_buffer->content_length, (char*)print_buffer->content);
 		}
 
+		/* a buffer of exactly the right size has to create the same tree */
+		mcJSON *exact_tree = mcJSON_ParseBufferedExact(json_buffer);
+		buffer_t *exact_print_buffer = (exact_tree == NULL) ? NULL : mcJSON_Print(exact_tree);
+		if ((exact_print_buffer == NULL) || (buffer_compare(print_buffer, exact_print_buffer) != 0)) {
+			fprintf(stderr, "ERROR: Failed on text %zu with a buffer of the exact size!\n", i);
+			if (exact_print_buffer != NULL) {
+				buffer_destroy_from_heap(exact_print_buffer);
+			}
+			free(exact_tree);
+			buffer_destroy_from_heap(print_buffer);
+			free(json_tree);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
 		// cleanup
+		buffer_destroy_from_heap(exact_print_buffer);
+		free(exact_tree);
 		buffer_destroy_from_heap(print_buffer);
 		free(json_tree);
 	}
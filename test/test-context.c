@@ -0,0 +1,378 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+/* allocator that counts what it allocates, userdata points to the count */
+static void *counting_malloc(void * const userdata, const size_t size) {
+	void *pointer = malloc(size);
+	if (pointer != NULL) {
+		(*(size_t*)userdata)++;
+	}
+	return pointer;
+}
+
+static void *counting_realloc(void * const userdata, void * const pointer, const size_t size) {
+	void *new_pointer = realloc(pointer, size);
+	if ((new_pointer != NULL) && (pointer == NULL)) {
+		(*(size_t*)userdata)++;
+	}
+	return new_pointer;
+}
+
+static void counting_free(void * const userdata, void * const pointer) {
+	if (pointer != NULL) {
+		(*(size_t*)userdata)--;
+	}
+	free(pointer);
+}
+
+/* the global hooks mustn't be used when a context is passed */
+static size_t hook_allocations = 0;
+static void *hook_malloc(size_t size) {
+	hook_allocations++;
+	return malloc(size);
+}
+
+static bool print_json(const char * const label, mcJSON * const json, const mcJSON_Context * const context) {
+	buffer_t *output = mcJSON_PrintWithContext(json, false, context);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	printf("%s: %s\n", label, (char*)output->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %s\n", label, (char*)output->content);
+	}
+	context->free_fn(context->userdata, output->content);
+	context->free_fn(context->userdata, output);
+
+	return true;
+}
+
+/* parse, print and delete with a context */
+static bool test_heap(const bool with_realloc) {
+	size_t allocations = 0;
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.malloc_fn = counting_malloc;
+	context.realloc_fn = with_realloc ? counting_realloc : NULL;
+	context.free_fn = counting_free;
+	context.userdata = &allocations;
+
+	buffer_create_from_string(json_string,
+		"{\"name\": \"context\", \"escaped\": \"tab\\tand\\nnewline\", \"numbers\": [1, -2.5, 3e10],"
+		" \"nested\": {\"empty\": [], \"null\": null, \"true\": true, \"false\": false},"
+		" \"long\": \"a string that is long enough to make the output grow beyond the size that printing starts with,"
+		" so the buffer has to be reallocated at least once while the tree is printed with the context\"}");
+	mcJSON *json = mcJSON_ParseWithContext(json_string, &context);
+	if ((json == NULL) || (allocations == 0)) {
+		fprintf(stderr, "ERROR: Failed to parse with the context!\n");
+		return false;
+	}
+	if (!print_json(with_realloc ? "heap with realloc" : "heap", json, &context)) {
+		mcJSON_DeleteWithContext(json, &context);
+		return false;
+	}
+	mcJSON_DeleteWithContext(json, &context);
+	if (allocations != 0) {
+		fprintf(stderr, "ERROR: %zu allocations of the context weren't freed!\n", allocations);
+		return false;
+	}
+
+	/* failed parses don't leak */
+	buffer_create_from_string(invalid_string, "{\"name\": \"context\", \"numbers\": [1, 2,]}");
+	if ((mcJSON_ParseWithContext(invalid_string, &context) != NULL) || (allocations != 0)) {
+		fprintf(stderr, "ERROR: Failed parse with the context leaked!\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* parse into an arena with the allocator of a context */
+static bool test_arena(void) {
+	size_t allocations = 0;
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.malloc_fn = counting_malloc;
+	context.free_fn = counting_free;
+	context.userdata = &allocations;
+
+	context.pool = mcJSON_ArenaCreateWithContext(64, &context);
+	if ((context.pool == NULL) || (allocations != 2)) {
+		fprintf(stderr, "ERROR: Failed to create an arena with the context!\n");
+		return false;
+	}
+
+	/* borrowed strings through the options of the context */
+	const mcJSON_ParseOptions options = {
+		true, /* borrow_strings */
+		false, /* in_situ */
+		0, /* max_depth */
+		false, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+	context.options = &options;
+	buffer_create_from_string(json_string, "[\"first\", \"second\", \"third\", {\"fourth\": 4}]");
+	mcJSON *json = mcJSON_ParseWithContext(json_string, &context);
+	if ((json == NULL) || (allocations <= 2) || !json->child->valuestring_is_borrowed) {
+		fprintf(stderr, "ERROR: Failed to parse into the arena!\n");
+		mcJSON_ArenaDestroy(context.pool);
+		return false;
+	}
+	mcJSON *number = mcJSON_CreateNumber(5, context.pool);
+	mcJSON_AddItemToArray(json, number, context.pool);
+	const bool printed = print_json("arena", json, &context);
+
+	mcJSON_ArenaDestroy(context.pool);
+	if (allocations != 0) {
+		fprintf(stderr, "ERROR: %zu allocations of the arena weren't freed!\n", allocations);
+		return false;
+	}
+
+	return printed;
+}
+
+/* every way of parsing with a context only uses its allocator */
+static bool test_parse_paths(void) {
+	size_t allocations = 0;
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.malloc_fn = counting_malloc;
+	context.free_fn = counting_free;
+	context.userdata = &allocations;
+
+	/* the long number doesn't fit the stack copy that is passed to strtod */
+	buffer_create_from_string(json_string,
+		"{\"long number\": 0.12345678901234567890123456789012345678901234567890123456789012345678901234567890,"
+		" \"esc\\u0061ped\": [true, \"string\"]}");
+
+	mcJSON *json = mcJSON_ParseIndexedWithContext(json_string, &context);
+	if ((json == NULL) || !print_json("indexed", json, &context)) {
+		fprintf(stderr, "ERROR: Failed to parse indexed with the context!\n");
+		mcJSON_DeleteWithContext(json, &context);
+		return false;
+	}
+	mcJSON_DeleteWithContext(json, &context);
+
+	/* incremental parsing, in chunks that split the long number */
+	mcJSON_Parser *parser = mcJSON_ParserCreateWithContext(&context);
+	if (parser == NULL) {
+		fprintf(stderr, "ERROR: Failed to create a parser with the context!\n");
+		return false;
+	}
+	for (size_t offset = 0; offset < (json_string->content_length - 1); offset += 20) {
+		const size_t length = ((offset + 20) < (json_string->content_length - 1)) ? 20 : (json_string->content_length - 1 - offset);
+		buffer_create_with_existing_array(chunk, json_string->content + offset, length);
+		mcJSON_ParserFeed(parser, chunk);
+	}
+	json = mcJSON_ParserFinish(parser);
+	if ((json == NULL) || !print_json("incremental", json, &context)) {
+		fprintf(stderr, "ERROR: Failed to parse incrementally with the context!\n");
+		mcJSON_DeleteWithContext(json, &context);
+		return false;
+	}
+	mcJSON_DeleteWithContext(json, &context);
+
+	/* a failed incremental parse deletes the partial tree with the context */
+	parser = mcJSON_ParserCreateWithContext(&context);
+	buffer_create_from_string(invalid_string, "{\"name\": [1, 2, {\"nested\": \"string\"},]}");
+	if ((parser == NULL) || mcJSON_ParserFeed(parser, invalid_string) || (mcJSON_ParserFinish(parser) != NULL)) {
+		fprintf(stderr, "ERROR: Invalid json was parsed incrementally!\n");
+		return false;
+	}
+
+	json = mcJSON_ParseBufferedWithContext(json_string, mcJSON_ParseBufferSize(json_string), &context);
+	if ((json == NULL) || !print_json("buffered", json, &context)) {
+		fprintf(stderr, "ERROR: Failed to parse buffered with the context!\n");
+		return false;
+	}
+	context.free_fn(context.userdata, json);
+
+	if (allocations != 0) {
+		fprintf(stderr, "ERROR: %zu allocations of the context weren't freed!\n", allocations);
+		return false;
+	}
+
+	/* escaped keys are compared without allocating */
+	mcJSON_Cursor cursor;
+	buffer_create_from_string(escaped_name, "escaped");
+	mcJSON_CursorInit(&cursor, json_string);
+	if (!mcJSON_CursorEnter(&cursor) || !mcJSON_CursorFindField(&cursor, escaped_name) || (mcJSON_CursorType(&cursor) != mcJSON_Array)) {
+		fprintf(stderr, "ERROR: Failed to find the escaped key!\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* change a tree that was parsed with a context */
+static bool test_mutation(void) {
+	size_t allocations = 0;
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.malloc_fn = counting_malloc;
+	context.free_fn = counting_free;
+	context.userdata = &allocations;
+
+	buffer_create_from_string(json_string, "{\"array\": [1, 2, 3], \"replaced\": \"old\", \"deleted\": null}");
+	mcJSON *json = mcJSON_ParseWithContext(json_string, &context);
+	if (json == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse the tree to change!\n");
+		return false;
+	}
+
+	buffer_create_from_string(name, "name");
+	buffer_create_from_string(value, "value");
+	buffer_create_from_string(binary, "\x01\xff");
+	buffer_create_from_string(hex, "hex");
+	buffer_create_from_string(replaced, "replaced");
+	buffer_create_from_string(deleted, "deleted");
+	buffer_create_from_string(array_name, "array");
+	const int numbers[] = {4, 5};
+	mcJSON *array = mcJSON_GetObjectItem(json, array_name);
+	mcJSON_AddItemToObjectWithContext(json, name, mcJSON_CreateStringWithContext(value, &context), &context);
+	mcJSON_AddItemToObjectWithContext(json, hex, mcJSON_CreateHexStringWithContext(binary, &context), &context);
+	mcJSON_AddItemToObjectWithContext(json, deleted, mcJSON_CreateIntArrayWithContext(numbers, 2, &context), &context);
+	mcJSON_AddItemReferenceToArrayWithContext(array, mcJSON_GetObjectItem(json, name), &context);
+	mcJSON_ReplaceItemInObjectWithContext(json, replaced, mcJSON_CreateBoolWithContext(true, &context), &context);
+	mcJSON_ReplaceItemInArrayWithContext(array, 0, mcJSON_CreateInt64WithContext(-1, &context), &context);
+	mcJSON_DeleteItemFromArrayWithContext(array, 1, &context);
+	mcJSON_DeleteItemFromObjectWithContext(json, deleted, &context);
+	mcJSON *duplicate = mcJSON_DuplicateWithContext(json, 1, &context);
+	mcJSON_AddItemToObjectWithContext(json, name, duplicate, &context);
+	const bool printed = print_json("changed", json, &context);
+	mcJSON_DeleteWithContext(json, &context);
+	if (!printed) {
+		return false;
+	}
+	if (allocations != 0) {
+		fprintf(stderr, "ERROR: %zu allocations of the changed tree weren't freed!\n", allocations);
+		return false;
+	}
+
+	/* replaced and deleted items of a tree in an arena stay in the arena */
+	context.pool = mcJSON_ArenaCreateWithContext(64, &context);
+	json = (context.pool == NULL) ? NULL : mcJSON_ParseWithContext(json_string, &context);
+	if (json == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse the tree to change into an arena!\n");
+		mcJSON_ArenaDestroy(context.pool);
+		return false;
+	}
+	mcJSON_ReplaceItemInObject(json, replaced, mcJSON_CreateNull(context.pool), context.pool);
+	mcJSON_DeleteItemFromObjectWithContext(json, deleted, &context);
+	mcJSON_AddItemToObject(json, name, mcJSON_Duplicate(json, 1, context.pool), context.pool);
+	const bool printed_arena = print_json("changed arena", json, &context);
+	mcJSON_ArenaDestroy(context.pool);
+	if (allocations != 0) {
+		fprintf(stderr, "ERROR: %zu allocations of the arena weren't freed!\n", allocations);
+		return false;
+	}
+
+	return printed_arena;
+}
+
+/* the limits of a context */
+static bool test_limits(void) {
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+
+	buffer_create_from_string(json_string, "[1, 2, 3]");
+	context.max_length = json_string->content_length - 1;
+	if (mcJSON_ParseWithContext(json_string, &context) != NULL) {
+		fprintf(stderr, "ERROR: json longer than max_length was parsed!\n");
+		return false;
+	}
+
+	context.max_length = json_string->content_length;
+	mcJSON *json = mcJSON_ParseWithContext(json_string, &context);
+	if (json == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse json that isn't longer than max_length!\n");
+		return false;
+	}
+	const bool printed = print_json("limits", json, &context);
+	mcJSON_DeleteWithContext(json, &context);
+
+	return printed;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const mcJSON_Hooks hooks = {hook_malloc, free};
+	mcJSON_InitHooks(&hooks);
+	bool success = test_heap(false) && test_heap(true) && test_arena() && test_parse_paths() && test_mutation();
+	if (success && (hook_allocations != 0)) {
+		fprintf(stderr, "ERROR: The global hooks were used %zu times!\n", hook_allocations);
+		success = false;
+	}
+	mcJSON_InitHooks(NULL);
+	success = success && test_limits();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdarg.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static void print(const char *format, ...) {
+	va_list arguments;
+	va_start(arguments, format);
+	vprintf(format, arguments);
+	va_end(arguments);
+	if (output_file != NULL) {
+		va_start(arguments, format);
+		vfprintf(output_file, format, arguments);
+		va_end(arguments);
+	}
+}
+
+static bool find_field(mcJSON_Cursor *cursor, const char *name) {
+	buffer_create_with_existing_array(name_buffer, (unsigned char*)name, strlen(name) + 1);
+	return mcJSON_CursorFindField(cursor, name_buffer);
+}
+
+static int fail(const char *message) {
+	fprintf(stderr, "ERROR: %s!\n", message);
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+	return EXIT_FAILURE;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	buffer_create_from_string(json,
+		"{\"Image\": {\"Width\": 800, \"Height\": 600, \"Title\": \"View from 15th Floor\","
+		"\"Thumbnail\": {\"Url\": \"http://www.example.com/image/481989943\", \"Height\": 125, \"Width\": \"100\"},"
+		"\"Skipped\": [[1, {\"]\": \"[\\\"\"}], \"}\", {}],"
+		"\"Ani\\/mated\" : false, \"IDs\": [116, 943, 234, 38793], \"Ratio\": 1.25e-1}}");
+
+	mcJSON_Cursor cursor;
+	if (!mcJSON_CursorInit(&cursor, json) || !mcJSON_CursorEnter(&cursor)
+			|| !find_field(&cursor, "Image") || !mcJSON_CursorEnter(&cursor)) {
+		return fail("Failed to enter the image");
+	}
+
+	int64_t width;
+	int64_t height;
+	if (!find_field(&cursor, "Width") || !mcJSON_CursorGetInt64(&cursor, &width)
+			|| !find_field(&cursor, "Height") || !mcJSON_CursorGetInt64(&cursor, &height)) {
+		return fail("Failed to get the size");
+	}
+	print("size: %" PRId64 "x%" PRId64 "\n", width, height);
+
+	buffer_t title[1];
+	if (!find_field(&cursor, "Title") || !mcJSON_CursorGetString(&cursor, title)) {
+		return fail("Failed to get the title");
+	}
+	print("title: %.*s\n", (int)title->content_length - 1, (const char*)title->content);
+
+	/* the thumbnail and the array after it are skipped */
+	bool animated = true;
+	if (!find_field(&cursor, "Ani/mated") || !mcJSON_CursorGetBool(&cursor, &animated)) {
+		return fail("Failed to find an escaped name");
+	}
+	print("animated: %s\n", animated ? "true" : "false");
+
+	if (!find_field(&cursor, "IDs") || !mcJSON_CursorEnter(&cursor)) {
+		return fail("Failed to enter the IDs");
+	}
+	do {
+		double id;
+		if (!mcJSON_CursorGetDouble(&cursor, &id)) {
+			return fail("Failed to get an ID");
+		}
+		print("id: %g\n", id);
+	} while (mcJSON_CursorNext(&cursor));
+	if (mcJSON_CursorType(&cursor) != 0) {
+		return fail("Cursor is not at the end of the IDs");
+	}
+
+	/* leaving moves on to the value after the array */
+	double ratio;
+	if (!mcJSON_CursorLeave(&cursor) || !mcJSON_CursorGetDouble(&cursor, &ratio)) {
+		return fail("Failed to leave the IDs");
+	}
+	print("ratio: %g\n", ratio);
+
+	/* fields that come before the cursor aren't found anymore */
+	if (find_field(&cursor, "Width") || mcJSON_CursorLeave(&cursor) || mcJSON_CursorLeave(&cursor) || mcJSON_CursorLeave(&cursor)) {
+		return fail("Cursor moved past the end");
+	}
+
+	/* start again and get the thumbnail as a tree */
+	if (!mcJSON_CursorInit(&cursor, json) || !mcJSON_CursorEnter(&cursor) || !mcJSON_CursorEnter(&cursor)
+			|| !find_field(&cursor, "Thumbnail")) {
+		return fail("Failed to find the thumbnail");
+	}
+	mcJSON *thumbnail = mcJSON_CursorGetValue(&cursor, NULL);
+	if (thumbnail == NULL) {
+		return fail("Failed to parse the thumbnail");
+	}
+	buffer_t *printed = mcJSON_PrintUnformatted(thumbnail);
+	mcJSON_Delete(thumbnail);
+	if (printed == NULL) {
+		return fail("Failed to print the thumbnail");
+	}
+	print("thumbnail: %.*s\n", (int)printed->content_length - 1, (const char*)printed->content);
+	buffer_destroy_from_heap(printed);
+
+	/* wrong types */
+	if (mcJSON_CursorGetInt64(&cursor, &width) || mcJSON_CursorGetString(&cursor, title)
+			|| !find_field(&cursor, "Skipped") || !mcJSON_CursorEnter(&cursor) || !mcJSON_CursorNext(&cursor)
+			|| mcJSON_CursorEnter(&cursor) || (mcJSON_CursorType(&cursor) != mcJSON_String)) {
+		return fail("Got a value with the wrong type");
+	}
+
+	/* malformed text makes the cursor stop */
+	buffer_create_from_string(malformed, "[1, {\"a\": \"unterminated}, 2]");
+	if (!mcJSON_CursorInit(&cursor, malformed) || !mcJSON_CursorEnter(&cursor)
+			|| !mcJSON_CursorNext(&cursor) || mcJSON_CursorNext(&cursor) || (mcJSON_CursorType(&cursor) != 0)) {
+		return fail("Cursor didn't stop at malformed text");
+	}
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static void print_result(const char * const label, const char * const result) {
+	printf("%s: %s\n", label, result);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %s\n", label, result);
+	}
+}
+
+/* deeper than any recursive parser could go on the C stack */
+#define DEEP 100000
+
+/* open contains levels arrays or objects */
+static bool test_deep(const char * const label, const char * const open, const size_t levels, const char * const value, const char * const close) {
+	const size_t open_length = strlen(open);
+	const size_t close_length = strlen(close);
+	const size_t length = DEEP * (open_length + close_length) + strlen(value) + 1;
+	buffer_t *json = buffer_create_on_heap(length, length);
+	if (json == NULL) {
+		return false;
+	}
+	size_t position = 0;
+	for (size_t i = 0; i < DEEP; i++, position += open_length) {
+		memcpy(json->content + position, open, open_length);
+	}
+	memcpy(json->content + position, value, strlen(value));
+	position += strlen(value);
+	for (size_t i = 0; i < DEEP; i++, position += close_length) {
+		memcpy(json->content + position, close, close_length);
+	}
+	json->content[position] = '\0';
+
+	bool success = false;
+	mempool_t *arena = mcJSON_ArenaCreate(1 << 16);
+	if (arena == NULL) {
+		goto cleanup;
+	}
+	mcJSON *root = mcJSON_ParseWithBuffer(json, arena);
+	if (root == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse %s!\n", label);
+		goto cleanup;
+	}
+
+	/* walk down to the innermost value */
+	size_t depth = 0;
+	while ((root->child != NULL) && (root->length == 1)) {
+		root = root->child;
+		depth++;
+	}
+	if ((depth != (levels * DEEP)) || (root->type != mcJSON_Number)) {
+		fprintf(stderr, "ERROR: Wrong depth %zu for %s!\n", depth, label);
+		goto cleanup;
+	}
+	print_result(label, "parsed");
+	success = true;
+
+cleanup:
+	mcJSON_ArenaDestroy(arena);
+	buffer_destroy_from_heap(json);
+	return success;
+}
+
+/* deep enough to overflow the C stack when deleting recursively */
+#define HEAP_DEEP 1000000
+
+/* HEAP_DEEP '[', a number and close_count times close */
+static buffer_t *create_nested_arrays(const unsigned char close, const size_t close_count) {
+	const size_t length = HEAP_DEEP + 1 + close_count + 1;
+	buffer_t *json = buffer_create_on_heap(length, length);
+	if (json == NULL) {
+		return NULL;
+	}
+	memset(json->content, '[', HEAP_DEEP);
+	json->content[HEAP_DEEP] = '1';
+	memset(json->content + HEAP_DEEP + 1, close, close_count);
+	json->content[length - 1] = '\0';
+
+	return json;
+}
+
+/* parse into and delete from the heap, also when parsing fails */
+static bool test_deep_heap(void) {
+	buffer_t *json = create_nested_arrays(']', HEAP_DEEP);
+	if (json == NULL) {
+		return false;
+	}
+	mcJSON *root = mcJSON_Parse(json);
+	buffer_destroy_from_heap(json);
+	if (root == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse deep arrays on the heap!\n");
+		return false;
+	}
+	mcJSON_Delete(root);
+	print_result("deep arrays on the heap", "parsed and deleted");
+
+/* the partially parsed tree is deleted when the parser fails */
+	json = create_nested_arrays('}', 1);
+	if (json == NULL) {
+		return false;
+	}
+	root = mcJSON_Parse(json);
+	buffer_destroy_from_heap(json);
+	if (root != NULL) {
+		fprintf(stderr, "ERROR: Parsed deep arrays closed by '}'!\n");
+		mcJSON_Delete(root);
+		return false;
+	}
+	print_result("deep arrays closed by '}'", "failed");
+
+	return true;
+}
+
+/* the structural index is turned into a tree without recursing as well */
+static bool test_deep_indexed(void) {
+	buffer_t *json = create_nested_arrays(']', HEAP_DEEP);
+	if (json == NULL) {
+		return false;
+	}
+	mcJSON *root = mcJSON_ParseIndexed(json, NULL);
+	buffer_destroy_from_heap(json);
+	if (root == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse deep arrays with the structural index!\n");
+		return false;
+	}
+	mcJSON_Delete(root);
+	print_result("deep arrays with the structural index", "parsed and deleted");
+
+	json = create_nested_arrays('}', 1);
+	if (json == NULL) {
+		return false;
+	}
+	root = mcJSON_ParseIndexed(json, NULL);
+	buffer_destroy_from_heap(json);
+	if (root != NULL) {
+		fprintf(stderr, "ERROR: Parsed deep arrays closed by '}' with the structural index!\n");
+		mcJSON_Delete(root);
+		return false;
+	}
+	print_result("deep arrays closed by '}' with the structural index", "failed");
+
+	return true;
+}
+
+static const char * const limited[] = {
+	"[[[]]]",
+	"[[[[]]]]",
+	"{\"a\": [{}]}",
+	"{\"a\": [{\"b\": {}}]}",
+	"[1, [2, [3]], [4]]",
+	"[1, [2, [3, [4]]]]",
+	"[[[\"not too deep\"]], {\"a\": {\"b\": null}}]",
+	"[[[1]], {\"a\": {\"b\": [null]}}]"
+};
+
+static bool test_max_depth(void) {
+	const mcJSON_ParseOptions options = {
+		false, /* borrow_strings */
+		false, /* in_situ */
+		3, /* max_depth */
+		false, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.options = &options;
+
+	for (size_t i = 0; i < (sizeof(limited) / sizeof(limited[0])); i++) {
+		buffer_t json_buffer;
+		buffer_t *json = buffer_init_with_pointer(&json_buffer, (unsigned char*)limited[i], strlen(limited[i]) + 1, strlen(limited[i]) + 1);
+		mcJSON *root = mcJSON_ParseWithOptions(json, NULL, &options);
+		print_result(limited[i], (root != NULL) ? "parsed" : "too deep");
+
+		/* the structural index has the same limit */
+		mcJSON *indexed = mcJSON_ParseIndexedWithContext(json, &context);
+		const bool agrees = ((root != NULL) == (indexed != NULL));
+		mcJSON_Delete(root);
+		mcJSON_Delete(indexed);
+		if (!agrees) {
+			fprintf(stderr, "ERROR: The structural index doesn't limit the depth of %s like the parser!\n", limited[i]);
+			return false;
+		}
+	}
+
+	/* deep json fails early instead of being parsed completely */
+	buffer_t *deep = create_nested_arrays(']', HEAP_DEEP);
+	if (deep == NULL) {
+		return false;
+	}
+	mcJSON *root = mcJSON_ParseIndexedWithContext(deep, &context);
+	buffer_destroy_from_heap(deep);
+	print_result("deep arrays with the structural index and max_depth", (root != NULL) ? "parsed" : "too deep");
+	mcJSON_Delete(root);
+
+	return root == NULL;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_deep("deep arrays", "[", 1, "1", "]")
+		&& test_deep("deep objects", "{\"a\": ", 1, "2", "}")
+		&& test_deep("deep mixed", "[{\"b\":", 2, "3", "}]")
+		&& test_deep_heap()
+		&& test_deep_indexed()
+		&& test_max_depth();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
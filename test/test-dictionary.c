@@ -0,0 +1,300 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "../mcJSON_Dictionary.h"
+
+static FILE *output_file = NULL;
+
+static void print_line(const char * const label, const char * const text) {
+	printf("%s: %s\n", label, text);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %s\n", label, text);
+	}
+}
+
+static void print_count(const char * const label, const size_t count) {
+	printf("%s: %zu\n", label, count);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %zu\n", label, count);
+	}
+}
+
+static bool print_json(const char * const label, mcJSON * const json) {
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	print_line(label, (char*)output->content);
+	buffer_destroy_from_heap(output);
+
+	return true;
+}
+
+static mcJSON *parse(const char * const json, mempool_t * const pool, const mcJSON_ParseOptions * const options) {
+	buffer_create_with_existing_array(input, (unsigned char*)json, strlen(json) + 1);
+	mcJSON *result = mcJSON_ParseWithOptions(input, pool, options);
+	if (result == NULL) {
+		fprintf(stderr, "ERROR: Failed to parse %s!\n", json);
+	}
+
+	return result;
+}
+
+static mcJSON *member(mcJSON * const object, const char * const name) {
+	buffer_create_with_existing_array(key, (unsigned char*)name, strlen(name) + 1);
+	return mcJSON_GetObjectItem(object, key);
+}
+
+/* names of separate documents are the names of the dictionary */
+static bool test_shared_names(mcJSON_KeyDictionary * const dictionary, mempool_t * const pool, const mcJSON_ParseOptions * const options) {
+	mcJSON *first = parse("{\"id\": 1, \"name\": \"first\", \"t\\u0061gs\": []}", pool, options);
+	mcJSON *second = parse("{\"name\": \"second\", \"id\": 2, \"tags\": [\"a\"]}", pool, options);
+	bool success = false;
+	if ((first == NULL) || (second == NULL)) {
+		goto cleanup;
+	}
+
+	if (!print_json("first", first) || !print_json("second", second)) {
+		goto cleanup;
+	}
+	buffer_create_from_string(id_name, "id");
+	const buffer_t *id = mcJSON_KeyDictionaryAdd(dictionary, id_name);
+	if ((member(first, "id")->name != id)
+			|| (member(second, "id")->name != id)
+			|| (member(first, "tags")->name != member(second, "tags")->name)
+			|| !member(second, "name")->string_is_const) {
+		fprintf(stderr, "ERROR: Names aren't shared!\n");
+		goto cleanup;
+	}
+	print_line(options->borrow_strings ? "borrowed names shared" : "names shared", "yes");
+	success = true;
+
+cleanup:
+	if (pool == NULL) {
+		mcJSON_Delete(first);
+		mcJSON_Delete(second);
+	}
+	return success;
+}
+
+/* a full dictionary still resolves the names it knows */
+static bool test_limit(mcJSON_KeyDictionary * const dictionary, const mcJSON_ParseOptions * const options) {
+	mcJSON *json = parse("{\"id\": 1, \"a\": 2, \"b\": 3, \"c\": 4, \"d\": 5, \"name\": 6}", NULL, options);
+	if (json == NULL) {
+		return false;
+	}
+
+	bool success = print_json("limit", json);
+	print_count("known names", mcJSON_KeyDictionaryCount(dictionary));
+	print_line("known id", member(json, "id")->string_is_const ? "yes" : "no");
+	print_line("known d", member(json, "d")->string_is_const ? "yes" : "no");
+	print_line("known name", member(json, "name")->string_is_const ? "yes" : "no");
+	mcJSON_Delete(json);
+
+	return success;
+}
+
+/* resolver that only knows "id" and counts how often it is called */
+static size_t resolver_calls = 0;
+static buffer_t *counting_resolver(void * const userdata, const unsigned char * const name, const size_t length) {
+	resolver_calls++;
+	buffer_t * const id = (buffer_t*)userdata;
+	if ((length != (id->content_length - 1)) || (memcmp(name, id->content, length) != 0)) {
+		return NULL;
+	}
+
+	return id;
+}
+
+/* every name is resolved once, names with escape sequences after unescaping them */
+static bool test_resolver_calls(void) {
+	buffer_create_from_string(id, "id");
+	mcJSON_ParseOptions options;
+	memset(&options, 0, sizeof(options));
+	options.validate_utf8 = true;
+	options.resolve_name = counting_resolver;
+	options.resolver_data = id;
+
+	mcJSON *json = parse("{\"id\": 1, \"unknown\": 2, \"\\u0069d\": 3, \"esc\\u0061ped\": 4}", NULL, &options);
+	if (json == NULL) {
+		return false;
+	}
+	const bool success = (json->child->name == id) && (json->child->next->next->name == id);
+	mcJSON_Delete(json);
+	print_count("resolver calls for 4 names", resolver_calls);
+
+	return success && (resolver_calls == 4);
+}
+
+#define THREADS 4
+#define RECORDS_PER_THREAD 1000
+
+typedef struct worker {
+	pthread_t thread;
+	const mcJSON_ParseOptions *options;
+	bool success;
+} worker;
+
+static void *worker_run(void *argument) {
+	worker * const self = (worker*)argument;
+	mempool_t *pool = buffer_create_on_heap(4096, 0);
+	if (pool == NULL) {
+		return NULL;
+	}
+	char record[100];
+	char expected[100];
+	for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+		snprintf(record, sizeof(record), "{\"key%d\": %d, \"id\": %d, \"line\\nbreak\": true}", i % 16, i, i);
+		snprintf(expected, sizeof(expected), "{\"key%d\":%d,\"id\":%d,\"line\\nbreak\":true}", i % 16, i, i);
+		pool->position = 0;
+		buffer_create_with_existing_array(input, (unsigned char*)record, strlen(record) + 1);
+		mcJSON *json = mcJSON_ParseWithOptions(input, pool, self->options);
+		if ((json == NULL) || !json->child->string_is_const || !json->child->next->string_is_const) {
+			buffer_destroy_from_heap(pool);
+			return NULL;
+		}
+
+		/* printing only reads the shared names */
+		buffer_t *output = mcJSON_PrintUnformatted(json);
+		const bool printed = (output != NULL) && (strcmp((char*)output->content, expected) == 0);
+		if (output != NULL) {
+			buffer_destroy_from_heap(output);
+		}
+		if (!printed) {
+			buffer_destroy_from_heap(pool);
+			return NULL;
+		}
+	}
+	buffer_destroy_from_heap(pool);
+	self->success = true;
+
+	return NULL;
+}
+
+/* many threads learn, resolve and print names at the same time */
+static bool test_threads(void) {
+	mcJSON_KeyDictionary *dictionary = mcJSON_KeyDictionaryCreate(100);
+	if (dictionary == NULL) {
+		return false;
+	}
+	mcJSON_ParseOptions options;
+	memset(&options, 0, sizeof(options));
+	mcJSON_KeyDictionaryAttach(dictionary, &options);
+
+	worker workers[THREADS];
+	size_t started = 0;
+	for (; started < THREADS; started++) {
+		workers[started].options = &options;
+		workers[started].success = false;
+		if (pthread_create(&workers[started].thread, NULL, worker_run, &workers[started]) != 0) {
+			break;
+		}
+	}
+	bool success = (started == THREADS);
+	for (size_t i = 0; i < started; i++) {
+		pthread_join(workers[i].thread, NULL);
+		success = success && workers[i].success;
+	}
+	print_count("names learned by threads", mcJSON_KeyDictionaryCount(dictionary));
+	mcJSON_KeyDictionaryDestroy(dictionary);
+
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	mcJSON_KeyDictionary *dictionary = mcJSON_KeyDictionaryCreate(5);
+	mempool_t *pool = buffer_create_on_heap(4096, 0);
+	bool success = (dictionary != NULL) && (pool != NULL);
+	if (success) {
+		mcJSON_ParseOptions options = {
+			false, /* borrow_strings */
+			false, /* in_situ */
+			0, /* max_depth */
+			false, /* validate_utf8 */
+			false, /* intern_names */
+			NULL, /* resolve_name */
+			NULL /* resolver_data */
+		};
+		mcJSON_KeyDictionaryAttach(dictionary, &options);
+		success = test_shared_names(dictionary, NULL, &options);
+		options.borrow_strings = true;
+		success = success && test_shared_names(dictionary, pool, &options);
+		options.borrow_strings = false;
+		success = success && test_limit(dictionary, &options);
+	}
+	success = success && test_resolver_calls();
+	success = success && test_threads();
+
+	mcJSON_KeyDictionaryDestroy(dictionary);
+	if (pool != NULL) {
+		buffer_destroy_from_heap(pool);
+	}
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static const char * const strings[] = {
+	"\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"",
+	"\"\\u0041\\u00e4\\u20AC\"",
+	"\"\\u0000 inside\"",
+	"\"\\uD834\\uDD1E clef\"",
+	"\"\\uDBFF\\uDFFF last\"",
+	"\"\\u041f\\u0440\\u0438\\u0432\\u0435\\u0442, \\u4e16\\u754c\"",
+	"\"mixed \\u00fc\\n\\u00f6\\t\\\"\\u00e4\\\"\"",
+	"\"\\u12G4\"",
+	"\"\\u12\"",
+	"\"\\uDD1E lone low surrogate\"",
+	"\"\\uD834 lone high surrogate\"",
+	"\"\\uD834\\u0041 unpaired\"",
+	"\"\\uD834\\uD834 two high surrogates\""
+};
+
+/* print the bytes of the decoded string, everything that isn't printable ASCII as hex */
+static void print_string(const size_t index, const mcJSON * const json) {
+	char line[256];
+	size_t length = (size_t)snprintf(line, sizeof(line), "string %zu: ", index);
+	if (json == NULL) {
+		snprintf(line + length, sizeof(line) - length, "invalid");
+	} else {
+		const buffer_t * const string = json->valuestring;
+		for (size_t i = 0; (i < (string->content_length - 1)) && (length < (sizeof(line) - 5)); i++) {
+			const unsigned char character = string->content[i];
+			if ((character >= 0x20) && (character < 0x7F)) {
+				line[length++] = (char)character;
+			} else {
+				length += (size_t)snprintf(line + length, sizeof(line) - length, "<%02X>", character);
+			}
+		}
+		line[length] = '\0';
+	}
+
+	printf("%s\n", line);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s\n", line);
+	}
+}
+
+static bool test_strings(const bool in_situ) {
+	const mcJSON_ParseOptions options = {
+		false, /* borrow_strings */
+		in_situ, /* in_situ */
+		0, /* max_depth */
+		true, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+
+	for (size_t i = 0; i < (sizeof(strings) / sizeof(strings[0])); i++) {
+		/* a copy, because in situ parsing changes it */
+		const size_t length = strlen(strings[i]) + 1;
+		buffer_t *json = buffer_create_on_heap(length, length);
+		if (json == NULL) {
+			return false;
+		}
+		memcpy(json->content, strings[i], length);
+		mcJSON *string = mcJSON_ParseWithOptions(json, NULL, &options);
+		print_string(i, string);
+		mcJSON_Delete(string);
+		buffer_destroy_from_heap(json);
+	}
+
+	return true;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* in situ, the output overwrites the escape sequences */
+	const bool success = test_strings(false) && test_strings(true);
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
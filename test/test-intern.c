@@ -0,0 +1,210 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static void print_line(const char * const label, const char * const text) {
+	printf("%s: %s\n", label, text);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %s\n", label, text);
+	}
+}
+
+static bool print_json(const char * const label, mcJSON * const json) {
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	print_line(label, (char*)output->content);
+	buffer_destroy_from_heap(output);
+
+	return true;
+}
+
+#define RECORDS 100
+
+/* an array of records that all have the same keys */
+static buffer_t *create_records(void) {
+	static const char record[] = "{\"id\": %d, \"name\": \"record\", \"nested\": {\"id\": %d, \"n\\u0061me\": null}},";
+	const size_t length = RECORDS * sizeof(record) + 3;
+	buffer_t *records = buffer_create_on_heap(length, 0);
+	if (records == NULL) {
+		return NULL;
+	}
+
+	size_t position = 0;
+	records->content[position++] = '[';
+	for (int i = 0; i < RECORDS; i++) {
+		position += (size_t)snprintf((char*)records->content + position, length - position, record, i, i);
+	}
+	records->content[position - 1] = ']'; /* replace the last ',' */
+	records->content[position] = '\0';
+	records->content_length = position + 1;
+
+	return records;
+}
+
+/* Parse the records into pool with the options, returns the used size of the pool. */
+static mcJSON *parse_records(buffer_t * const records, mempool_t * const pool, const mcJSON_ParseOptions * const options) {
+	pool->position = 0;
+	mcJSON *json = mcJSON_ParseWithOptions(records, pool, options);
+	if ((json == NULL) || (json->length != RECORDS)) {
+		fprintf(stderr, "ERROR: Failed to parse the records!\n");
+		return NULL;
+	}
+
+	return json;
+}
+
+static bool test_records(const bool borrow_strings) {
+	buffer_t *records = create_records();
+	mempool_t *pool = buffer_create_on_heap(RECORDS * 1024, 0);
+	if ((records == NULL) || (pool == NULL)) {
+		if (records != NULL) {
+			buffer_destroy_from_heap(records);
+		}
+		return false;
+	}
+	bool success = false;
+
+	mcJSON_ParseOptions options = {
+		borrow_strings, /* borrow_strings */
+		false, /* in_situ */
+		0, /* max_depth */
+		false, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+	mcJSON *json = parse_records(records, pool, &options);
+	if (json == NULL) {
+		goto cleanup;
+	}
+	const size_t copied_size = pool->position;
+	buffer_t *copied = mcJSON_PrintUnformatted(json);
+	if (copied == NULL) {
+		goto cleanup;
+	}
+
+	options.intern_names = true;
+	json = parse_records(records, pool, &options);
+	if (json == NULL) {
+		buffer_destroy_from_heap(copied);
+		goto cleanup;
+	}
+	const size_t interned_size = pool->position;
+	buffer_t *interned = mcJSON_PrintUnformatted(json);
+	const bool same = (interned != NULL) && (buffer_compare(copied, interned) == 0);
+	buffer_destroy_from_heap(copied);
+	if (interned != NULL) {
+		buffer_destroy_from_heap(interned);
+	}
+	if (!same) {
+		fprintf(stderr, "ERROR: Interning changed the tree!\n");
+		goto cleanup;
+	}
+	print_line(borrow_strings ? "borrowed smaller pool" : "smaller pool", (interned_size < copied_size) ? "yes" : "no");
+
+	/* the names of all records are shared, even the escaped one */
+	mcJSON *first = mcJSON_GetArrayItem(json, 0);
+	mcJSON *last = mcJSON_GetArrayItem(json, RECORDS - 1);
+	mcJSON *first_nested = mcJSON_GetObjectItem(first, first->child->next->next->name);
+	mcJSON *last_nested = mcJSON_GetObjectItem(last, first->child->next->next->name);
+	if ((first->child->name != last->child->name)
+			|| (first->child->name != first_nested->child->name)
+			|| (first_nested->child->next->name != last_nested->child->next->name)
+			|| (first->child->next->name != last_nested->child->next->name)
+			|| !first->child->string_is_const) {
+		fprintf(stderr, "ERROR: Names weren't interned!\n");
+		goto cleanup;
+	}
+	print_line(borrow_strings ? "borrowed names shared" : "names shared", "yes");
+
+	/* copies of interned names are owned by the copy */
+	mcJSON *duplicate = mcJSON_Duplicate(last, 1, NULL);
+	if ((duplicate == NULL) || duplicate->child->string_is_const || !print_json("duplicate", duplicate)) {
+		fprintf(stderr, "ERROR: Failed to duplicate interned names!\n");
+		mcJSON_Delete(duplicate);
+		goto cleanup;
+	}
+	mcJSON_Delete(duplicate);
+
+	success = true;
+
+cleanup:
+	buffer_destroy_from_heap(pool);
+	buffer_destroy_from_heap(records);
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_records(false) && test_records(true);
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
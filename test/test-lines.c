@@ -0,0 +1,168 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+typedef struct line_log {
+	FILE *output_file;
+	size_t records;
+	size_t failures;
+	size_t stop_after; /* stop after this many records, 0 means never */
+} line_log;
+
+static bool print_record(void * const userdata, mcJSON * const json, const size_t offset, const size_t length) {
+	line_log *log = (line_log*)userdata;
+	log->records++;
+
+	if (json == NULL) {
+		log->failures++;
+		printf("%zu+%zu: invalid\n", offset, length);
+		if (log->output_file != NULL) {
+			fprintf(log->output_file, "%zu+%zu: invalid\n", offset, length);
+		}
+	} else {
+		buffer_t *output = mcJSON_PrintUnformatted(json);
+		if (output == NULL) {
+			return false;
+		}
+		printf("%zu+%zu: %.*s\n", offset, length, (int)output->content_length - 1, (char*)output->content);
+		if (log->output_file != NULL) {
+			fprintf(log->output_file, "%zu+%zu: %.*s\n", offset, length, (int)output->content_length - 1, (char*)output->content);
+		}
+		buffer_destroy_from_heap(output);
+	}
+
+	return (log->stop_after == 0) || (log->records < log->stop_after);
+}
+
+/* allocator that fails for big allocations */
+#define ALLOCATION_LIMIT (1024 * 1024)
+static void *limited_malloc(size_t size) {
+	return (size > ALLOCATION_LIMIT) ? NULL : malloc(size);
+}
+
+/* A long invalid line is just an invalid record, it doesn't
+ * make the pool grow for it or stop the other records. */
+static bool test_long_invalid_line(FILE * const output_file) {
+	const size_t length = 100000;
+	buffer_t *lines = buffer_create_on_heap(length + 20, 0);
+	if (lines == NULL) {
+		return false;
+	}
+	memset(lines->content, 'x', length);
+	memcpy(lines->content + length, "\n[1]\n{\"a\": 2}", sizeof("\n[1]\n{\"a\": 2}"));
+	lines->content_length = length + sizeof("\n[1]\n{\"a\": 2}");
+
+	const mcJSON_Hooks limited_hooks = {limited_malloc, free};
+	mcJSON_InitHooks(&limited_hooks);
+	line_log log = {output_file, 0, 0, 0};
+	const bool success = mcJSON_ParseLines(lines, 64, print_record, &log) && (log.records == 3) && (log.failures == 1);
+	mcJSON_InitHooks(NULL);
+	buffer_destroy_from_heap(lines);
+
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE *output_file = NULL;
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	buffer_create_from_string(lines,
+		"{\"id\": 1, \"name\": \"first\"}\n"
+		"\n"
+		"  [1, 2, 3]\r\n"
+		"{\"id\": 2, \"name\": \n"
+		"\"string\"\n"
+		"1 2\n"
+		"{\"id\": 3, \"nested\": {\"list\": [true, false, null, \"a long string that doesn't fit into a small pool\"]}}");
+
+	/* the pool is too small for most records and has to grow */
+	line_log log = {output_file, 0, 0, 0};
+	if (!mcJSON_ParseLines(lines, 64, print_record, &log) || (log.records != 6) || (log.failures != 2)) {
+		fprintf(stderr, "ERROR: Failed to parse the lines!\n");
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+
+	if (!test_long_invalid_line(output_file)) {
+		fprintf(stderr, "ERROR: Failed to skip a long invalid line!\n");
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+
+	/* the callback can stop parsing */
+	line_log stopped_log = {NULL, 0, 0, 2};
+	if (mcJSON_ParseLines(lines, 4096, print_record, &stopped_log) || (stopped_log.records != 2)) {
+		fprintf(stderr, "ERROR: Failed to stop parsing!\n");
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return EXIT_SUCCESS;
+}
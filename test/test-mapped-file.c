@@ -0,0 +1,225 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON_File.h"
+
+static FILE *output_file = NULL;
+
+static bool print_json(const char * const label, mcJSON * const json) {
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	printf("%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	}
+	buffer_destroy_from_heap(output);
+
+	return true;
+}
+
+static bool write_file(const char * const path, const char * const content, const size_t length) {
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) {
+		fprintf(stderr, "ERROR: Failed to open file '%s'\n", path);
+		return false;
+	}
+	const bool success = fwrite(content, 1, length, file) == length;
+	fclose(file);
+
+	return success;
+}
+
+/* the file has to be mapped and the borrowed string has to point into the mapping */
+static bool borrowed_from_mapping(const char * const label, const mcJSON_File * const file, const mcJSON * const string) {
+	size_t length = 0;
+	const unsigned char *content = mcJSON_FileContent(file, &length);
+	if (!mcJSON_FileIsMapped(file)) {
+		fprintf(stderr, "ERROR: The %s file wasn't mapped!\n", label);
+		return false;
+	}
+	if ((string == NULL)
+			|| (string->type != mcJSON_String)
+			|| (string->valuestring->content < content)
+			|| (string->valuestring->content >= (content + length))) {
+		fprintf(stderr, "ERROR: The string from the %s file wasn't borrowed from the mapping!\n", label);
+		return false;
+	}
+	printf("%s: mapped, borrowed \"%.*s\"\n", label, (int)string->valuestring->content_length - 1, (char*)string->valuestring->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: mapped, borrowed \"%.*s\"\n", label, (int)string->valuestring->content_length - 1, (char*)string->valuestring->content);
+	}
+
+	return true;
+}
+
+#define SMALL_FILE "test-mapped-file-small.json"
+static const char small_json[] = "{\"name\": \"mapped\", \"escaped\": \"\\\"quoted\\\"\", \"numbers\": [1, 2.5, -3], \"empty\": {}}\n";
+
+static bool test_small(void) {
+	if (!write_file(SMALL_FILE, small_json, sizeof(small_json) - 1)) {
+		return false;
+	}
+	bool success = false;
+	mempool_t *pool = NULL;
+
+	/* the file is closed right away */
+	mcJSON *json = mcJSON_ParseFile(SMALL_FILE, NULL, 0, NULL);
+	if ((json == NULL) || !print_json("small", json)) {
+		fprintf(stderr, "ERROR: Failed to parse small file!\n");
+		goto cleanup;
+	}
+	mcJSON_Delete(json);
+
+	/* borrowed strings need the file to stay open */
+	mcJSON_File *file = NULL;
+	pool = buffer_create_on_heap(1024, 0);
+	if (pool == NULL) {
+		goto cleanup;
+	}
+	json = mcJSON_ParseFile(SMALL_FILE, pool, mcJSON_FILE_BORROW_STRINGS, &file);
+	if ((json == NULL) || (file == NULL) || !print_json("small borrowed", json)) {
+		fprintf(stderr, "ERROR: Failed to parse small file with borrowed strings!\n");
+		mcJSON_FileClose(file);
+		goto cleanup;
+	}
+	if (!borrowed_from_mapping("small", file, json->child)) {
+		mcJSON_FileClose(file);
+		goto cleanup;
+	}
+	mcJSON_FileClose(file);
+
+	/* borrowing without keeping the file open isn't possible */
+	if (mcJSON_ParseFile(SMALL_FILE, NULL, mcJSON_FILE_BORROW_STRINGS, NULL) != NULL) {
+		fprintf(stderr, "ERROR: Borrowed strings from a closed file!\n");
+		goto cleanup;
+	}
+
+	success = true;
+
+cleanup:
+	if (pool != NULL) {
+		buffer_destroy_from_heap(pool);
+	}
+	remove(SMALL_FILE);
+	return success;
+}
+
+#define PAGE_FILE "test-mapped-file-page.json"
+/* multiple of every common page size, so the '\0' after the file doesn't fit into the mapping */
+#define PAGE_FILE_SIZE 65536
+
+static bool test_page_size(void) {
+	char *content = (char*)malloc(PAGE_FILE_SIZE);
+	if (content == NULL) {
+		return false;
+	}
+	memset(content, ' ', PAGE_FILE_SIZE);
+	size_t position = (size_t)sprintf(content, "[\"page\",");
+	for (size_t i = 0; i < 1000; i++) {
+		position += (size_t)sprintf(content + position, "%zu,", i);
+	}
+	content[position - 1] = ']'; /* replace the last ',' */
+	const bool written = write_file(PAGE_FILE, content, PAGE_FILE_SIZE);
+	free(content);
+	if (!written) {
+		return false;
+	}
+
+	mcJSON_File *file = NULL;
+	mcJSON *json = mcJSON_ParseFile(PAGE_FILE, NULL, mcJSON_FILE_BORROW_STRINGS, &file);
+	remove(PAGE_FILE);
+	if ((json == NULL) || (json->length != 1001)) {
+		fprintf(stderr, "ERROR: Failed to parse file with the size of a page!\n");
+		mcJSON_Delete(json);
+		mcJSON_FileClose(file);
+		return false;
+	}
+	const bool success = borrowed_from_mapping("page size", file, json->child)
+		&& print_json("page size last element", mcJSON_GetArrayItem(json, 1000));
+	mcJSON_Delete(json);
+	mcJSON_FileClose(file);
+
+	return success;
+}
+
+static bool test_missing(void) {
+	mcJSON_File *file = NULL;
+	if ((mcJSON_ParseFile("test-mapped-file-missing.json", NULL, 0, &file) != NULL) || (file != NULL)) {
+		fprintf(stderr, "ERROR: Parsed missing file!\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_small() && test_page_size() && test_missing();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
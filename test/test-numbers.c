@@ -0,0 +1,205 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../mcJSON.h"
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE *output_file = NULL;
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* numbers that hit the different code paths of the number parser */
+	const char *numbers[] = {
+		"0",
+		"-0",
+		"42",
+		"-2147483648",
+		"9007199254740993", /* 2^53 + 1 */
+		"18446744073709551615", /* 2^64 - 1 */
+		"123456789012345678901234567890",
+		"0.1",
+		"-3.14159",
+		"1.7976931348623157e308",
+		"2.2250738585072014e-308",
+		"4.9e-324",
+		"1e23",
+		"8.98846567431158e307",
+		"0.000000000000000000000000000001",
+		"1E+2",
+		"1e-2",
+		"1.",
+		"1e400",
+		"1e-400",
+		"2.22507385850720113605740979670913197593481954635164564e-308",
+		"9007199254740992.00000000000000000000001"
+	};
+
+	for (size_t i = 0; i < (sizeof(numbers) / sizeof(*numbers)); i++) {
+		buffer_create_with_existing_array(number_buffer, (unsigned char*)numbers[i], strlen(numbers[i]) + 1);
+		mcJSON *number = mcJSON_Parse(number_buffer);
+		if ((number == NULL) || (number->type != mcJSON_Number)) {
+			fprintf(stderr, "ERROR: Failed to parse '%s'!\n", numbers[i]);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
+		/* has to be exactly what strtod returns */
+		double expected = strtod(numbers[i], NULL);
+		if (memcmp(&expected, &number->valuedouble, sizeof(double)) != 0) {
+			fprintf(stderr, "ERROR: '%s' was parsed as %.17g instead of %.17g!\n", numbers[i], number->valuedouble, expected);
+			mcJSON_Delete(number);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
+		printf("%s: %.17g\n", numbers[i], number->valuedouble);
+		if (output_file != NULL) {
+			fprintf(output_file, "%s: %.17g\n", numbers[i], number->valuedouble);
+		}
+		mcJSON_Delete(number);
+	}
+
+	/* integers that have to stay exact */
+	struct {
+		const char *string;
+		bool is_int64;
+		int64_t value;
+	} integers[] = {
+		{"1234567890123456789", true, INT64_C(1234567890123456789)},
+		{"9223372036854775807", true, INT64_MAX},
+		{"-9223372036854775808", true, INT64_MIN},
+		{"9223372036854775808", false, 0},
+		{"-9007199254740993", true, INT64_C(-9007199254740993)},
+		{"1.0", false, 1},
+		{"1e3", false, 1000}
+	};
+	for (size_t i = 0; i < (sizeof(integers) / sizeof(*integers)); i++) {
+		buffer_create_with_existing_array(integer_buffer, (unsigned char*)integers[i].string, strlen(integers[i].string) + 1);
+		mcJSON *integer = mcJSON_Parse(integer_buffer);
+		if ((integer == NULL) || (mcJSON_IsInt64(integer) != integers[i].is_int64) || (mcJSON_GetInt64(integer) != integers[i].value)) {
+			fprintf(stderr, "ERROR: Failed to parse '%s' as 64 bit integer!\n", integers[i].string);
+			mcJSON_Delete(integer);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
+		buffer_t *printed = mcJSON_PrintUnformatted(integer);
+		mcJSON_Delete(integer);
+		if (printed == NULL) {
+			fprintf(stderr, "ERROR: Failed to print '%s'!\n", integers[i].string);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+		printf("%s: %s\n", integers[i].string, (char*)printed->content);
+		if (output_file != NULL) {
+			fprintf(output_file, "%s: %s\n", integers[i].string, (char*)printed->content);
+		}
+		buffer_destroy_from_heap(printed);
+	}
+
+	/* created integers are printed exactly as well */
+	mcJSON *created = mcJSON_CreateInt64(INT64_MIN + 1, NULL);
+	buffer_t *printed = mcJSON_PrintUnformatted(created);
+	mcJSON_Delete(created);
+	buffer_create_from_string(expected_string, "-9223372036854775807");
+	if ((printed == NULL) || (buffer_compare(printed, expected_string) != 0)) {
+		fprintf(stderr, "ERROR: Failed to print created 64 bit integer!\n");
+		if (printed != NULL) {
+			buffer_destroy_from_heap(printed);
+		}
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+	buffer_destroy_from_heap(printed);
+
+	/* things that aren't numbers */
+	const char *invalid[] = {
+		"-",
+		"-.",
+		"[-e1]"
+	};
+	for (size_t i = 0; i < (sizeof(invalid) / sizeof(*invalid)); i++) {
+		buffer_create_with_existing_array(invalid_buffer, (unsigned char*)invalid[i], strlen(invalid[i]) + 1);
+		mcJSON *number = mcJSON_Parse(invalid_buffer);
+		if (number != NULL) {
+			fprintf(stderr, "ERROR: Parsed invalid number '%s'!\n", invalid[i]);
+			mcJSON_Delete(number);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -321,6 +321,32 @@ int create_objects(FILE *output_file) {
 	buffer_destroy_from_heap(output);
 	mcJSON_Delete(root);
 
+	/* create objects in an arena that has to grow */
+	mempool_t *arena = mcJSON_ArenaCreate(0);
+	if (arena == NULL) {
+		return EXIT_FAILURE;
+	}
+	int squares[100];
+	for (i = 0; i < 100; i++) {
+		squares[i] = i * i;
+	}
+	root = mcJSON_CreateObject(arena);
+	buffer_create_from_string(squares_buffer, "squares");
+	mcJSON_AddItemToObject(root, squares_buffer, mcJSON_CreateIntArray(squares, 100, arena), arena);
+	mcJSON_AddStringToObject(root, name_buffer, jack_buffer, arena);
+	mcJSON_AddTrueToObject(root, interlace, arena);
+
+	output = mcJSON_PrintUnformatted(root);
+	mcJSON_ArenaDestroy(arena);
+	if (output == NULL) {
+		return EXIT_FAILURE;
+	}
+	printf("%.*s\n", (int)output->content_length, (char*)output->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%.*s\n", (int)output->content_length, (char*)output->content);
+	}
+	buffer_destroy_from_heap(output);
+
 	return 0;
 }
 
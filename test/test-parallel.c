@@ -0,0 +1,389 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../mcJSON_Parallel.h"
+
+#define RECORD_COUNT 20000
+#define BIG_ARRAY_COUNT 200000
+
+/* Records are hashed, the ordered checksum depends on the order
+ * of the records, the unordered one doesn't. */
+typedef struct record_log {
+	size_t records;
+	size_t invalid;
+	uint64_t ordered_checksum;
+	uint64_t unordered_checksum;
+	size_t stop_after; /* stop after this many records, 0 means never */
+} record_log;
+
+static uint64_t hash(uint64_t hash, const unsigned char *data, const size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ data[i]) * 1099511628211u;
+	}
+	return hash;
+}
+
+static bool log_record(void * const userdata, mcJSON * const json, const size_t offset, const size_t length) {
+	record_log *log = (record_log*)userdata;
+	log->records++;
+
+	uint64_t record_hash = hash(14695981039346656037u, (const unsigned char*)&offset, sizeof(offset));
+	record_hash = hash(record_hash, (const unsigned char*)&length, sizeof(length));
+	if (json == NULL) {
+		log->invalid++;
+	} else {
+		buffer_t *output = mcJSON_PrintUnformatted(json);
+		if (output == NULL) {
+			return false;
+		}
+		record_hash = hash(record_hash, output->content, output->content_length);
+		buffer_destroy_from_heap(output);
+	}
+	log->ordered_checksum = hash(log->ordered_checksum, (const unsigned char*)&record_hash, sizeof(record_hash));
+	log->unordered_checksum += record_hash;
+
+	return (log->stop_after == 0) || (log->records < log->stop_after);
+}
+
+/* Append a line with the given record number to the lines, some of them are invalid,
+ * empty, or big enough to not fit into the pool of a thread. */
+/* hooks that count the allocations, only used with one thread */
+static size_t allocations = 0;
+static size_t deallocations = 0;
+
+static void *counting_malloc(size_t size) {
+	allocations++;
+	return malloc(size);
+}
+
+static void counting_free(void *pointer) {
+	if (pointer != NULL) {
+		deallocations++;
+	}
+	free(pointer);
+}
+
+static bool count_record(void * const userdata, mcJSON * const json, const size_t offset, const size_t length) {
+	(void)json;
+	(void)offset;
+	(void)length;
+	(*(size_t*)userdata)++;
+	return true;
+}
+
+/* all memory is allocated with the hooks from mcJSON_InitHooks */
+static bool uses_hooks(buffer_t * const lines, const size_t record_count, buffer_t * const array) {
+	const mcJSON_Hooks hooks = {counting_malloc, counting_free};
+	mcJSON_InitHooks(&hooks);
+	allocations = 0;
+	deallocations = 0;
+
+	size_t records = 0;
+	bool success = mcJSONParallel_ParseLines(lines, 1, true, count_record, &records) && (records == record_count);
+	const size_t lines_allocations = allocations;
+	mcJSON *json = mcJSONParallel_Parse(array, 1);
+	success = success && (json != NULL) && (lines_allocations != 0) && (allocations > lines_allocations);
+	mcJSON_Delete(json);
+	success = success && (allocations == deallocations);
+	mcJSON_InitHooks(NULL);
+
+	return success;
+}
+
+static void append_record(buffer_t * const lines, const size_t number) {
+	char *line = (char*)lines->content + lines->content_length;
+	size_t space = lines->buffer_length - lines->content_length;
+	int length;
+	if ((number % 97) == 0) {
+		length = snprintf(line, space, "{\"id\": %zu, \"truncated\": \n", number);
+	} else if ((number % 101) == 0) {
+		length = snprintf(line, space, "  \n");
+	} else {
+		length = snprintf(line, space, "{\"id\": %zu, \"name\": \"record %zu\", \"values\": [%zu.5, true, null], \"nested\": {\"a\": []}}\n", number, number, number);
+	}
+	lines->content_length += (size_t)length;
+
+	if (number == (RECORD_COUNT / 2)) { /* one big array */
+		lines->content[lines->content_length++] = '[';
+		for (size_t i = 0; i < 100000; i++) {
+			memcpy(lines->content + lines->content_length, "1,", 2);
+			lines->content_length += 2;
+		}
+		memcpy(lines->content + lines->content_length, "1]\n", 3);
+		lines->content_length += 3;
+	}
+}
+
+/* Append an element of an array, followed by ',' */
+static void append_element(buffer_t * const array, const size_t number) {
+	char *element = (char*)array->content + array->content_length;
+	size_t space = array->buffer_length - array->content_length;
+	int length;
+	switch (number % 4) {
+		case 0:
+			length = snprintf(element, space, "{\"id\": %zu, \"values\": [%zu.5, true, null], \"nested\": {\"a\": []}},\n", number, number);
+			break;
+		case 1:
+			length = snprintf(element, space, "[%zu, \"]\\\"}\"],", number);
+			break;
+		case 2:
+			length = snprintf(element, space, "  %zu.25 ,", number);
+			break;
+		default:
+			length = snprintf(element, space, "\"record %zu\\n\",", number);
+			break;
+	}
+	array->content_length += (size_t)length;
+}
+
+/* Parse json into pool with mcJSONParallel_ParseWithBuffer and compare it to the serial tree. */
+static bool same_in_pool(buffer_t * const json, mempool_t * const pool, const size_t threads, const mcJSON * const serial, const buffer_t * const serial_output) {
+	mcJSON *parsed = (pool == NULL) ? NULL : mcJSONParallel_ParseWithBuffer(json, pool, threads);
+	buffer_t *output = (parsed == NULL) ? NULL : mcJSON_PrintUnformatted(parsed);
+	const bool same = (output != NULL) && (buffer_compare(serial_output, output) == 0) && (serial->length == parsed->length);
+	if (output != NULL) {
+		buffer_destroy_from_heap(output);
+	}
+
+	return same;
+}
+
+/* Parsing json with mcJSONParallel_Parse has to create the same tree as mcJSON_Parse,
+ * also in a pool of exactly the size that mcJSON_ParseBufferSize returns and in an arena
+ * that starts with the smallest block. */
+static bool same_as_parallel(buffer_t * const json, const size_t threads) {
+	mcJSON *serial = mcJSON_Parse(json);
+	mcJSON *parallel = mcJSONParallel_Parse(json, threads);
+	mempool_t *pool = buffer_create_on_heap(json->content_length * 32, 0);
+	mcJSON *buffered = (pool == NULL) ? NULL : mcJSONParallel_ParseWithBuffer(json, pool, threads);
+	buffer_t *serial_output = (serial == NULL) ? NULL : mcJSON_PrintUnformatted(serial);
+	buffer_t *parallel_output = (parallel == NULL) ? NULL : mcJSON_PrintUnformatted(parallel);
+	buffer_t *buffered_output = (buffered == NULL) ? NULL : mcJSON_PrintUnformatted(buffered);
+
+	bool same = (serial_output != NULL) && (parallel_output != NULL) && (buffered_output != NULL)
+		&& (buffer_compare(serial_output, parallel_output) == 0)
+		&& (buffer_compare(serial_output, buffered_output) == 0)
+		&& (serial->length == parallel->length) && (serial->length == buffered->length);
+
+	if (same) {
+		mempool_t *exact_pool = buffer_create_on_heap(mcJSON_ParseBufferSize(json), 0);
+		same = same_in_pool(json, exact_pool, threads, serial, serial_output);
+		if (exact_pool != NULL) {
+			buffer_destroy_from_heap(exact_pool);
+		}
+	}
+	if (same) {
+		mempool_t *arena = mcJSON_ArenaCreate(0);
+		same = same_in_pool(json, arena, threads, serial, serial_output);
+		mcJSON_ArenaDestroy(arena);
+	}
+
+	if (serial != NULL) {
+		mcJSON_Delete(serial);
+	}
+	if (parallel != NULL) {
+		mcJSON_Delete(parallel);
+	}
+	if (pool != NULL) {
+		buffer_destroy_from_heap(pool);
+	}
+	if (serial_output != NULL) {
+		buffer_destroy_from_heap(serial_output);
+	}
+	if (parallel_output != NULL) {
+		buffer_destroy_from_heap(parallel_output);
+	}
+	if (buffered_output != NULL) {
+		buffer_destroy_from_heap(buffered_output);
+	}
+
+	return same;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE *output_file = NULL;
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const size_t size = RECORD_COUNT * 128 + 300000;
+	buffer_t *lines = buffer_create_on_heap(size, 0);
+	if (lines == NULL) {
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < RECORD_COUNT; i++) {
+		append_record(lines, i);
+	}
+
+	/* every thread count has to deliver the same records as mcJSON_ParseLines */
+	record_log serial = {0, 0, 0, 0, 0};
+	bool success = mcJSON_ParseLines(lines, 4096, log_record, &serial);
+	printf("records: %zu\ninvalid: %zu\n", serial.records, serial.invalid);
+	if (output_file != NULL) {
+		fprintf(output_file, "records: %zu\ninvalid: %zu\n", serial.records, serial.invalid);
+	}
+
+	const size_t thread_counts[] = {1, 4, 0};
+	for (size_t i = 0; success && (i < (sizeof(thread_counts) / sizeof(*thread_counts))); i++) {
+		record_log ordered = {0, 0, 0, 0, 0};
+		record_log unordered = {0, 0, 0, 0, 0};
+		if (!mcJSONParallel_ParseLines(lines, thread_counts[i], true, log_record, &ordered)
+				|| !mcJSONParallel_ParseLines(lines, thread_counts[i], false, log_record, &unordered)
+				|| (ordered.records != serial.records) || (ordered.ordered_checksum != serial.ordered_checksum)
+				|| (unordered.records != serial.records) || (unordered.unordered_checksum != serial.unordered_checksum)) {
+			fprintf(stderr, "ERROR: Parsing with %zu threads delivered different records!\n", thread_counts[i]);
+			success = false;
+		}
+	}
+
+	/* the callback can stop parsing */
+	record_log stopped = {0, 0, 0, 0, 10};
+	if (success && (mcJSONParallel_ParseLines(lines, 4, false, log_record, &stopped) || (stopped.records != 10))) {
+		fprintf(stderr, "ERROR: Failed to stop parsing!\n");
+		success = false;
+	}
+
+	/* parsing one big array has to create the same tree as mcJSON_Parse */
+	buffer_t *array = buffer_create_on_heap(size, 0);
+	if (array == NULL) {
+		success = false;
+	} else {
+		array->content[array->content_length++] = '[';
+		for (size_t i = 0; i < RECORD_COUNT; i++) {
+			append_element(array, i);
+		}
+		memcpy(array->content + array->content_length, "\"last\"\n]", sizeof("\"last\"\n]"));
+		array->content_length += sizeof("\"last\"\n]");
+	}
+	for (size_t i = 0; success && (i < (sizeof(thread_counts) / sizeof(*thread_counts))); i++) {
+		if (!same_as_parallel(array, thread_counts[i])) {
+			fprintf(stderr, "ERROR: Parsing an array with %zu threads created a different tree!\n", thread_counts[i]);
+			success = false;
+		}
+	}
+	/* a lot of small elements, the arena has to grow in every thread */
+	buffer_t *big_array = buffer_create_on_heap(BIG_ARRAY_COUNT * 32 + 2, 0);
+	if (success && (big_array != NULL)) {
+		big_array->content[big_array->content_length++] = '[';
+		for (size_t i = 0; i < BIG_ARRAY_COUNT; i++) {
+			big_array->content_length += (size_t)sprintf((char*)big_array->content + big_array->content_length, (i == 0) ? "%zu" : ",%zu", i);
+		}
+		memcpy(big_array->content + big_array->content_length, "]", sizeof("]"));
+		big_array->content_length += sizeof("]");
+		if (!same_as_parallel(big_array, 4)) {
+			fprintf(stderr, "ERROR: Parsing an array with %d elements created a different tree!\n", BIG_ARRAY_COUNT);
+			success = false;
+		}
+	}
+	if (big_array != NULL) {
+		buffer_destroy_from_heap(big_array);
+	}
+	if (success && !uses_hooks(lines, serial.records, array)) {
+		fprintf(stderr, "ERROR: Memory wasn't allocated with the hooks!\n");
+		success = false;
+	}
+	buffer_destroy_from_heap(lines);
+	if (array != NULL) {
+		buffer_destroy_from_heap(array);
+	}
+
+	/* small arrays and other json */
+	const char *small_json[] = {"[]", " [ 1 , [2, []], \"x\" ] ", "{\"a\": [1]}", "\"string\""};
+	for (size_t i = 0; success && (i < (sizeof(small_json) / sizeof(*small_json))); i++) {
+		buffer_create_with_existing_array(json, (unsigned char*)small_json[i], strlen(small_json[i]) + 1);
+		if (!same_as_parallel(json, 4)) {
+			fprintf(stderr, "ERROR: Parsing '%s' in parallel created a different tree!\n", small_json[i]);
+			success = false;
+		}
+	}
+
+	/* invalid arrays */
+	const char *invalid_json[] = {"[1,]", "[,1]", "[1 2]", "[\"a\": 1]", "[1, tru]", "[1, {]", "[1",
+		/* the parser stops inside of these elements */
+		"[1x, 2]", "[1.2.3]", "[nullx]", "[truefalse]", "[1--2]", "[\"a\"b, 1]", "[[1] 2, 3]",
+		/* something follows the value */
+		"[1] x", "[1]]", "nullx", "1 2"};
+	const size_t invalid_thread_counts[] = {1, 2, 4};
+	for (size_t i = 0; success && (i < (sizeof(invalid_json) / sizeof(*invalid_json))); i++) {
+		buffer_create_with_existing_array(json, (unsigned char*)invalid_json[i], strlen(invalid_json[i]) + 1);
+		for (size_t j = 0; j < (sizeof(invalid_thread_counts) / sizeof(*invalid_thread_counts)); j++) {
+			mcJSON *parsed = mcJSONParallel_Parse(json, invalid_thread_counts[j]);
+			mempool_t *arena = mcJSON_ArenaCreate(0);
+			const mcJSON_PoolMarker marker = mcJSON_PoolMark(arena);
+			mcJSON *in_arena = (arena == NULL) ? NULL : mcJSONParallel_ParseWithBuffer(json, arena, invalid_thread_counts[j]);
+			const bool rolled_back = (arena != NULL) && (arena->content == marker.block) && (arena->position == marker.position);
+			mcJSON_ArenaDestroy(arena);
+			if ((parsed != NULL) || (in_arena != NULL) || !rolled_back) {
+				if (parsed != NULL) {
+					mcJSON_Delete(parsed);
+				}
+				fprintf(stderr, "ERROR: Parsed invalid json '%s' with %zu threads!\n", invalid_json[i], invalid_thread_counts[j]);
+				success = false;
+			}
+		}
+	}
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,217 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static bool print_json(const char * const label, mcJSON * const json) {
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	printf("%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	}
+	buffer_destroy_from_heap(output);
+
+	return true;
+}
+
+static bool is_zero(const mempool_t * const pool, const size_t start, const size_t end) {
+	for (size_t i = start; i < end; i++) {
+		if (pool->content[i] != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool test_pool(void) {
+	mempool_t *pool = buffer_create_on_heap(1024, 0);
+	if (pool == NULL) {
+		return false;
+	}
+	memset(pool->content, 0, pool->buffer_length);
+	bool success = false;
+
+	buffer_create_from_string(first_string, "{\"first\": [1, 2, 3]}");
+	mcJSON *first = mcJSON_ParseWithBuffer(first_string, pool);
+	if ((first == NULL) || !print_json("pool first", first)) {
+		goto cleanup;
+	}
+
+	/* a failed parse rolls the pool back and wipes what it allocated */
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(pool);
+	buffer_create_from_string(invalid_string, "{\"invalid\": [\"a\", \"b\", \"c\",]}");
+	if ((mcJSON_ParseWithBuffer(invalid_string, pool) != NULL)
+			|| (pool->position != marker.position)
+			|| !is_zero(pool, pool->position, pool->buffer_length)) {
+		fprintf(stderr, "ERROR: Failed parse wasn't rolled back!\n");
+		goto cleanup;
+	}
+
+	/* rolling back to a marker frees everything allocated after it */
+	buffer_create_from_string(second_string, "[\"second\", {\"nested\": null}]");
+	mcJSON *second = mcJSON_ParseWithBuffer(second_string, pool);
+	if ((second == NULL) || !print_json("pool second", second)) {
+		goto cleanup;
+	}
+	mcJSON_PoolRollback(pool, marker, false);
+	if (pool->position != marker.position) {
+		fprintf(stderr, "ERROR: Failed to roll back the pool!\n");
+		goto cleanup;
+	}
+	second = mcJSON_ParseWithBuffer(second_string, pool);
+	if ((second == NULL) || !print_json("pool second again", second) || !print_json("pool first again", first)) {
+		goto cleanup;
+	}
+
+	/* resetting with wipe zeroes everything */
+	mcJSON_PoolReset(pool, true);
+	if ((pool->position != 0) || !is_zero(pool, 0, pool->buffer_length)) {
+		fprintf(stderr, "ERROR: Failed to reset the pool!\n");
+		goto cleanup;
+	}
+
+	success = true;
+
+cleanup:
+	buffer_destroy_from_heap(pool);
+	return success;
+}
+
+static bool test_arena(void) {
+	mempool_t *arena = mcJSON_ArenaCreate(256);
+	if (arena == NULL) {
+		return false;
+	}
+	bool success = false;
+
+	buffer_create_from_string(first_string, "{\"first\": true}");
+	mcJSON *first = mcJSON_ParseWithBuffer(first_string, arena);
+	if ((first == NULL) || !print_json("arena first", first)) {
+		goto cleanup;
+	}
+	const mcJSON_PoolMarker marker = mcJSON_PoolMark(arena);
+
+	/* big enough to need more blocks */
+	buffer_create_from_string(big_string,
+		"{\"numbers\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16],"
+		" \"strings\": [\"one\", \"two\", \"three\", \"four\", \"five\", \"six\", \"seven\", \"eight\"],"
+		" \"objects\": [{\"a\": 1}, {\"b\": 2}, {\"c\": 3}, {\"d\": 4}]}");
+	mcJSON *big = mcJSON_ParseWithBuffer(big_string, arena);
+	if ((big == NULL) || (arena->content == marker.block) || !print_json("arena big", big)) {
+		fprintf(stderr, "ERROR: Failed to parse into new blocks!\n");
+		goto cleanup;
+	}
+
+	/* rolling back frees the new blocks */
+	mcJSON_PoolRollback(arena, marker, true);
+	if ((arena->content != marker.block) || (arena->position != marker.position)) {
+		fprintf(stderr, "ERROR: Failed to roll back the arena!\n");
+		goto cleanup;
+	}
+	if (!print_json("arena first again", first)) {
+		goto cleanup;
+	}
+
+	/* a failed parse that needed new blocks is rolled back as well */
+	buffer_create_from_string(invalid_string,
+		"[\"one\", \"two\", \"three\", \"four\", \"five\", \"six\", \"seven\", \"eight\","
+		" \"nine\", \"ten\", \"eleven\", \"twelve\", \"thirteen\", \"fourteen\", \"fifteen\", \"sixteen\",]");
+	if ((mcJSON_ParseWithBuffer(invalid_string, arena) != NULL)
+			|| (arena->content != marker.block) || (arena->position != marker.position)) {
+		fprintf(stderr, "ERROR: Failed parse in arena wasn't rolled back!\n");
+		goto cleanup;
+	}
+
+	/* after a reset, only one block is left */
+	big = mcJSON_ParseWithBuffer(big_string, arena);
+	if (big == NULL) {
+		goto cleanup;
+	}
+	mcJSON_PoolReset(arena, true);
+	big = mcJSON_ParseWithBuffer(big_string, arena);
+	if ((big == NULL) || !print_json("arena big after reset", big)) {
+		fprintf(stderr, "ERROR: Failed to parse after reset!\n");
+		goto cleanup;
+	}
+
+	success = true;
+
+cleanup:
+	mcJSON_ArenaDestroy(arena);
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_pool() && test_arena();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
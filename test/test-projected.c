@@ -0,0 +1,220 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+#include "../mcJSON_Utils.h"
+
+static FILE *output_file = NULL;
+
+static bool print_json(const char * const label, mcJSON * const json) {
+	buffer_t *output = mcJSON_PrintUnformatted(json);
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: Failed to print %s!\n", label);
+		return false;
+	}
+	printf("%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %.*s\n", label, (int)output->content_length - 1, (char*)output->content);
+	}
+	buffer_destroy_from_heap(output);
+
+	return true;
+}
+
+static const char document[] =
+	"{\"id\": 42, \"skipped\": {\"deep\": [1, {\"x\": \"]}\"}, [[]]], \"not\": \"needed\"},"
+	" \"user\": {\"name\": \"Alice\", \"tags\": [\"a\", \"b\"], \"address\": {\"city\": \"Berlin\", \"zip\": \"10115\"}},"
+	" \"items\": [{\"price\": 1}, {\"price\": 2}, {\"price\": 3}, {\"price\": 4}],"
+	" \"a/b\": 1, \"m~n\": 2, \"esc\\\"aped\": 3}";
+
+static const char * const pointers[] = {
+	"/id",
+	"/user/address/city",
+	"/items/2/price",
+	"/a~1b",
+	"/m~0n",
+	"/esc\"aped",
+	"/missing/value",
+	"/id/deeper"
+};
+
+static bool test_projection(mempool_t * const pool) {
+	buffer_create_from_string(json, document);
+	const size_t pointer_count = sizeof(pointers) / sizeof(pointers[0]);
+	mcJSON *projected = mcJSON_ParseProjected(json, pointers, pointer_count, pool);
+	if ((projected == NULL) || !print_json("projected", projected)) {
+		fprintf(stderr, "ERROR: Failed to parse projected!\n");
+		if (pool == NULL) {
+			mcJSON_Delete(projected);
+		}
+		return false;
+	}
+
+	/* every pointer has to find the same value as in the full tree */
+	bool success = true;
+	mcJSON *full = mcJSON_Parse(json);
+	for (size_t i = 0; (i < pointer_count) && success; i++) {
+		mcJSON *expected = mcJSONUtils_GetPointer(full, pointers[i]);
+		mcJSON *found = mcJSONUtils_GetPointer(projected, pointers[i]);
+		if ((expected == NULL) && (found == NULL)) {
+			continue;
+		}
+		if ((expected == NULL) || (found == NULL) || !print_json(pointers[i], found)) {
+			fprintf(stderr, "ERROR: Pointer '%s' differs!\n", pointers[i]);
+			success = false;
+		}
+	}
+	mcJSON_Delete(full);
+
+	if (pool == NULL) {
+		mcJSON_Delete(projected);
+	}
+
+	return success;
+}
+
+static bool test_whole(void) {
+	buffer_create_from_string(json, "[1, {\"a\": [true, null]}, \"three\"]");
+
+	/* an empty pointer is the whole document */
+	const char * const whole[] = {""};
+	mcJSON *projected = mcJSON_ParseProjected(json, whole, 1, NULL);
+	if ((projected == NULL) || !print_json("whole document", projected)) {
+		mcJSON_Delete(projected);
+		return false;
+	}
+	mcJSON_Delete(projected);
+
+	/* without pointers, only the root is left */
+	projected = mcJSON_ParseProjected(json, NULL, 0, NULL);
+	if ((projected == NULL) || !print_json("no pointers", projected)) {
+		mcJSON_Delete(projected);
+		return false;
+	}
+	mcJSON_Delete(projected);
+
+	/* the subtree of a prefix contains the longer pointer */
+	const char * const nested[] = {"/1/a/0", "/1"};
+	projected = mcJSON_ParseProjected(json, nested, 2, NULL);
+	if ((projected == NULL) || !print_json("nested pointers", projected)) {
+		mcJSON_Delete(projected);
+		return false;
+	}
+	mcJSON_Delete(projected);
+
+	return true;
+}
+
+static bool test_invalid(void) {
+	/* malformed on the way to a pointer */
+	buffer_create_from_string(json, "{\"a\": {\"b\": 1,}}");
+	const char * const pointer[] = {"/a/b"};
+	if (mcJSON_ParseProjected(json, pointer, 1, NULL) != NULL) {
+		fprintf(stderr, "ERROR: Parsed invalid json!\n");
+		return false;
+	}
+
+	/* skipped values are only checked for matching brackets */
+	buffer_create_from_string(unchecked, "{\"skipped\": [1, 2, \"a\": 1], \"a\": true}");
+	const char * const a[] = {"/a"};
+	mcJSON *projected = mcJSON_ParseProjected(unchecked, a, 1, NULL);
+	if ((projected == NULL) || !print_json("unchecked", projected)) {
+		fprintf(stderr, "ERROR: Failed to skip unchecked value!\n");
+		return false;
+	}
+	mcJSON_Delete(projected);
+
+	/* pointers have to start with '/' */
+	const char * const invalid_pointer[] = {"a"};
+	if (mcJSON_ParseProjected(json, invalid_pointer, 1, NULL) != NULL) {
+		fprintf(stderr, "ERROR: Accepted invalid pointer!\n");
+		return false;
+	}
+
+	/* unclosed skipped value */
+	buffer_create_from_string(unclosed, "{\"skipped\": [1, 2, \"a\": 1}");
+	if (mcJSON_ParseProjected(unclosed, a, 1, NULL) != NULL) {
+		fprintf(stderr, "ERROR: Parsed unclosed json!\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	mempool_t *pool = buffer_create_on_heap(4096, 0);
+	if (pool == NULL) {
+		if (output_file != NULL) {
+			fclose(output_file);
+		}
+		return EXIT_FAILURE;
+	}
+
+	const bool success = test_projection(NULL) && test_projection(pool) && test_whole() && test_invalid();
+
+	buffer_destroy_from_heap(pool);
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "../mcJSON.h"
+
+/* Events are printed and counted, the checksum is used to compare
+ * event streams without printing them. */
+typedef struct event_log {
+	bool print;
+	FILE *output_file;
+	size_t count;
+	uint64_t checksum;
+	size_t stop_after; /* stop parsing after this many events, 0 means never */
+} event_log;
+
+static bool log_event(event_log *log, const char *event, const unsigned char *data, size_t length) {
+	log->count++;
+	for (size_t i = 0; i < strlen(event); i++) {
+		log->checksum = log->checksum * 31 + (unsigned char)event[i];
+	}
+	for (size_t i = 0; i < length; i++) {
+		log->checksum = log->checksum * 31 + data[i];
+	}
+
+	if (log->print) {
+		const char *separator = (data == NULL) ? "" : " ";
+		printf("%s%s%.*s\n", event, separator, (int)length, (const char*)data);
+		if (log->output_file != NULL) {
+			fprintf(log->output_file, "%s%s%.*s\n", event, separator, (int)length, (const char*)data);
+		}
+	}
+
+	return (log->stop_after == 0) || (log->count < log->stop_after);
+}
+
+static bool start_object(void * const userdata) {
+	return log_event((event_log*)userdata, "start_object", NULL, 0);
+}
+static bool end_object(void * const userdata) {
+	return log_event((event_log*)userdata, "end_object", NULL, 0);
+}
+static bool start_array(void * const userdata) {
+	return log_event((event_log*)userdata, "start_array", NULL, 0);
+}
+static bool end_array(void * const userdata) {
+	return log_event((event_log*)userdata, "end_array", NULL, 0);
+}
+static bool key(void * const userdata, const buffer_t * const key) {
+	return log_event((event_log*)userdata, "key", key->content, key->content_length - 1);
+}
+static bool string(void * const userdata, const buffer_t * const string) {
+	return log_event((event_log*)userdata, "string", string->content, string->content_length - 1);
+}
+static bool number(void * const userdata, const double number, const int64_t * const integer) {
+	char text[64];
+	if (integer != NULL) {
+		snprintf(text, sizeof(text), "%" PRId64, *integer);
+	} else {
+		snprintf(text, sizeof(text), "%.17g", number);
+	}
+	return log_event((event_log*)userdata, "number", (const unsigned char*)text, strlen(text));
+}
+static bool boolean(void * const userdata, const bool value) {
+	return log_event((event_log*)userdata, value ? "true" : "false", NULL, 0);
+}
+static bool null(void * const userdata) {
+	return log_event((event_log*)userdata, "null", NULL, 0);
+}
+
+static const mcJSON_SAXCallbacks callbacks = {
+	start_object,
+	end_object,
+	start_array,
+	end_array,
+	key,
+	string,
+	number,
+	boolean,
+	null
+};
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE *output_file = NULL;
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* a bunch of json: */
+	const char *json[] = {
+		"{\n\"name\": \"Jack (\\\"Bee\\\") Nimble\", \n\"format\": {\"type\":       \"rect\", \n\"width\":      1920, \n\"height\":     1080, \n\"interlace\":  false,\"frame rate\": 24\n}\n}",
+		"[\n    [0, -1, 0],\n    [1, 0, 0],\n    [0, 0, 1]\n	]\n",
+		"[null, true, -0.5e-3, 9223372036854775807, \"tab\\tand \\\\ backslash\", {}, []]"
+	};
+
+	for (size_t i = 0; i < (sizeof(json) / sizeof(*json)); i++) {
+		buffer_create_with_existing_array(json_buffer, (unsigned char*)json[i], strlen(json[i]) + 1);
+		event_log log = {true, output_file, 0, 0, 0};
+		if (!mcJSON_ParseSAX(json_buffer, &callbacks, &log)) {
+			fprintf(stderr, "ERROR: Failed to parse text %zu!\n", i);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
+		/* feeding one byte at a time has to create the same events */
+		event_log chunked_log = {false, NULL, 0, 0, 0};
+		mcJSON_SAXParser *parser = mcJSON_SAXParserCreate(&callbacks, &chunked_log);
+		if (parser == NULL) {
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+		for (size_t position = 0; position < json_buffer->content_length; position++) {
+			buffer_create_with_existing_array(chunk, json_buffer->content + position, 1);
+			mcJSON_SAXParserFeed(parser, chunk);
+		}
+		if (!mcJSON_SAXParserFinish(parser) || (chunked_log.count != log.count) || (chunked_log.checksum != log.checksum)) {
+			fprintf(stderr, "ERROR: Incremental parsing of text %zu created different events!\n", i);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+
+		/* callbacks can stop parsing */
+		event_log stopped_log = {false, NULL, 0, 0, 2};
+		if (mcJSON_ParseSAX(json_buffer, &callbacks, &stopped_log) || (stopped_log.count != 2)) {
+			fprintf(stderr, "ERROR: Failed to stop parsing text %zu!\n", i);
+			if (output_file != NULL) {
+				fclose(output_file);
+			}
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return EXIT_SUCCESS;
+}
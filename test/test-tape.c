@@ -0,0 +1,334 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static void print_line(const char * const label, const char * const text) {
+	printf("%s: %s\n", label, text);
+	if (output_file != NULL) {
+		fprintf(output_file, "%s: %s\n", label, text);
+	}
+}
+
+/* Build a tree from a value of the tape with the public functions only. */
+static mcJSON *tape_to_tree(const mcJSON_Tape * const tape, const size_t value, mempool_t * const pool) {
+	buffer_t string[1];
+	double number;
+	int64_t integer;
+	bool boolean;
+	switch (mcJSON_TapeType(tape, value)) {
+		case mcJSON_NULL:
+			return mcJSON_CreateNull(pool);
+		case mcJSON_False:
+		case mcJSON_True:
+			return mcJSON_TapeGetBool(tape, value, &boolean) ? mcJSON_CreateBool(boolean, pool) : NULL;
+		case mcJSON_Number:
+			if (mcJSON_TapeGetInt64(tape, value, &integer)) {
+				return mcJSON_CreateInt64(integer, pool);
+			}
+			return mcJSON_TapeGetDouble(tape, value, &number) ? mcJSON_CreateNumber(number, pool) : NULL;
+		case mcJSON_String:
+			return mcJSON_TapeGetString(tape, value, string) ? mcJSON_CreateString(string, pool) : NULL;
+		case mcJSON_Array:
+		case mcJSON_Object:
+			break;
+		default:
+			return NULL;
+	}
+
+	const bool is_object = (mcJSON_TapeType(tape, value) == mcJSON_Object);
+	mcJSON *container = is_object ? mcJSON_CreateObject(pool) : mcJSON_CreateArray(pool);
+	for (size_t child = mcJSON_TapeChild(tape, value); child != mcJSON_TAPE_NONE; child = mcJSON_TapeNext(tape, child)) {
+		mcJSON *item = tape_to_tree(tape, child, pool);
+		if (item == NULL) {
+			return NULL;
+		}
+		if (is_object) {
+			if (!mcJSON_TapeGetName(tape, child, string)) {
+				return NULL;
+			}
+			mcJSON_AddItemToObject(container, string, item, pool);
+		} else {
+			mcJSON_AddItemToArray(container, item, pool);
+		}
+	}
+	if (container->length != mcJSON_TapeLength(tape, value)) {
+		return NULL;
+	}
+
+	return container;
+}
+
+/* the tape contains the same as the tree */
+static bool test_roundtrip(buffer_t * const json) {
+	mempool_t *pool = mcJSON_ArenaCreate(4096);
+	mcJSON_Tape *tape = mcJSON_ParseTape(json);
+	bool success = false;
+	if ((pool == NULL) || (tape == NULL)) {
+		fprintf(stderr, "ERROR: Failed to parse tape!\n");
+		goto cleanup;
+	}
+
+	mcJSON *from_tape = tape_to_tree(tape, 0, pool);
+	mcJSON *tree = mcJSON_ParseWithBuffer(json, pool);
+	if ((from_tape == NULL) || (tree == NULL)) {
+		fprintf(stderr, "ERROR: Failed to build the trees!\n");
+		goto cleanup;
+	}
+	buffer_t *expected = mcJSON_PrintUnformatted(tree);
+	buffer_t *got = mcJSON_PrintUnformatted(from_tape);
+	success = (expected != NULL) && (got != NULL) && (buffer_compare(expected, got) == 0);
+	if (success) {
+		print_line("tape", (char*)got->content);
+	} else {
+		fprintf(stderr, "ERROR: Tape and tree differ!\n");
+	}
+	if (expected != NULL) {
+		buffer_destroy_from_heap(expected);
+	}
+	if (got != NULL) {
+		buffer_destroy_from_heap(got);
+	}
+
+cleanup:
+	mcJSON_TapeDelete(tape);
+	if (pool != NULL) {
+		mcJSON_ArenaDestroy(pool);
+	}
+	return success;
+}
+
+static bool test_accessors(void) {
+	buffer_create_from_string(json, "{\"id\": 9007199254740993, \"ratio\": 0.25, \"ok\": true, \"tags\": [\"a\", \"b\\u0000c\", null], \"empty\": {}}");
+	mcJSON_Tape *tape = mcJSON_ParseTape(json);
+	if (tape == NULL) {
+		return false;
+	}
+
+	buffer_create_from_string(id_name, "id");
+	buffer_create_from_string(ratio_name, "ratio");
+	buffer_create_from_string(tags_name, "tags");
+	buffer_create_from_string(empty_name, "empty");
+	buffer_create_from_string(missing_name, "missing");
+	buffer_create_from_string(prefix_name, "i");
+	const size_t id = mcJSON_TapeGetObjectItem(tape, 0, id_name);
+	const size_t ratio = mcJSON_TapeGetObjectItem(tape, 0, ratio_name);
+	const size_t tags = mcJSON_TapeGetObjectItem(tape, 0, tags_name);
+	const size_t empty = mcJSON_TapeGetObjectItem(tape, 0, empty_name);
+	const size_t second_tag = mcJSON_TapeGetArrayItem(tape, tags, 1);
+	int64_t integer = 0;
+	double number = 0;
+	buffer_t string[1];
+	buffer_t name[1];
+	const bool success = mcJSON_TapeGetInt64(tape, id, &integer) && (integer == INT64_C(9007199254740993))
+		&& !mcJSON_TapeGetInt64(tape, ratio, &integer)
+		&& mcJSON_TapeGetDouble(tape, ratio, &number) && (number == 0.25)
+		&& mcJSON_TapeGetString(tape, second_tag, string) && (string->content_length == 4) && (memcmp(string->content, "b\0c", 4) == 0)
+		&& !mcJSON_TapeGetName(tape, second_tag, name)
+		&& mcJSON_TapeGetName(tape, tags, name) && (buffer_compare(name, tags_name) == 0)
+		&& (mcJSON_TapeType(tape, mcJSON_TapeGetArrayItem(tape, tags, 2)) == mcJSON_NULL)
+		&& (mcJSON_TapeGetArrayItem(tape, tags, 3) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeLength(tape, tags) == 3)
+		&& (mcJSON_TapeLength(tape, empty) == 0)
+		&& (mcJSON_TapeChild(tape, empty) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeNext(tape, empty) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeGetObjectItem(tape, 0, missing_name) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeGetObjectItem(tape, 0, prefix_name) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeGetObjectItem(tape, tags, id_name) == mcJSON_TAPE_NONE)
+		&& (mcJSON_TapeType(tape, 1) == 0) /* the name of "id" */
+		&& (mcJSON_TapeType(tape, 1000) == 0);
+	print_line("accessors", success ? "ok" : "failed");
+	mcJSON_TapeDelete(tape);
+
+	return success;
+}
+
+#define RECORDS 1000
+
+/* records are much smaller on a tape than in a tree */
+static bool test_size(void) {
+	static const char record[] = "{\"id\": %d, \"name\": \"record\", \"active\": true, \"scores\": [1, 2.5, null]},";
+	const size_t length = RECORDS * sizeof(record) + 3;
+	buffer_t *records = buffer_create_on_heap(length, 0);
+	if (records == NULL) {
+		return false;
+	}
+	size_t position = 0;
+	records->content[position++] = '[';
+	for (int i = 0; i < RECORDS; i++) {
+		position += (size_t)snprintf((char*)records->content + position, length - position, record, i);
+	}
+	records->content[position - 1] = ']'; /* replace the last ',' */
+	records->content[position] = '\0';
+	records->content_length = position + 1;
+
+	mcJSON_Tape *tape = mcJSON_ParseTape(records);
+	const size_t tree_size = mcJSON_ParseBufferSize(records);
+	const bool success = (tape != NULL) && (mcJSON_TapeLength(tape, 0) == RECORDS);
+	if (success) {
+		print_line("tape at least 4 times smaller than tree", ((4 * mcJSON_TapeSize(tape)) <= tree_size) ? "yes" : "no");
+	}
+	mcJSON_TapeDelete(tape);
+	buffer_destroy_from_heap(records);
+
+	return success;
+}
+
+/* allocator that counts what it allocates, userdata points to the count */
+static void *counting_malloc(void * const userdata, const size_t size) {
+	void *pointer = malloc(size);
+	if (pointer != NULL) {
+		(*(size_t*)userdata)++;
+	}
+	return pointer;
+}
+
+static void counting_free(void * const userdata, void * const pointer) {
+	if (pointer != NULL) {
+		(*(size_t*)userdata)--;
+	}
+	free(pointer);
+}
+
+/* the global hooks mustn't be used when a context is passed */
+static size_t hook_allocations = 0;
+static void *hook_malloc(size_t size) {
+	hook_allocations++;
+	return malloc(size);
+}
+
+/* the tape, the builder and the SAX parser use the allocator of the context */
+static bool test_context(void) {
+	size_t allocations = 0;
+	mcJSON_Context context;
+	mcJSON_ContextInit(&context);
+	context.malloc_fn = counting_malloc;
+	context.free_fn = counting_free;
+	context.userdata = &allocations;
+	const mcJSON_Hooks hooks = {hook_malloc, free};
+	mcJSON_InitHooks(&hooks);
+
+	buffer_create_from_string(json,
+		"[{\"key\": \"a string that is long enough to make the string arena of the tape grow beyond the size"
+		" that it starts with, so it has to be moved at least once while the tape is being built\","
+		" \"number\": 1}, {\"key\": \"a second string that is long enough to make the arena grow once more,"
+		" because the first one didn't fill it completely and the names are only stored once\", \"number\": 2}]");
+	mcJSON_Tape *tape = mcJSON_ParseTapeWithContext(json, &context);
+	bool success = (tape != NULL) && (mcJSON_TapeLength(tape, 0) == 2) && (allocations == 1);
+	mcJSON_TapeDeleteWithContext(tape, &context);
+	success = success && (allocations == 0);
+
+	/* failed parses don't leak */
+	buffer_create_from_string(invalid, "[{\"key\": \"value\"}, [1, 2,]]");
+	success = success && (mcJSON_ParseTapeWithContext(invalid, &context) == NULL) && (allocations == 0);
+
+	/* json that is too long */
+	context.max_length = 10;
+	success = success && (mcJSON_ParseTapeWithContext(json, &context) == NULL);
+
+	mcJSON_InitHooks(NULL);
+	success = success && (hook_allocations == 0);
+	print_line("context", success ? "only the context allocated" : "failed");
+
+	return success;
+}
+
+static bool test_invalid(void) {
+	buffer_create_from_string(unclosed, "{\"a\": [1, 2}");
+	buffer_create_from_string(trailing, "[1] 2");
+	buffer_create_from_string(empty, "");
+	mcJSON_Tape *tape = mcJSON_ParseTape(unclosed);
+	bool success = (tape == NULL);
+	mcJSON_TapeDelete(tape);
+	tape = mcJSON_ParseTape(trailing);
+	success = success && (tape == NULL);
+	mcJSON_TapeDelete(tape);
+	tape = mcJSON_ParseTape(empty);
+	success = success && (tape == NULL);
+	mcJSON_TapeDelete(tape);
+	print_line("invalid", success ? "rejected" : "accepted");
+
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	buffer_create_from_string(document, "{\"name\": \"tape\", \"values\": [1, -2, 3.5e10, true, false, null, \"\\\"quoted\\\"\", [], {}, [[{\"deep\": [0]}]]], \"t\\u00e4st\": {\"a\": {}, \"b\": []}}");
+	buffer_create_from_string(array, "[[], [1], [1, [2, [3]]], {\"x\": null, \"y\": [true]}]");
+	buffer_create_from_string(number, " 42 ");
+	buffer_create_from_string(string, "\"text\"");
+	const bool success = test_roundtrip(document)
+		&& test_roundtrip(array)
+		&& test_roundtrip(number)
+		&& test_roundtrip(string)
+		&& test_accessors()
+		&& test_size()
+		&& test_context()
+		&& test_invalid();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
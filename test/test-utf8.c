@@ -0,0 +1,239 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+/* long strings cross the blocks of the vectorized validator */
+static const char * const documents[] = {
+	"\"ascii\"",
+	"\"two bytes \xC3\xA4, three bytes \xE2\x82\xAC, four bytes \xF0\x9D\x84\x9E\"",
+	"[\"a string that is longer than one block \xC3\xA4\xC3\xB6\xC3\xBC and then some more ascii\"]",
+	"{\"name \xE2\x82\xAC\": \"\xF4\x8F\xBF\xBF is the last code point\"}",
+	"\"0123456789012345678901234567890\xE2\x82\xAC crosses the first block\"",
+	"\"continuation without lead \x80\"",
+	"\"overlong \xC0\xAF\"",
+	"\"overlong \xE0\x80\xAF\"",
+	"\"overlong \xF0\x80\x80\xAF\"",
+	"\"surrogate \xED\xA0\x80\"",
+	"\"too big \xF4\x90\x80\x80\"",
+	"\"not a lead byte \xF8\x88\x80\x80\x80\"",
+	"\"truncated \xE2\x82\"",
+	"\"truncated at the end \xF0\x9D\x84\"",
+	"{\"name \xC3\": 1}",
+	"[\"a string that is longer than one block and has an invalid byte \xFF at the end of the second\"]",
+	"\"0123456789012345678901234567890\xE2\x82 truncated across the first block\""
+};
+
+static void print_result(const size_t index, const bool unchecked, const bool validated) {
+	printf("document %zu: %s, %s\n", index, unchecked ? "parsed" : "failed", validated ? "valid" : "invalid");
+	if (output_file != NULL) {
+		fprintf(output_file, "document %zu: %s, %s\n", index, unchecked ? "parsed" : "failed", validated ? "valid" : "invalid");
+	}
+}
+
+static bool test_documents(void) {
+	const mcJSON_ParseOptions options = {
+		false, /* borrow_strings */
+		false, /* in_situ */
+		0, /* max_depth */
+		true, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+
+	for (size_t i = 0; i < (sizeof(documents) / sizeof(documents[0])); i++) {
+		const size_t length = strlen(documents[i]) + 1;
+		buffer_t json_buffer;
+		buffer_t *json = buffer_init_with_pointer(&json_buffer, (unsigned char*)documents[i], length, length);
+
+		/* without validation, the bytes are copied as they are */
+		mcJSON *unchecked = mcJSON_Parse(json);
+		mcJSON *validated = mcJSON_ParseWithOptions(json, NULL, &options);
+		print_result(i, unchecked != NULL, validated != NULL);
+		const bool agrees = (validated == NULL) || (unchecked != NULL);
+		mcJSON_Delete(unchecked);
+		mcJSON_Delete(validated);
+		if (!agrees) {
+			fprintf(stderr, "ERROR: Only validated document %zu could be parsed!\n", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Reference validator, returns the length of the valid sequence at content or 0. */
+static size_t reference_sequence(const unsigned char * const content, const size_t length) {
+	const unsigned char first = content[0];
+	size_t needed;
+	unsigned char minimum = 0x80;
+	unsigned char maximum = 0xBF;
+	if (first < 0x80) {
+		return 1;
+	} else if ((first >= 0xC2) && (first <= 0xDF)) {
+		needed = 2;
+	} else if ((first >= 0xE0) && (first <= 0xEF)) {
+		needed = 3;
+		minimum = (first == 0xE0) ? 0xA0 : 0x80;
+		maximum = (first == 0xED) ? 0x9F : 0xBF;
+	} else if ((first >= 0xF0) && (first <= 0xF4)) {
+		needed = 4;
+		minimum = (first == 0xF0) ? 0x90 : 0x80;
+		maximum = (first == 0xF4) ? 0x8F : 0xBF;
+	} else {
+		return 0;
+	}
+	if ((needed > length) || (content[1] < minimum) || (content[1] > maximum)) {
+		return 0;
+	}
+	for (size_t i = 2; i < needed; i++) {
+		if ((content[i] < 0x80) || (content[i] > 0xBF)) {
+			return 0;
+		}
+	}
+
+	return needed;
+}
+
+static bool reference_is_valid(const unsigned char * const content, const size_t length) {
+	size_t position = 0;
+	while (position < length) {
+		const size_t sequence = reference_sequence(content + position, length - position);
+		if (sequence == 0) {
+			return false;
+		}
+		position += sequence;
+	}
+
+	return true;
+}
+
+/* Every pair of non ASCII bytes, followed by two continuation bytes, at and
+ * around the boundary of the 32 byte blocks of the vectorized validator, in
+ * strings that are shorter and longer than one block. */
+#define SEQUENCE_PADDING 36
+static bool test_sequences(void) {
+	const mcJSON_ParseOptions options = {
+		false, /* borrow_strings */
+		false, /* in_situ */
+		0, /* max_depth */
+		true, /* validate_utf8 */
+		false, /* intern_names */
+		NULL, /* resolve_name */
+		NULL /* resolver_data */
+	};
+	static const size_t offsets[] = {0, 28, 29, 30, 31, 32};
+	static const size_t paddings[] = {0, SEQUENCE_PADDING};
+
+	unsigned char document[1 + 32 + 4 + SEQUENCE_PADDING + 2];
+	size_t valid = 0;
+	size_t count = 0;
+	for (size_t offset = 0; offset < (sizeof(offsets) / sizeof(offsets[0])); offset++) {
+		for (size_t padding = 0; padding < (sizeof(paddings) / sizeof(paddings[0])); padding++) {
+			for (unsigned int first = 0x80; first <= 0xFF; first++) {
+				for (unsigned int second = 0x80; second <= 0xFF; second++) {
+					const size_t length = offsets[offset] + 4 + paddings[padding];
+					unsigned char * const string = document + 1;
+					memset(string, 'a', length);
+					string[offsets[offset]] = (unsigned char)first;
+					string[offsets[offset] + 1] = (unsigned char)second;
+					string[offsets[offset] + 2] = 0x80;
+					string[offsets[offset] + 3] = 0x80;
+					document[0] = '\"';
+					document[length + 1] = '\"';
+					document[length + 2] = '\0';
+	
+					buffer_t json_buffer;
+					buffer_t *json = buffer_init_with_pointer(&json_buffer, document, length + 3, length + 3);
+					mcJSON *validated = mcJSON_ParseWithOptions(json, NULL, &options);
+					const bool expected = reference_is_valid(string, length);
+					mcJSON_Delete(validated);
+					if ((validated != NULL) != expected) {
+						fprintf(stderr, "ERROR: Validation of %02X %02X 80 80 at %zu of %zu should have %s!\n", first, second, offsets[offset], length, expected ? "succeeded" : "failed");
+						return false;
+					}
+					valid += expected ? 1 : 0;
+					count++;
+				}
+			}
+		}
+	}
+	printf("sequences: %zu of %zu valid\n", valid, count);
+	if (output_file != NULL) {
+		fprintf(output_file, "sequences: %zu of %zu valid\n", valid, count);
+	}
+
+	return true;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_documents() && test_sequences();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+/*
+ * mcJSON, a modified version of cJSON, a simple JSON parser and generator.
+ *
+ * ISC License
+ *
+ * Copyright (C) 2015-2016 Max Bruckner (FSMaxB) <max at maxbruckner dot de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  This file incorporates work covered by the following license notice:
+ *
+ * |  Copyright (c) 2009 Dave Gamble
+ * |
+ * |  Permission is hereby granted, free of charge, to any person obtaining a copy
+ * |  of this software and associated documentation files (the "Software"), to deal
+ * |  in the Software without restriction, including without limitation the rights
+ * |  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * |  copies of the Software, and to permit persons to whom the Software is
+ * |  furnished to do so, subject to the following conditions:
+ * |
+ * |  The above copyright notice and this permission notice shall be included in
+ * |  all copies or substantial portions of the Software.
+ * |
+ * |  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * |  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * |  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * |  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * |  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * |  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * |  THE SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../mcJSON.h"
+
+static FILE *output_file = NULL;
+
+static const char * const documents[] = {
+	"null",
+	" \t\r\n{\"a\": [1, -0.5, 2e10, 3E-2, true, false, null, \"\"]} \n",
+	"[[], {}, [[{}]], {\"\": {\"\": []}}]",
+	"\"escapes \\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u00e4 \\uD834\\uDD1E\"",
+	"\"utf-8 \xC3\xA4 \xE2\x82\xAC \xF0\x9D\x84\x9E\"",
+	"",
+	"   ",
+	"[1, 2,]",
+	"{\"a\": 1,}",
+	"{\"a\" 1}",
+	"{1: 2}",
+	"[1 2]",
+	"[1, 2}",
+	"{\"a\": [1}",
+	"01",
+	"-",
+	"1.",
+	".5",
+	"1e",
+	"+1",
+	"0x10",
+	"tru",
+	"nul",
+	"True",
+	"\"unterminated",
+	"\"control \x01 character\"",
+	"\"\\x escape\"",
+	"\"\\u12G4\"",
+	"\"\\uDD1E lone low surrogate\"",
+	"\"\\uD834 lone high surrogate\"",
+	"\"\\uD834\\u0041 unpaired\"",
+	"\"overlong \xC0\xAF\"",
+	"\"overlong \xE0\x80\xAF\"",
+	"\"surrogate \xED\xA0\x80\"",
+	"\"too big \xF4\x90\x80\x80\"",
+	"\"truncated \xE2\x82\"",
+	"\"continuation \x80\"",
+	"[1] [2]",
+	"{} x",
+};
+
+static void print_result(const char * const label, const bool valid, const size_t error_offset) {
+	if (valid) {
+		printf("%s: valid\n", label);
+		if (output_file != NULL) {
+			fprintf(output_file, "%s: valid\n", label);
+		}
+	} else {
+		printf("%s: invalid at %zu\n", label, error_offset);
+		if (output_file != NULL) {
+			fprintf(output_file, "%s: invalid at %zu\n", label, error_offset);
+		}
+	}
+}
+
+static bool test_documents(void) {
+	for (size_t i = 0; i < (sizeof(documents) / sizeof(documents[0])); i++) {
+		const size_t length = strlen(documents[i]);
+		buffer_t document_buffer;
+		buffer_t *document = buffer_init_with_pointer(&document_buffer, (unsigned char*)documents[i], length, length);
+		size_t error_offset = 0;
+		const bool valid = mcJSON_Validate(document, 0, &error_offset);
+
+		char label[32];
+		snprintf(label, sizeof(label), "document %zu", i);
+		print_result(label, valid, error_offset);
+	}
+
+	return true;
+}
+
+static bool test_depth(void) {
+	const size_t depth = mcJSON_VALIDATE_MAX_DEPTH + 1;
+	buffer_t *nested = buffer_create_on_heap(2 * depth, 2 * depth);
+	if (nested == NULL) {
+		return false;
+	}
+	memset(nested->content, '[', depth);
+	memset(nested->content + depth, ']', depth);
+	bool success = false;
+
+	/* one level too deep */
+	size_t error_offset = 0;
+	bool valid = mcJSON_Validate(nested, 0, &error_offset);
+	print_result("too deep", valid, error_offset);
+	if (valid) {
+		goto cleanup;
+	}
+
+	/* exactly the maximum depth */
+	buffer_t maximum_buffer;
+	buffer_t *maximum = buffer_init_with_pointer(&maximum_buffer, nested->content + 1, 2 * depth - 2, 2 * depth - 2);
+	valid = mcJSON_Validate(maximum, 0, &error_offset);
+	print_result("maximum depth", valid, error_offset);
+	if (!valid) {
+		goto cleanup;
+	}
+
+	buffer_create_from_string(shallow, "[{\"a\": [1]}]");
+	valid = mcJSON_Validate(shallow, 2, &error_offset);
+	print_result("max_depth 2", valid, error_offset);
+	valid = mcJSON_Validate(shallow, 3, &error_offset);
+	print_result("max_depth 3", valid, error_offset);
+
+	success = true;
+
+cleanup:
+	buffer_destroy_from_heap(nested);
+	return success;
+}
+
+int main (int argc, char **argv) {
+	if ((argc != 1) && (argc != 2)) {
+		fprintf(stderr, "ERROR: Invalid arguments!\n");
+		fprintf(stderr, "Usage: %s [output_file]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if ((argc == 2) && (argv[1] != NULL)) {
+		output_file = fopen(argv[1], "w");
+		if (output_file == NULL) {
+			fprintf(stderr, "ERROR: Failed to open file '%s'\n", argv[1]);;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool success = test_documents() && test_depth();
+
+	if (output_file != NULL) {
+		fclose(output_file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}